@@ -1,12 +1,21 @@
 #ifndef ARG_PARSER_H
 #define ARG_PARSER_H
 
+#include "vajra.hpp"
+
+#include <algorithm>
+#include <cctype>
 #include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <ctime>
 #include <iomanip>
 #include <iostream>
+#include <limits>
 #include <map>
 #include <optional>
+#include <set>
+#include <span>
 #include <sstream>
 #include <stdexcept>
 #include <string>
@@ -138,6 +147,18 @@ class ProgressBar {
     }
 };
 
+/**
+ * @brief Summary of one collector metric across the timed runs.
+ */
+struct MetricSummary {
+    std::string name{};
+    double mean{};
+    double stdDev{};
+    double min{};
+    double max{};
+    int samples{};
+};
+
 struct BenchmarkResults {
     std::string command;
     double mean;
@@ -145,40 +166,476 @@ struct BenchmarkResults {
     double min;
     double max;
     int iterations;
+    int numaNode{-1};
+    std::string execMode{};
+    std::string name{};
+    std::vector<std::string> tags{};
+
+    std::string reservation{};
+    int reservedCpus{0};
+    int contendedCpus{0};
+    bool reservationFailed{false};
+
+    int failedRuns{0};    // timed runs that exited non-zero or were killed by a signal
+    int failureExit{0};   // exit code of the first such run
+    int failureSignal{0}; // or the signal that killed it
+
+    std::vector<MetricSummary> metrics{};
+    Samples::SampleSet samples{}; // every run, column by column (see --export-samples)
+    long long callsPerIteration{0};
+
+    int plannedIterations{0};
+    int resumedIterations{0};
+    bool interrupted{false};
+
+    std::string cacheKey{};
+    long long cachedAt{0};
+
+    /**
+     * @brief Wall time of every run in integer nanoseconds; empty for cached or relayed results.
+     * For --dlopen each value covers a whole batch of callsPerIteration calls.
+     */
+    std::span<const uint64_t> wallNs() const {
+        return samples.column<uint64_t>(Samples::WallNs);
+    }
+
+    /**
+     * @brief True if any timed run failed; its time measures the failure, not the command.
+     */
+    bool failed() const {
+        return failedRuns > 0;
+    }
+
+    /**
+     * @brief Convert a statistic of wallNs() to the milliseconds per run (or per call) shown.
+     */
+    double toMs(double ns) const {
+        return ns / 1e6 / static_cast<double>(std::max(1LL, callsPerIteration));
+    }
+
+    static std::string escapeJson(const std::string& text) {
+        std::string out{};
+        for (char c : text) {
+            switch (c) {
+            case '"':
+                out += "\\\"";
+                break;
+            case '\\':
+                out += "\\\\";
+                break;
+            case '\n':
+                out += "\\n";
+                break;
+            case '\t':
+                out += "\\t";
+                break;
+            default:
+                out += c;
+            }
+        }
+        return out;
+    }
+
+    bool hasSched{false};
+    double runDelayMean{};
+    double runDelayStdDev{};
+    double runDelayMin{};
+    double runDelayMax{};
+    double switchesPerRun{};
+    double migrationsPerRun{};
+
+    bool hasIo{false};
+    double rcharPerRun{};
+    double wcharPerRun{};
+    double syscrPerRun{};
+    double syscwPerRun{};
+    double readBytesPerRun{};
+    double writeBytesPerRun{};
+
+    bool hasUsage{false};
+    double cpuMean{};
+    double cpuStdDev{};
+    double userCpuMean{};
+    double systemCpuMean{};
+    double peakRssMean{};
+    double peakRssMax{};
+
+    bool hasOutput{false};
+    double outputBytesMean{};
+    double outputBytesMin{};
+    double outputBytesMax{};
+
+    // Declared work per run (--bytes/--items), for throughput
+    double bytesPerRun{0};
+    double itemsPerRun{0};
+
+    /**
+     * @brief Half-width of the 95% CI of the mean time, from the summary alone so it also works
+     * for results loaded from JSON.
+     */
+    double meanHalfWidth() const {
+        return iterations > 1 ? 1.96 * stdDev / std::sqrt(static_cast<double>(iterations - 1))
+                              : 0.0;
+    }
+
+    /**
+     * @brief Per-second rate of 'amount' at the mean time, with the CI of the mean mapped through
+     * amount / time (so the interval is not symmetric). When the CI reaches zero time the upper
+     * bound is +infinity: nothing rules out an arbitrarily high rate yet.
+     */
+    void rate(double amount, double& value, double& low, double& high) const {
+        const double seconds{mean / 1000.0};
+        const double margin{meanHalfWidth() / 1000.0};
+        value = seconds > 0 ? amount / seconds : 0.0;
+        low = seconds + margin > 0 ? amount / (seconds + margin) : 0.0;
+        high = seconds - margin > 0 ? amount / (seconds - margin)
+                                    : std::numeric_limits<double>::infinity();
+    }
+
+    /**
+     * @brief A rate bound for JSON: null when it is unbounded.
+     */
+    static std::string jsonBound(double bound, int precision) {
+        if (!std::isfinite(bound)) {
+            return "null";
+        }
+        std::ostringstream oss{};
+        oss << std::fixed << std::setprecision(precision) << bound;
+        return oss.str();
+    }
+
+    static std::string formatCount(double count) {
+        std::ostringstream oss{};
+        oss << std::fixed << std::setprecision(2);
+        if (count < 1e3) {
+            oss << std::setprecision(1) << count;
+        } else if (count < 1e6) {
+            oss << count / 1e3 << " K";
+        } else if (count < 1e9) {
+            oss << count / 1e6 << " M";
+        } else {
+            oss << count / 1e9 << " G";
+        }
+        return oss.str();
+    }
+
+    static std::string formatBytes(double bytes) {
+        std::ostringstream oss{};
+        oss << std::fixed << std::setprecision(2);
+
+        if (bytes < 1024.0) {
+            oss << std::setprecision(0) << bytes << " B";
+        } else if (bytes < 1024.0 * 1024.0) {
+            oss << (bytes / 1024.0) << " KB";
+        } else if (bytes < 1024.0 * 1024.0 * 1024.0) {
+            oss << (bytes / (1024.0 * 1024.0)) << " MB";
+        } else {
+            oss << (bytes / (1024.0 * 1024.0 * 1024.0)) << " GB";
+        }
+
+        return oss.str();
+    }
+
+    double storageBytesPerSec() const {
+        return (mean > 0) ? (readBytesPerRun + writeBytesPerRun) * 1000.0 / mean : 0.0;
+    }
 
     void display() const {
         std::cout << "\n"
                   << Colors::Bold << Colors::BrightWhite << "Benchmark: " << Colors::Reset
-                  << command << Colors::Reset << "\n";
+                  << command << Colors::Reset;
+        if (numaNode >= 0) {
+            std::cout << Colors::Dim << " [node " << numaNode << "]" << Colors::Reset;
+        }
+        std::cout << "\n";
+
+        // Three decimals of a millisecond say nothing about in-process calls; rescale those
+        const char* unit{mean >= 0.01 || mean == 0 ? " ms" : mean >= 1e-5 ? " µs" : " ns"};
+        const double scale{mean >= 0.01 || mean == 0 ? 1.0 : mean >= 1e-5 ? 1e3 : 1e6};
 
         std::cout << "  " << Colors::BrightGreen << "μ=" << std::fixed << std::setprecision(3)
-                  << mean << " ms" << Colors::Dim << " (mean)" << Colors::Reset << "   "
-                  << Colors::BrightMagenta << "σ=" << std::fixed << std::setprecision(3) << stdDev
-                  << " ms" << Colors::Dim << " (std)" << Colors::Reset << "\n";
+                  << mean * scale << unit << Colors::Dim << " (mean)" << Colors::Reset << "   "
+                  << Colors::BrightMagenta << "σ=" << std::fixed << std::setprecision(3)
+                  << stdDev * scale << unit << Colors::Dim << " (std)" << Colors::Reset << "\n";
 
-        std::cout << "  " << Colors::BrightBlue << "↓ " << std::fixed << std::setprecision(3) << min
-                  << " ms" << Colors::Dim << " (min)" << Colors::Reset << "   " << Colors::BrightRed
-                  << "↑ " << std::fixed << std::setprecision(3) << max << " ms" << Colors::Dim
-                  << " (max)" << Colors::Reset << "\n";
+        std::cout << "  " << Colors::BrightBlue << "↓ " << std::fixed << std::setprecision(3)
+                  << min * scale << unit << Colors::Dim << " (min)" << Colors::Reset << "   "
+                  << Colors::BrightRed << "↑ " << std::fixed << std::setprecision(3) << max * scale
+                  << unit << Colors::Dim << " (max)" << Colors::Reset << "\n";
 
         double opsPerSec{(mean > 0) ? (1000.0 / mean) : 0};
         std::cout << "  " << Colors::BrightYellow << "λ=" << std::fixed << std::setprecision(0)
                   << opsPerSec << " ops/s" << Colors::Dim << " (rate)" << Colors::Reset << "    "
-                  << Colors::Dim << "(" << iterations << " iters)" << Colors::Reset << "\n\n";
+                  << Colors::Dim << "(" << iterations << " iters";
+        if (callsPerIteration > 1) {
+            std::cout << " × " << callsPerIteration << " calls";
+        }
+        if (!execMode.empty()) {
+            std::cout << ", " << execMode << " exec";
+        }
+        std::cout << ")" << Colors::Reset << "\n";
+
+        if (bytesPerRun > 0 || itemsPerRun > 0) {
+            double value{}, low{}, high{};
+            std::cout << "  " << Colors::BrightYellow << "⚡ " << Colors::Reset;
+            if (bytesPerRun > 0) {
+                rate(bytesPerRun, value, low, high);
+                std::cout << formatBytes(value) << "/s" << Colors::Dim << " (" << formatBytes(low)
+                          << "…" << (std::isfinite(high) ? formatBytes(high) : "∞")
+                          << ", 95% CI)" << Colors::Reset;
+            }
+            if (itemsPerRun > 0) {
+                rate(itemsPerRun, value, low, high);
+                std::cout << (bytesPerRun > 0 ? "   " : "") << formatCount(value) << " items/s"
+                          << Colors::Dim << " (" << formatCount(low) << "…"
+                          << (std::isfinite(high) ? formatCount(high) : "∞") << ")"
+                          << Colors::Reset;
+            }
+            std::cout << "\n";
+        }
+
+        if (hasSched) {
+            std::cout << "  " << Colors::BrightCyan << "⧗ " << std::fixed << std::setprecision(3)
+                      << runDelayMean << " ± " << runDelayStdDev << " ms" << Colors::Dim
+                      << " (run-queue wait, " << runDelayMin << "…" << runDelayMax << ")"
+                      << Colors::Reset << "\n";
+            std::cout << "  " << Colors::White << "⇄ " << std::fixed << std::setprecision(1)
+                      << switchesPerRun << " switches/run   " << migrationsPerRun
+                      << " migrations/run" << Colors::Reset << "\n";
+        }
+
+        if (hasIo) {
+            std::cout << "  " << Colors::BrightBlue << "⇅ " << Colors::Reset << "read "
+                      << formatBytes(readBytesPerRun) << " / write "
+                      << formatBytes(writeBytesPerRun)
+                      << " per run" << Colors::Dim << " (storage, "
+                      << formatBytes(storageBytesPerSec()) << "/s)" << Colors::Reset << "\n";
+            std::cout << "  " << Colors::White << "  rchar " << formatBytes(rcharPerRun)
+                      << " / wchar " << formatBytes(wcharPerRun) << std::fixed
+                      << std::setprecision(1) << "   " << syscrPerRun << " read + " << syscwPerRun
+                      << " write syscalls/run" << Colors::Reset << "\n";
+        }
+
+        if (hasUsage) {
+            std::cout << "  " << Colors::BrightYellow << "▣ " << Colors::Reset << "cpu "
+                      << std::fixed << std::setprecision(3) << cpuMean << " ± " << cpuStdDev
+                      << " ms" << Colors::Dim << " (user " << userCpuMean << " + sys "
+                      << systemCpuMean << ")" << Colors::Reset << "   peak RSS "
+                      << formatBytes(peakRssMean) << Colors::Dim << " (max "
+                      << formatBytes(peakRssMax) << ")" << Colors::Reset << "\n";
+        }
+        if (hasOutput) {
+            std::cout << "  " << Colors::BrightGreen << "◧ " << Colors::Reset << "output "
+                      << formatBytes(outputBytesMean) << " per run";
+            if (outputBytesMin != outputBytesMax) {
+                std::cout << Colors::Dim << " (" << formatBytes(outputBytesMin) << "…"
+                          << formatBytes(outputBytesMax) << ")" << Colors::Reset;
+            }
+            std::cout << "\n";
+        }
+
+        for (const auto& m : metrics) {
+            std::cout << "  " << Colors::BrightCyan << "◆ " << Colors::Reset << m.name << "  "
+                      << std::defaultfloat << std::setprecision(6) << m.mean << " ± " << m.stdDev
+                      << Colors::Dim << " (" << m.min << "…" << m.max << ")" << Colors::Reset
+                      << "\n";
+        }
+
+        if (interrupted) {
+            std::cout << "  " << Colors::BrightYellow << "⚠ " << Colors::Reset
+                      << "interrupted after " << iterations << " of " << plannedIterations
+                      << " iterations" << Colors::Dim << " (statistics cover those only)"
+                      << Colors::Reset << "\n";
+        }
+        if (resumedIterations > 0) {
+            std::cout << "  " << Colors::Dim << "↻ " << resumedIterations
+                      << " iterations taken from the journal" << Colors::Reset << "\n";
+        }
+        if (cachedAt > 0) {
+            const std::time_t when{static_cast<std::time_t>(cachedAt)};
+            std::cout << "  " << Colors::Dim << "↺ cached result measured "
+                      << std::put_time(std::localtime(&when), "%Y-%m-%d %H:%M")
+                      << " (key " << cacheKey << ", --force to re-measure)" << Colors::Reset
+                      << "\n";
+        }
+
+        if (failed()) {
+            std::cout << "  " << Colors::BrightRed << "⚠ " << Colors::Reset << failedRuns
+                      << " of " << iterations << " run(s) failed" << Colors::Dim << " (first ";
+            if (failureSignal != 0) {
+                std::cout << "killed by signal " << failureSignal;
+            } else {
+                std::cout << "exited with " << failureExit;
+            }
+            std::cout << ")" << Colors::Reset << "\n";
+        }
+
+        if (contendedCpus > 0) {
+            std::cout << "  " << Colors::BrightRed << "⚠ " << Colors::Reset
+                      << "another vajra process was using " << contendedCpus << " of "
+                      << reservedCpus << " CPU(s) during this run" << Colors::Dim
+                      << " (--reserve " << reservation << ")" << Colors::Reset << "\n";
+        }
+
+        std::cout << "\n";
     }
 
     std::string toJson() const {
         std::ostringstream json{};
-        json << "{\n"
-             << "  \"command\": \"" << command << "\",\n"
-             << "  \"mean_ms\": " << std::fixed << std::setprecision(3) << mean << ",\n"
-             << "  \"std_dev_ms\": " << stdDev << ",\n"
-             << "  \"min_ms\": " << min << ",\n"
-             << "  \"max_ms\": " << max << ",\n"
-             << "  \"ops_per_sec\": " << std::fixed << std::setprecision(0) << (1000.0 / mean)
-             << ",\n"
-             << "  \"iterations\": " << iterations << "\n"
-             << "}\n";
+        json << "{\n";
+        if (!name.empty()) {
+            json << "  \"name\": \"" << escapeJson(name) << "\",\n";
+        }
+        if (!tags.empty()) {
+            json << "  \"tags\": [";
+            for (size_t i{0}; i < tags.size(); ++i) {
+                json << (i > 0 ? ", " : "") << "\"" << escapeJson(tags[i]) << "\"";
+            }
+            json << "],\n";
+        }
+        json << "  \"command\": \"" << escapeJson(command) << "\",\n";
+        if (iterations > 0 && mean > 0) {
+            // Sub-10µs results (in-process calls) keep nanosecond resolution
+            json << "  \"mean_ms\": " << std::fixed << std::setprecision(mean < 0.01 ? 6 : 3)
+                 << mean << ",\n"
+                 << "  \"std_dev_ms\": " << stdDev << ",\n"
+                 << "  \"min_ms\": " << min << ",\n"
+                 << "  \"max_ms\": " << max << ",\n"
+                 << "  \"ops_per_sec\": " << std::fixed << std::setprecision(0) << (1000.0 / mean)
+                 << ",\n";
+        } else {
+            // Interrupted before the first timed run finished: nothing to summarize
+            json << "  \"mean_ms\": null,\n"
+                 << "  \"std_dev_ms\": null,\n"
+                 << "  \"min_ms\": null,\n"
+                 << "  \"max_ms\": null,\n"
+                 << "  \"ops_per_sec\": null,\n";
+        }
+        json << "  \"iterations\": " << iterations;
+
+        if (!execMode.empty()) {
+            json << ",\n"
+                 << "  \"exec_mode\": \"" << execMode << "\"";
+        }
+
+        if (callsPerIteration > 0) {
+            json << ",\n"
+                 << "  \"calls_per_iteration\": " << callsPerIteration;
+        }
+
+        if (numaNode >= 0) {
+            json << ",\n"
+                 << "  \"numa_node\": " << numaNode;
+        }
+
+        if (bytesPerRun > 0 || itemsPerRun > 0) {
+            double value{}, low{}, high{};
+            json << ",\n"
+                 << "  \"throughput\": {" << std::fixed << std::setprecision(0);
+            if (bytesPerRun > 0) {
+                rate(bytesPerRun, value, low, high);
+                json << "\"bytes_per_run\": " << bytesPerRun << ", \"bytes_per_sec\": " << value
+                     << ", \"bytes_per_sec_ci95\": [" << low << ", " << jsonBound(high, 0) << "]";
+            }
+            if (itemsPerRun > 0) {
+                rate(itemsPerRun, value, low, high);
+                json << (bytesPerRun > 0 ? ", " : "") << std::setprecision(3)
+                     << "\"items_per_run\": " << itemsPerRun << ", \"items_per_sec\": " << value
+                     << ", \"items_per_sec_ci95\": [" << low << ", " << jsonBound(high, 3) << "]";
+            }
+            json << "}";
+        }
+
+        if (interrupted || resumedIterations > 0) {
+            json << ",\n"
+                 << "  \"planned_iterations\": " << plannedIterations << ",\n"
+                 << "  \"resumed_iterations\": " << resumedIterations << ",\n"
+                 << "  \"interrupted\": " << (interrupted ? "true" : "false");
+        }
+
+        if (!cacheKey.empty()) {
+            json << ",\n"
+                 << "  \"cache\": {\"key\": \"" << cacheKey
+                 << "\", \"hit\": " << (cachedAt > 0 ? "true" : "false")
+                 << ", \"measured_at\": " << cachedAt << "}";
+        }
+
+        if (failed()) {
+            json << ",\n"
+                 << "  \"failures\": {\"runs\": " << failedRuns
+                 << ", \"exit_code\": " << failureExit << ", \"signal\": " << failureSignal << "}";
+        }
+
+        if (!reservation.empty()) {
+            json << ",\n"
+                 << "  \"reservation\": {\"policy\": \"" << reservation << "\", \"cpus\": "
+                 << reservedCpus << ", \"contended_cpus\": " << contendedCpus
+                 << ", \"contention\": " << (contendedCpus > 0 ? "true" : "false") << "}";
+        }
+
+        if (hasSched) {
+            json << ",\n"
+                 << "  \"run_delay_mean_ms\": " << std::fixed << std::setprecision(3)
+                 << runDelayMean << ",\n"
+                 << "  \"run_delay_std_dev_ms\": " << runDelayStdDev << ",\n"
+                 << "  \"run_delay_min_ms\": " << runDelayMin << ",\n"
+                 << "  \"run_delay_max_ms\": " << runDelayMax << ",\n"
+                 << "  \"switches_per_run\": " << switchesPerRun << ",\n"
+                 << "  \"migrations_per_run\": " << migrationsPerRun;
+        }
+
+        if (hasIo) {
+            json << ",\n"
+                 << "  \"io\": {\n"
+                 << std::fixed << std::setprecision(0)
+                 << "    \"read_bytes_per_run\": " << readBytesPerRun << ",\n"
+                 << "    \"write_bytes_per_run\": " << writeBytesPerRun << ",\n"
+                 << "    \"rchar_per_run\": " << rcharPerRun << ",\n"
+                 << "    \"wchar_per_run\": " << wcharPerRun << ",\n"
+                 << std::setprecision(1)
+                 << "    \"syscr_per_run\": " << syscrPerRun << ",\n"
+                 << "    \"syscw_per_run\": " << syscwPerRun << ",\n"
+                 << std::setprecision(0)
+                 << "    \"storage_bytes_per_sec\": " << storageBytesPerSec() << "\n"
+                 << "  }";
+        }
+
+        if (hasUsage) {
+            json << ",\n"
+                 << "  \"usage\": {\n"
+                 << std::fixed << std::setprecision(3)
+                 << "    \"cpu_ms_mean\": " << cpuMean << ",\n"
+                 << "    \"cpu_ms_std_dev\": " << cpuStdDev << ",\n"
+                 << "    \"user_ms_mean\": " << userCpuMean << ",\n"
+                 << "    \"system_ms_mean\": " << systemCpuMean << ",\n"
+                 << std::setprecision(0)
+                 << "    \"peak_rss_bytes_mean\": " << peakRssMean << ",\n"
+                 << "    \"peak_rss_bytes_max\": " << peakRssMax << "\n"
+                 << "  }";
+        }
+
+        if (hasOutput) {
+            json << ",\n"
+                 << "  \"output\": {" << std::fixed << std::setprecision(0)
+                 << "\"bytes_mean\": " << outputBytesMean << ", \"bytes_min\": " << outputBytesMin
+                 << ", \"bytes_max\": " << outputBytesMax << "}";
+        }
+
+        if (!metrics.empty()) {
+            json << ",\n"
+                 << "  \"metrics\": {";
+            for (size_t i{0}; i < metrics.size(); ++i) {
+                const MetricSummary& m{metrics[i]};
+                json << (i > 0 ? "," : "") << "\n"
+                     << "    \"" << escapeJson(m.name) << "\": {\"mean\": " << std::defaultfloat
+                     << std::setprecision(9) << m.mean << ", \"std_dev\": " << m.stdDev
+                     << ", \"min\": " << m.min << ", \"max\": " << m.max
+                     << ", \"samples\": " << m.samples << "}";
+            }
+            json << "\n  }";
+        }
+
+        json << "\n}\n";
         return json.str();
     }
 };
@@ -186,9 +643,21 @@ struct BenchmarkResults {
 class ArgParser {
   private:
     std::map<std::string, std::string> arguments;
+    std::map<std::string, std::vector<std::string>> allValues;
     std::vector<std::string> positionalArgs;
     std::string programName;
 
+    // Options that never take a value, so a following command isn't swallowed as their argument
+    const std::set<std::string> flagOptions{"help", "shell", "sched-self", "mlock",
+                                            "live", "cache", "force", "tournament",
+                                            "parallel"};
+
+    static bool isNegativeNumber(const char* text) {
+        return text[0] == '-' &&
+               (std::isdigit(static_cast<unsigned char>(text[1])) ||
+                (text[1] == '.' && std::isdigit(static_cast<unsigned char>(text[2]))));
+    }
+
     void parseArgs(int argc, char** argv) {
         programName = std::string{argv[0]};
 
@@ -198,12 +667,25 @@ class ArgParser {
             if (arg.substr(0, 2) == "--") {
                 std::string key{arg.substr(2)};
 
-                if (i + 1 < argc && argv[i + 1][0] != '-') {
+                const size_t equals{key.find('=')};
+                if (equals != std::string::npos) {
+                    arguments[key.substr(0, equals)] = key.substr(equals + 1);
+                    allValues[key.substr(0, equals)].push_back(key.substr(equals + 1));
+                    continue;
+                }
+
+                // A lone "-" is a value (stdin/stdout), and so is a negative number like
+                // "--nice -5"; anything else starting with '-' is the next option
+                const bool hasValue{i + 1 < argc && (argv[i + 1][0] != '-' ||
+                                                     std::string{argv[i + 1]} == "-" ||
+                                                     isNegativeNumber(argv[i + 1]))};
+                if (flagOptions.count(key) == 0 && hasValue) {
                     arguments[key] = argv[i + 1];
                     ++i;
                 } else {
                     arguments[key] = "";
                 }
+                allValues[key].push_back(arguments[key]);
             } else {
                 positionalArgs.push_back(arg);
             }
@@ -225,6 +707,15 @@ class ArgParser {
         return (it != arguments.end()) ? it->second : defaultValue;
     }
 
+    /**
+     * @brief Every value given for a repeatable option, in command-line order.
+     */
+    std::vector<std::string> getAll(const std::string& key) const {
+        auto it{allValues.find(key)};
+
+        return (it != allValues.end()) ? it->second : std::vector<std::string>{};
+    }
+
     int getInt(const std::string& key, int defaultValue = 0) const {
         auto it{arguments.find(key)};
         if (it == arguments.end())
@@ -267,7 +758,7 @@ class ArgParser {
     }
 
     bool validate() const {
-        if (positionalArgs.empty()) {
+        if (positionalArgs.empty() && !has("resume") && !has("dlopen")) {
             std::cerr << Colors::BrightRed << "Error: " << Colors::Reset
                       << "No command specified to benchmark\n\n";
             std::cerr << Colors::Dim << "Usage: " << programName << " [OPTIONS] <command>\n";
@@ -384,10 +875,50 @@ class ArgParser {
             std::cout << "  " << programName << " --output json ls > out.json " << Colors::Dim
                       << "# Save JSON results\n"
                       << Colors::Reset;
+        } else if (option == "sched" || option == "nice" || option == "ionice") {
+            std::cout << Colors::Bold << Colors::BrightCyan
+                      << "--nice <n>, --sched <policy>, --ionice <class>" << Colors::Reset
+                      << "\n\n";
+            std::cout << Colors::Bold << "Description:\n" << Colors::Reset;
+            std::cout
+                << "  Applied to the benchmarked command between fork and exec (Linux only).\n";
+            std::cout << "  Running under SCHED_FIFO on a dedicated machine removes most\n";
+            std::cout << "  preemption noise. Add --sched-self to apply the same settings to\n";
+            std::cout << "  vajra itself, and --mlock to keep vajra's pages resident.\n\n";
+            std::cout << Colors::Bold << "Policies:\n" << Colors::Reset;
+            std::cout << "  other, batch, idle, fifo:<1-99>, rr:<1-99>\n\n";
+            std::cout << Colors::Bold << "I/O Classes:\n" << Colors::Reset;
+            std::cout << "  rt[:0-7], be[:0-7], idle\n\n";
+            std::cout << Colors::Bold << "Examples:\n" << Colors::Reset;
+            std::cout << "  sudo " << programName << " --sched fifo:50 --mlock ./prog   "
+                      << Colors::Dim << "# Real-time class\n"
+                      << Colors::Reset;
+            std::cout << "  " << programName << " --nice 10 --ionice idle ./prog      "
+                      << Colors::Dim << "# Background priority\n"
+                      << Colors::Reset;
+        } else if (option == "exec-mode") {
+            std::cout << Colors::Bold << Colors::BrightCyan << "--exec-mode <mode>" << Colors::Reset
+                      << "\n\n";
+            std::cout << Colors::Bold << "Description:\n" << Colors::Reset;
+            std::cout << "  Controls how the command's binary is found and loaded on each run.\n\n";
+            std::cout << Colors::Bold << "Default:\n" << Colors::Reset << "  resolved\n\n";
+            std::cout << Colors::Bold << "Available Modes:\n" << Colors::Reset;
+            std::cout << "  " << Colors::BrightGreen << "path" << Colors::Reset
+                      << "      - execvp, searching PATH on every run\n";
+            std::cout << "  " << Colors::BrightGreen << "resolved" << Colors::Reset
+                      << "  - PATH is searched once; each run is a plain execve\n";
+            std::cout << "  " << Colors::BrightGreen << "memfd" << Colors::Reset
+                      << "     - binary copied once into a sealed memfd and run with fexecve,\n";
+            std::cout << "              removing filesystem lookups and page-cache variance\n\n";
+            std::cout << Colors::Bold << "Examples:\n" << Colors::Reset;
+            std::cout << "  " << programName << " --exec-mode memfd ./prog     " << Colors::Dim
+                      << "# Exec from memory\n"
+                      << Colors::Reset;
         } else {
             std::cerr << Colors::BrightRed << "Error: " << Colors::Reset << "Unknown option '"
                       << option << "'\n\n";
-            std::cerr << "Available options: warmup, iterations, output\n";
+            std::cerr << "Available options: warmup, iterations, output, nice, sched, ionice, "
+                         "exec-mode\n";
             std::cerr << "Run '" << programName << " --help' for general help.\n";
         }
     }
@@ -415,6 +946,71 @@ class ArgParser {
                   << "    Output format: 'json' or 'text' (default: text)\n";
         std::cout << "  " << Colors::BrightCyan << "--shell" << Colors::Reset
                   << "              Execute command through shell (less accurate)\n";
+        std::cout << "  " << Colors::BrightCyan << "--prepare <cmd>" << Colors::Reset
+                  << "      Shell command run (untimed) before every run\n";
+        std::cout << "  " << Colors::BrightCyan << "--nice <n>" << Colors::Reset
+                  << "           Run the command at nice level n (-20..19)\n";
+        std::cout << "  " << Colors::BrightCyan << "--sched <policy>" << Colors::Reset
+                  << "     Scheduling policy: other, batch, idle, fifo:<p>, rr:<p>\n";
+        std::cout << "  " << Colors::BrightCyan << "--ionice <class>" << Colors::Reset
+                  << "     I/O priority: rt[:0-7], be[:0-7], idle\n";
+        std::cout << "  " << Colors::BrightCyan << "--sched-self" << Colors::Reset
+                  << "         Also apply --nice/--sched/--ionice to vajra itself\n";
+        std::cout << "  " << Colors::BrightCyan << "--mlock" << Colors::Reset
+                  << "              Lock vajra's memory so its page faults stay out of samples\n";
+        std::cout << "  " << Colors::BrightCyan << "--numa-node <n|all>" << Colors::Reset
+                  << "  Run on the CPUs of NUMA node n, or once per node to compare\n";
+        std::cout << "  " << Colors::BrightCyan << "--membind <nodes>" << Colors::Reset
+                  << "    Allocate memory only on these nodes ('local' = --numa-node)\n";
+        std::cout << "  " << Colors::BrightCyan << "--interleave <nodes>" << Colors::Reset
+                  << " Interleave memory across these nodes\n";
+        std::cout << "  " << Colors::BrightCyan << "--exec-mode <mode>" << Colors::Reset
+                  << "   path, resolved (default) or memfd; see --help exec-mode\n";
+        std::cout << "  " << Colors::BrightCyan << "--reserve <policy>" << Colors::Reset
+                  << "   CPU reservation between vajra processes: share (default),\n"
+                  << "                       wait, fail or none\n";
+        std::cout << "  " << Colors::BrightCyan << "--journal <file>" << Colors::Reset
+                  << "     Append every sample to a crash-safe journal\n";
+        std::cout << "  " << Colors::BrightCyan << "--resume <file>" << Colors::Reset
+                  << "      Continue the run recorded in a journal\n";
+        std::cout << "  " << Colors::BrightCyan << "--dlopen <so:symbol>" << Colors::Reset
+                  << "  Benchmark int symbol(const uint8_t*, size_t) in-process\n";
+        std::cout << "  " << Colors::BrightCyan << "--arg-file <file>" << Colors::Reset
+                  << "    Input passed to the --dlopen function (default: none)\n";
+        std::cout << "  " << Colors::BrightCyan << "--batch <n>" << Colors::Reset
+                  << "          Calls per --dlopen iteration (default: calibrated)\n";
+        std::cout << "  " << Colors::BrightCyan << "--collector <so[:args]>" << Colors::Reset
+                  << "\n                       Load a metric collector plugin (repeatable)\n";
+        std::cout << "  " << Colors::BrightCyan << "--live" << Colors::Reset
+                  << "               Publish running statistics for 'vajra top'\n";
+        std::cout << "  " << Colors::BrightCyan << "--export-openmetrics <file>" << Colors::Reset
+                  << "\n                       Also write results in OpenMetrics text format\n";
+        std::cout << "  " << Colors::BrightCyan << "--export-samples <file>" << Colors::Reset
+                  << "\n                       Write every run, column by column (.bin: binary, "
+                  << "else JSON)\n";
+        std::cout << "  " << Colors::BrightCyan << "--output-size <file|->" << Colors::Reset
+                  << "\n                       Record the size of a file each run writes, or of "
+                  << "stdout\n";
+        std::cout << "  " << Colors::BrightCyan << "--bytes <size>" << Colors::Reset
+                  << "       Bytes processed per run, e.g. 64M; reports MB/s with a 95% CI\n";
+        std::cout << "  " << Colors::BrightCyan << "--bytes-from <file>" << Colors::Reset
+                  << "  Take --bytes from the size of a file\n";
+        std::cout << "  " << Colors::BrightCyan << "--items <count>" << Colors::Reset
+                  << "      Items processed per run, e.g. 1M; reports items/s\n";
+        std::cout << "  " << Colors::BrightCyan << "--assert <slo>" << Colors::Reset
+                  << "       e.g. \"p99<20ms\", \"rss<200M\"; must hold at 95% (repeatable)\n";
+        std::cout << "  " << Colors::Dim << "  exit 2 if one fails, 3 if one can't be shown yet"
+                  << Colors::Reset << "\n";
+        std::cout << "  " << Colors::BrightCyan << "--cache" << Colors::Reset
+                  << "              Reuse a stored result when nothing it depends on changed\n";
+        std::cout << "  " << Colors::BrightCyan << "--force" << Colors::Reset
+                  << "              With --cache: measure anyway and refresh the entry\n";
+        std::cout << "  " << Colors::BrightCyan << "--cache-max-age <age>" << Colors::Reset
+                  << " Oldest result to reuse, e.g. 12h or 30d (default: 7d)\n";
+        std::cout << "  " << Colors::BrightCyan << "--cache-input <path>" << Colors::Reset
+                  << " File or directory the result depends on (repeatable)\n";
+        std::cout << "  " << Colors::BrightCyan << "--cache-env <name>" << Colors::Reset
+                  << "   Environment variable the result depends on (repeatable)\n";
         std::cout << "  " << Colors::BrightCyan << "--help" << Colors::Reset
                   << " [option]      Show help message (optionally for specific option)\n\n";
 
@@ -438,7 +1034,97 @@ class ArgParser {
         std::cout << "  " << Colors::BrightRed << "↑ (max)" << Colors::Reset
                   << "        Slowest execution time observed\n";
         std::cout << "  " << Colors::BrightYellow << "λ (rate)" << Colors::Reset
-                  << "       Operations per second (throughput)\n\n";
+                  << "       Operations per second (throughput)\n";
+        std::cout << "  " << Colors::BrightCyan << "⧗ (wait)" << Colors::Reset
+                  << "       Run-queue wait per run (Linux, direct execution)\n";
+        std::cout << "  " << Colors::BrightBlue << "⇅ (io)" << Colors::Reset
+                  << "         Storage and syscall I/O per run from /proc/<pid>/io\n";
+        std::cout << "  " << Colors::BrightYellow << "▣ (cpu)" << Colors::Reset
+                  << "        CPU time and peak RSS per run from wait4()\n";
+        std::cout << "  " << Colors::BrightGreen << "◧ (output)" << Colors::Reset
+                  << "     Bytes written per run (with --output-size)\n";
+        std::cout << "  " << Colors::BrightYellow << "⚡ (throughput)" << Colors::Reset
+                  << " Bytes or items per second (with --bytes/--items)\n\n";
+
+        std::cout << Colors::Bold << "SUITES:\n" << Colors::Reset;
+        std::cout << "  " << programName << " run <suite.toml>" << Colors::Dim
+                  << "   Run every [benchmark.<name>] in a suite file\n"
+                  << Colors::Reset;
+        std::cout << "  " << Colors::BrightCyan << "--tag <tag>" << Colors::Reset
+                  << "          Only run suite benchmarks with this tag\n";
+        std::cout << "  " << Colors::BrightCyan << "--jobs <n>" << Colors::Reset
+                  << "           Limit parallel 'core' benchmarks (default: physical cores)\n";
+        std::cout << "  " << Colors::BrightCyan << "--tournament" << Colors::Reset
+                  << "         Race the benchmarks; drop the significantly slower ones\n\n";
+
+        std::cout << Colors::Bold << "CORPUS:\n" << Colors::Reset;
+        std::cout << "  " << programName << " --corpus <dir> \"<command {file}>\"" << Colors::Dim
+                  << "\n                       Benchmark the command on every file below dir\n"
+                  << Colors::Reset;
+        std::cout << "  " << Colors::BrightCyan << "--worst <n>" << Colors::Reset
+                  << "          Slowest inputs per byte to list (default: 5)\n";
+        std::cout << "  " << Colors::BrightCyan << "--parallel" << Colors::Reset
+                  << "           Run files side by side, one per physical core (see --jobs)\n\n";
+
+        std::cout << Colors::Bold << "DAEMON:\n" << Colors::Reset;
+        std::cout << "  " << programName << " daemon" << Colors::Dim
+                  << "             Serve a calibrated measurement environment on a socket\n"
+                  << Colors::Reset;
+        std::cout << "  " << programName << " submit <command>" << Colors::Dim
+                  << "   Queue a benchmark on the running daemon\n"
+                  << Colors::Reset;
+        std::cout << "  " << Colors::BrightCyan << "--socket <path>" << Colors::Reset
+                  << "      Unix socket (default: $XDG_RUNTIME_DIR/vajra.sock)\n";
+        std::cout << "  " << Colors::BrightCyan << "--cpus <list>" << Colors::Reset
+                  << "        One daemon worker pinned to each CPU, e.g. 2,3\n\n";
+
+        std::cout << Colors::Bold << "MONITORING:\n" << Colors::Reset;
+        std::cout << "  " << programName << " top" << Colors::Dim
+                  << "                Live view of every vajra process run with --live\n\n"
+                  << Colors::Reset;
+
+        std::cout << Colors::Bold << "WATCH:\n" << Colors::Reset;
+        std::cout << "  " << programName << " watch <command>" << Colors::Dim
+                  << "    Rebuild and re-measure whenever watched files change\n"
+                  << Colors::Reset;
+        std::cout << "  " << Colors::BrightCyan << "--path <dirs>" << Colors::Reset
+                  << "        Comma-separated files or directories to watch (default: .)\n";
+        std::cout << "  " << Colors::BrightCyan << "--build <cmd>" << Colors::Reset
+                  << "        Shell command run after each change, e.g. \"ninja\"\n\n";
+
+        std::cout << Colors::Bold << "TUNE:\n" << Colors::Reset;
+        std::cout << "  " << programName << " tune <command>" << Colors::Dim
+                  << "     Search {placeholders} in the command for the fastest values\n"
+                  << Colors::Reset;
+        std::cout << "  " << Colors::BrightCyan << "--space <spec>" << Colors::Reset
+                  << "       e.g. level=1..19,threads=1|2|4|8 (repeatable)\n";
+        std::cout << "  " << Colors::BrightCyan << "--max-evals <n>" << Colors::Reset
+                  << "      Configurations to measure at most (default: 60)\n";
+        std::cout << "  " << Colors::Dim << "  --iterations sets the samples per configuration "
+                  << "(default: 20)" << Colors::Reset << "\n\n";
+
+        std::cout << Colors::Bold << "PERF-FUZZ:\n" << Colors::Reset;
+        std::cout << "  " << programName << " perf-fuzz <command {file}>" << Colors::Dim
+                  << "\n                       Mutate seed inputs to find the costliest per byte\n"
+                  << Colors::Reset;
+        std::cout << "  " << Colors::BrightCyan << "--seed-dir <dir>" << Colors::Reset
+                  << "     Example inputs to start from (required)\n";
+        std::cout << "  " << Colors::BrightCyan << "--out-dir <dir>" << Colors::Reset
+                  << "      Where slow, hanging and crashing inputs go (default: perf-fuzz-out)\n";
+        std::cout << "  " << Colors::BrightCyan << "--max-evals <n>" << Colors::Reset
+                  << "      Inputs to measure at most (default: 300)\n";
+        std::cout << "  " << Colors::BrightCyan << "--keep <n>" << Colors::Reset
+                  << "           Population of costliest inputs (default: 8)\n";
+        std::cout << "  " << Colors::BrightCyan << "--max-len <bytes>" << Colors::Reset
+                  << "    Largest input to try (default: twice the largest seed)\n";
+        std::cout << "  " << Colors::BrightCyan << "--min-slowdown <x>" << Colors::Reset
+                  << "   Report inputs at least x times the seeds' cost per byte (default: 1.5)\n";
+        std::cout << "  " << Colors::BrightCyan << "--cpu-limit <s>" << Colors::Reset
+                  << "      CPU seconds before a run counts as a hang (default: from the seeds)\n";
+        std::cout << "  " << Colors::BrightCyan << "--rng-seed <n>" << Colors::Reset
+                  << "       Repeat a previous search\n";
+        std::cout << "  " << Colors::Dim << "  --iterations sets the runs per input "
+                  << "(default: 3)" << Colors::Reset << "\n\n";
 
         std::cout << Colors::Bold << "EXAMPLES:\n" << Colors::Reset;
         std::cout << "  " << Colors::Dim << "# Basic usage\n" << Colors::Reset;
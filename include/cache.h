@@ -0,0 +1,337 @@
+#ifndef CACHE_H
+#define CACHE_H
+
+#include "argparser.h"
+#include "json.h"
+
+#include <cstdint>
+#include <cstdio>
+#include <algorithm>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <functional>
+#include <iomanip>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/stat.h>
+#include <sys/utsname.h>
+#include <unistd.h>
+#endif
+
+namespace Cache {
+
+/**
+ * @brief What may be reused and what else goes into the key, from --cache and friends.
+ */
+struct Policy {
+    bool force{false};
+    long long maxAgeSeconds{7 * 24 * 3600};
+    std::vector<std::string> inputs{};
+    std::vector<std::string> env{};
+};
+
+/**
+ * @brief Environment variables that change how a program runs, always part of the key. Anything
+ * else (CI job ids, PWD, ...) would only make every key unique; add those with --cache-env.
+ */
+inline const std::vector<std::string> DefaultEnv{
+    "PATH",           "LD_LIBRARY_PATH",  "LD_PRELOAD",      "LD_BIND_NOW", "GLIBC_TUNABLES",
+    "MALLOC_ARENA_MAX", "OMP_NUM_THREADS", "LANG",          "LC_ALL",      "TZ",
+};
+
+/**
+ * @brief 64-bit FNV-1a. Not cryptographic; keys only have to tell our own builds apart.
+ */
+class Hasher {
+  private:
+    uint64_t state{14695981039346656037ULL};
+
+  public:
+    void update(const void* data, size_t size) {
+        const auto* bytes{static_cast<const unsigned char*>(data)};
+        for (size_t i{0}; i < size; ++i) {
+            state ^= bytes[i];
+            state *= 1099511628211ULL;
+        }
+    }
+
+    void update(const std::string& text) {
+        update(text.data(), text.size());
+        update("\0", 1); // so ("ab","c") and ("a","bc") differ
+    }
+
+    std::string hex() const {
+        std::ostringstream out{};
+        out << std::hex << std::setw(16) << std::setfill('0') << state;
+        return out.str();
+    }
+};
+
+inline bool hashFile(const std::string& path, std::string& digest) {
+    std::ifstream file{path, std::ios::binary};
+    if (!file) {
+        return false;
+    }
+
+    Hasher hasher{};
+    char buffer[1 << 16];
+    while (file.read(buffer, sizeof(buffer)) || file.gcount() > 0) {
+        hasher.update(buffer, static_cast<size_t>(file.gcount()));
+    }
+    digest = hasher.hex();
+    return true;
+}
+
+inline bool isRegularFile(const std::string& path) {
+#ifdef __linux__
+    struct stat st{};
+    return stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode);
+#else
+    std::ifstream file{path};
+    return static_cast<bool>(file);
+#endif
+}
+
+/**
+ * @brief Shared libraries the dynamic loader resolves for an executable, as ldd reports them.
+ */
+inline std::vector<std::string> sharedLibraries(const std::string& executable) {
+    std::vector<std::string> libraries{};
+#ifdef __linux__
+    std::string quoted{"'"};
+    for (char c : executable) {
+        quoted += c == '\'' ? std::string{"'\\''"} : std::string{c};
+    }
+    quoted += "'";
+
+    std::FILE* pipe{popen(("ldd " + quoted + " 2>/dev/null").c_str(), "r")};
+    if (!pipe) {
+        return libraries;
+    }
+
+    char line[4096];
+    while (std::fgets(line, sizeof(line), pipe)) {
+        // "libc.so.6 => /lib/x86_64-linux-gnu/libc.so.6 (0x...)" or "/lib64/ld-linux... (0x...)"
+        std::istringstream fields{line};
+        std::string word{};
+        while (fields >> word) {
+            if (!word.empty() && word[0] == '/') {
+                libraries.push_back(word);
+                break;
+            }
+        }
+    }
+    pclose(pipe);
+#else
+    (void)executable;
+#endif
+    return libraries;
+}
+
+/**
+ * @brief Describes the machine closely enough that a result measured elsewhere is never reused.
+ */
+inline std::string machineFingerprint() {
+    std::ostringstream out{};
+#ifdef __linux__
+    utsname info{};
+    if (uname(&info) == 0) {
+        out << info.nodename << "|" << info.release << "|" << info.machine << "|";
+    }
+
+    std::ifstream cpuinfo{"/proc/cpuinfo"};
+    std::string line{};
+    while (std::getline(cpuinfo, line)) {
+        if (line.rfind("model name", 0) == 0 || line.rfind("microcode", 0) == 0) {
+            out << line.substr(line.find(':') + 1) << "|";
+            break;
+        }
+    }
+    out << sysconf(_SC_NPROCESSORS_ONLN) << "|"
+        << sysconf(_SC_PHYS_PAGES) * sysconf(_SC_PAGESIZE) << "|";
+
+    std::ifstream governor{"/sys/devices/system/cpu/cpu0/cpufreq/scaling_governor"};
+    if (std::getline(governor, line)) {
+        out << line;
+    }
+#endif
+    return out.str();
+}
+
+/**
+ * @brief Parse an age like "90m", "12h" or "7d" (plain numbers are seconds).
+ */
+inline bool parseAge(const std::string& text, long long& seconds) {
+    if (text.empty()) {
+        return false;
+    }
+    char* end{nullptr};
+    const long long value{std::strtoll(text.c_str(), &end, 10)};
+    if (end == text.c_str() || value < 0) {
+        return false;
+    }
+
+    const std::string unit{end};
+    if (unit.empty() || unit == "s") {
+        seconds = value;
+    } else if (unit == "m") {
+        seconds = value * 60;
+    } else if (unit == "h") {
+        seconds = value * 3600;
+    } else if (unit == "d") {
+        seconds = value * 86400;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief $VAJRA_CACHE_DIR, else $XDG_CACHE_HOME/vajra, else ~/.cache/vajra.
+ */
+inline std::string directory() {
+    const char* custom{std::getenv("VAJRA_CACHE_DIR")};
+    if (custom && *custom) {
+        return custom;
+    }
+    const char* xdg{std::getenv("XDG_CACHE_HOME")};
+    if (xdg && *xdg) {
+        return std::string{xdg} + "/vajra";
+    }
+    const char* home{std::getenv("HOME")};
+    return std::string{home ? home : "."} + "/.cache/vajra";
+}
+
+/**
+ * @brief A cache key: the digest identifies the entry, the components explain it.
+ */
+struct Key {
+    std::vector<std::pair<std::string, std::string>> components{};
+
+    void add(const std::string& name, const std::string& value) {
+        components.emplace_back(name, value);
+    }
+
+    std::string digest() const {
+        Hasher hasher{};
+        for (const auto& [name, value] : components) {
+            hasher.update(name);
+            hasher.update(value);
+        }
+        return hasher.hex();
+    }
+};
+
+/**
+ * @brief Add a declared input to the key: a file's content, or every file below a directory.
+ */
+inline void addInput(Key& key, const std::string& path) {
+    std::error_code ec{};
+    if (!std::filesystem::is_directory(path, ec)) {
+        std::string digest{};
+        key.add("input:" + path, hashFile(path, digest) ? digest : "(missing)");
+        return;
+    }
+
+    std::vector<std::string> files{};
+    for (auto it{std::filesystem::recursive_directory_iterator(
+             path, std::filesystem::directory_options::skip_permission_denied, ec)};
+         it != std::filesystem::recursive_directory_iterator{}; it.increment(ec)) {
+        if (it->is_regular_file(ec)) {
+            files.push_back(it->path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    for (const auto& file : files) {
+        std::string digest{};
+        if (hashFile(file, digest)) {
+            key.add("input:" + file, digest);
+        }
+    }
+}
+
+/**
+ * @brief Reuse a stored result for this key if it is younger than maxAgeSeconds.
+ */
+inline bool load(const Key& key, long long maxAgeSeconds, BenchmarkResults& results) {
+    const std::string id{key.digest()};
+    std::ifstream file{directory() + "/" + id + ".json"};
+    if (!file) {
+        return false;
+    }
+
+    std::stringstream text{};
+    text << file.rdbuf();
+    Json::Value entry{};
+    if (!Json::parse(text.str(), entry) || entry.getString("key") != id) {
+        return false;
+    }
+
+    const long long measuredAt{static_cast<long long>(entry.getNumber("measured_at"))};
+    const Json::Value* stored{entry.find("result")};
+    if (!stored || std::time(nullptr) - measuredAt > maxAgeSeconds) {
+        return false;
+    }
+
+    results = Json::toResults(*stored);
+    results.cacheKey = id;
+    results.cachedAt = measuredAt;
+    return true;
+}
+
+/**
+ * @brief Store a fresh result, replacing any older entry atomically.
+ */
+inline void store(const Key& key, const BenchmarkResults& results) {
+    const std::string dir{directory()};
+#ifdef __linux__
+    std::string partial{};
+    for (size_t pos{1}; pos != std::string::npos;) {
+        pos = dir.find('/', pos + 1);
+        partial = dir.substr(0, pos);
+        mkdir(partial.c_str(), 0755);
+    }
+#endif
+
+    const std::string id{key.digest()};
+    std::ostringstream entry{};
+    entry << "{\n"
+          << "  \"key\": \"" << id << "\",\n"
+          << "  \"measured_at\": " << std::time(nullptr) << ",\n"
+          << "  \"components\": {";
+    for (size_t i{0}; i < key.components.size(); ++i) {
+        entry << (i > 0 ? "," : "") << "\n    \"" << BenchmarkResults::escapeJson(
+                                                        key.components[i].first)
+              << "\": \"" << BenchmarkResults::escapeJson(key.components[i].second) << "\"";
+    }
+    entry << "\n  },\n"
+          << "  \"result\": " << results.toJson() << "}\n";
+
+    const std::string path{dir + "/" + id + ".json"};
+    // Unique per process and thread, so concurrent stores of the same key never share a temp file
+    std::string temp{path + ".tmp."};
+#ifdef __linux__
+    temp += std::to_string(getpid()) + ".";
+#endif
+    temp += std::to_string(std::hash<std::thread::id>{}(std::this_thread::get_id()));
+    {
+        std::ofstream file{temp, std::ios::trunc};
+        file << entry.str();
+        if (!file) {
+            std::remove(temp.c_str());
+            return;
+        }
+    }
+    std::rename(temp.c_str(), path.c_str());
+}
+
+} // namespace Cache
+
+#endif
@@ -0,0 +1,237 @@
+#ifndef COLLECTOR_H
+#define COLLECTOR_H
+
+#include "argparser.h"
+#include "vajra_collector.h"
+
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef __linux__
+#include <dlfcn.h>
+#endif
+
+namespace Collector {
+
+/**
+ * @brief Values one collector reported for a single run, as (metric, value) pairs.
+ */
+using Values = std::vector<std::pair<std::string, double>>;
+
+/**
+ * @brief A source of per-run metrics. Hooks run at fixed points around every timed run; only
+ * values emitted from afterExit() end up in the results.
+ */
+class Collector {
+  public:
+    virtual ~Collector() = default;
+
+    virtual std::string name() const = 0;
+
+    virtual std::chrono::milliseconds period() const {
+        return std::chrono::milliseconds{0};
+    }
+
+    virtual void beforeSpawn() {}
+
+    /**
+     * @brief Runs in the forked child before exec; must stay async-signal-safe.
+     */
+    virtual void inChild() {}
+
+    virtual void periodic(int) {}
+
+    /**
+     * @brief Runs after the child exited, while it is still an unreaped zombie.
+     */
+    virtual void afterExit(int, Values&) {}
+};
+
+/**
+ * @brief Adapter from the C plugin ABI in vajra_collector.h.
+ */
+class Plugin : public Collector {
+  private:
+    void* handle{nullptr};
+    const vajra_collector* vtable{nullptr};
+    void* state{nullptr};
+
+    static void emit(void* ctx, const char* metric, double value) {
+        auto* out{static_cast<Values*>(ctx)};
+        out->emplace_back(metric ? metric : "", value);
+    }
+
+  public:
+    Plugin(void* library, const vajra_collector* collector, void* pluginState)
+        : handle{library}, vtable{collector}, state{pluginState} {}
+
+    Plugin(const Plugin&) = delete;
+    Plugin& operator=(const Plugin&) = delete;
+
+    ~Plugin() override {
+        if (vtable->destroy) {
+            vtable->destroy(state);
+        }
+#ifdef __linux__
+        dlclose(handle);
+#endif
+    }
+
+    std::string name() const override {
+        return vtable->name ? vtable->name : "plugin";
+    }
+
+    std::chrono::milliseconds period() const override {
+        return std::chrono::milliseconds{vtable->periodic ? vtable->period_ms : 0};
+    }
+
+    void beforeSpawn() override {
+        if (vtable->before_spawn) {
+            vtable->before_spawn(state);
+        }
+    }
+
+    void inChild() override {
+        if (vtable->in_child) {
+            vtable->in_child(state);
+        }
+    }
+
+    void periodic(int pid) override {
+        vtable->periodic(state, pid);
+    }
+
+    void afterExit(int pid, Values& out) override {
+        if (vtable->after_exit) {
+            vtable->after_exit(state, pid, &Plugin::emit, &out);
+        }
+    }
+};
+
+/**
+ * @brief Load a collector from 'path[:args]'.
+ */
+inline std::unique_ptr<Collector> load(const std::string& spec) {
+#ifdef __linux__
+    const size_t colon{spec.find(':')};
+    const std::string path{spec.substr(0, colon)};
+    const std::string args{colon == std::string::npos ? "" : spec.substr(colon + 1)};
+
+    // dlopen only searches the library path for bare names; treat them as relative paths
+    const std::string openPath{path.find('/') == std::string::npos ? "./" + path : path};
+    void* handle{dlopen(openPath.c_str(), RTLD_NOW | RTLD_LOCAL)};
+    if (!handle) {
+        std::cerr << Colors::BrightRed << "Error: " << Colors::Reset << "Cannot load collector: "
+                  << dlerror() << "\n";
+        return nullptr;
+    }
+
+    auto entry{
+        reinterpret_cast<vajra_collector_entry_fn>(dlsym(handle, "vajra_collector_entry"))};
+    const vajra_collector* collector{entry ? entry() : nullptr};
+    if (!collector || collector->abi != VAJRA_COLLECTOR_ABI) {
+        std::cerr << Colors::BrightRed << "Error: " << Colors::Reset << "'" << path
+                  << "' is not a vajra collector (ABI " << VAJRA_COLLECTOR_ABI << ")\n";
+        dlclose(handle);
+        return nullptr;
+    }
+
+    void* state{collector->create ? collector->create(args.c_str()) : nullptr};
+    return std::make_unique<Plugin>(handle, collector, state);
+#else
+    std::cerr << Colors::BrightRed << "Error: " << Colors::Reset << "Cannot load '" << spec
+              << "': collector plugins are only supported on Linux\n";
+    return nullptr;
+#endif
+}
+
+/**
+ * @brief The collectors attached to a benchmark, driven as one.
+ */
+class Set {
+  private:
+    std::vector<std::unique_ptr<Collector>> collectors{};
+    mutable std::vector<std::chrono::steady_clock::time_point> due{};
+
+  public:
+    void add(std::unique_ptr<Collector> collector) {
+        collectors.push_back(std::move(collector));
+        due.emplace_back();
+    }
+
+    bool empty() const {
+        return collectors.empty();
+    }
+
+    /**
+     * @brief Shortest non-zero period among the collectors, or zero if none polls.
+     */
+    std::chrono::milliseconds period() const {
+        std::chrono::milliseconds shortest{0};
+        for (const auto& c : collectors) {
+            auto p{c->period()};
+            if (p.count() > 0 && (shortest.count() == 0 || p < shortest)) {
+                shortest = p;
+            }
+        }
+        return shortest;
+    }
+
+    void beforeSpawn() const {
+        const auto now{std::chrono::steady_clock::now()};
+        for (size_t i{0}; i < collectors.size(); ++i) {
+            due[i] = now + collectors[i]->period();
+            collectors[i]->beforeSpawn();
+        }
+    }
+
+    void inChild() const {
+        for (const auto& c : collectors) {
+            c->inChild();
+        }
+    }
+
+    /**
+     * @brief Call every polling collector whose own period has elapsed.
+     */
+    void periodic(int pid) const {
+        const auto now{std::chrono::steady_clock::now()};
+        for (size_t i{0}; i < collectors.size(); ++i) {
+            const auto p{collectors[i]->period()};
+            if (p.count() > 0 && now >= due[i]) {
+                collectors[i]->periodic(pid);
+                due[i] = now + p;
+            }
+        }
+    }
+
+    /**
+     * @brief Gather every collector's values, named "<collector>.<metric>".
+     */
+    Values afterExit(int pid) const {
+        Values all{};
+        for (const auto& c : collectors) {
+            Values own{};
+            c->afterExit(pid, own);
+            for (auto& [metric, value] : own) {
+                std::string name{c->name() + "." + metric};
+                // Names end up in journals and label values, so keep them to one token
+                std::replace_if(
+                    name.begin(), name.end(),
+                    [](unsigned char ch) { return std::isspace(ch) || ch == '='; }, '_');
+                all.emplace_back(std::move(name), value);
+            }
+        }
+        return all;
+    }
+};
+
+} // namespace Collector
+
+#endif
@@ -0,0 +1,256 @@
+#ifndef CORPUS_H
+#define CORPUS_H
+
+#include "argparser.h"
+#include "exec.h"
+#include "runner.h"
+#include "suite.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace Corpus {
+
+/**
+ * @brief An input counts as pathological when its time per byte is at least this many times the
+ * corpus median.
+ */
+constexpr double OutlierFactor{2.0};
+
+/**
+ * @brief Every regular file below dir, sorted so the report order is stable.
+ */
+inline std::vector<std::string> listFiles(const std::string& dir) {
+    std::vector<std::string> files{};
+    std::error_code ec{};
+    for (auto it{std::filesystem::recursive_directory_iterator(
+             dir, std::filesystem::directory_options::skip_permission_denied, ec)};
+         it != std::filesystem::recursive_directory_iterator{}; it.increment(ec)) {
+        if (it->is_regular_file(ec)) {
+            files.push_back(it->path().string());
+        }
+    }
+    std::sort(files.begin(), files.end());
+    return files;
+}
+
+/**
+ * @brief Quote a path for the command line if it would otherwise split into several words.
+ */
+inline std::string quote(const std::string& path) {
+    return path.find_first_of(" \t") == std::string::npos ? path : "\"" + path + "\"";
+}
+
+/**
+ * @brief One suite entry per file, with {file} replaced and the file size as work per run.
+ * @param parallel Run files side by side, one per physical core, instead of one at a time.
+ */
+inline bool load(const std::string& dir, const std::string& templ, const BenchmarkConfig& base,
+                 Exec::Mode mode, bool parallel, std::vector<Suite::Entry>& entries) {
+    std::error_code ec{};
+    if (!std::filesystem::is_directory(dir, ec)) {
+        Suite::printError("'" + dir + "' is not a directory");
+        return false;
+    }
+    if (templ.find("{file}") == std::string::npos) {
+        Suite::printError("The command has no {file} placeholder, e.g. \"./parser {file}\"");
+        return false;
+    }
+
+    for (const auto& file : listFiles(dir)) {
+        Suite::Entry entry{};
+        entry.name = std::filesystem::relative(file, dir, ec).string();
+        if (ec || entry.name.empty()) {
+            entry.name = file;
+        }
+        entry.parallel = parallel;
+        entry.config = base;
+        entry.config.quiet = true;
+        entry.config.command = Suite::replaceAll(templ, "{file}", quote(file));
+        entry.config.prepare = Suite::replaceAll(base.prepare, "{file}", quote(file));
+        entry.config.outputSize = Suite::replaceAll(base.outputSize, "{file}", file);
+        if (!fileBytes(file, entry.config.workBytes)) {
+            entry.config.workBytes = 0;
+        }
+
+        if (!entry.config.useShell) {
+            entry.config.cmdArgs = parseCommand(entry.config.command);
+            if (entry.config.cmdArgs.empty()) {
+                Suite::printError("Failed to parse command for '" + file + "'");
+                return false;
+            }
+#ifdef __linux__
+            auto image{std::make_shared<Exec::Image>()};
+            if (!Exec::prepare(*image, entry.config.cmdArgs, mode)) {
+                return false;
+            }
+            entry.config.image = image;
+#else
+            (void)mode;
+#endif
+        }
+
+        entries.push_back(std::move(entry));
+    }
+
+    if (entries.empty()) {
+        Suite::printError("No files found in '" + dir + "'");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Milliseconds per megabyte of input, or -1 for empty files (which have no rate).
+ */
+inline double msPerMB(const BenchmarkResults& r) {
+    return r.bytesPerRun > 0 ? r.mean * 1048576.0 / r.bytesPerRun : -1.0;
+}
+
+/**
+ * @brief Corpus-wide view: which inputs are slow for their size.
+ */
+struct Summary {
+    double totalBytes{0};
+    double totalMs{0};
+    double medianMsPerMB{0};
+    std::vector<size_t> worst{}; // by time per byte, slowest first
+};
+
+inline Summary summarize(const std::vector<BenchmarkResults>& results, size_t worstCount) {
+    Summary summary{};
+    std::vector<size_t> rated{};
+    for (size_t i{0}; i < results.size(); ++i) {
+        if (results[i].reservationFailed || results[i].failed()) {
+            continue;
+        }
+        summary.totalBytes += results[i].bytesPerRun;
+        summary.totalMs += results[i].mean;
+        if (msPerMB(results[i]) > 0) {
+            rated.push_back(i);
+        }
+    }
+
+    std::sort(rated.begin(), rated.end(),
+              [&](size_t a, size_t b) { return msPerMB(results[a]) > msPerMB(results[b]); });
+    if (!rated.empty()) {
+        const size_t mid{rated.size() / 2};
+        summary.medianMsPerMB =
+            rated.size() % 2 == 1
+                ? msPerMB(results[rated[mid]])
+                : (msPerMB(results[rated[mid - 1]]) + msPerMB(results[rated[mid]])) / 2.0;
+    }
+    rated.resize(std::min(rated.size(), worstCount));
+    summary.worst = std::move(rated);
+    return summary;
+}
+
+inline void display(const std::string& dir, const std::vector<BenchmarkResults>& results,
+                    const Summary& summary) {
+    size_t nameWidth{4};
+    for (const auto& r : results) {
+        nameWidth = std::max(nameWidth, r.name.size());
+    }
+
+    std::cout << "\n"
+              << Colors::Bold << Colors::BrightWhite << "Corpus: " << Colors::Reset << dir << "  "
+              << Colors::Dim << "(" << results.size() << " files, "
+              << BenchmarkResults::formatBytes(summary.totalBytes) << ")" << Colors::Reset << "\n";
+    std::cout << Colors::Bold << "  " << std::left << std::setw(static_cast<int>(nameWidth))
+              << "file" << std::right << std::setw(12) << "size" << std::setw(12) << "μ (ms)"
+              << std::setw(12) << "σ (ms)" << std::setw(12) << "max (ms)" << std::setw(14)
+              << "ms/MB" << std::setw(16) << "throughput" << Colors::Reset << "\n";
+
+    for (const auto& r : results) {
+        double value{}, low{}, high{};
+        r.rate(r.bytesPerRun, value, low, high);
+        const double cost{msPerMB(r)};
+        const bool outlier{summary.medianMsPerMB > 0 &&
+                           cost >= OutlierFactor * summary.medianMsPerMB};
+
+        std::ostringstream perMB{};
+        if (r.failed()) {
+            perMB << "failed";
+        } else if (cost > 0) {
+            perMB << std::fixed << std::setprecision(3) << cost;
+        } else {
+            perMB << "-";
+        }
+
+        std::cout << "  " << (outlier ? Colors::BrightRed : "") << std::left
+                  << std::setw(static_cast<int>(nameWidth)) << r.name << Colors::Reset
+                  << std::right << std::setw(12) << BenchmarkResults::formatBytes(r.bytesPerRun)
+                  << std::fixed << std::setprecision(3) << Colors::BrightGreen << std::setw(12)
+                  << r.mean << Colors::Reset << Colors::BrightMagenta << std::setw(12) << r.stdDev
+                  << Colors::Reset << Colors::BrightRed << std::setw(12) << r.max << Colors::Reset
+                  << std::setw(14) << perMB.str() << Colors::BrightYellow << std::setw(16)
+                  << (r.bytesPerRun > 0 ? BenchmarkResults::formatBytes(value) + "/s" : "-")
+                  << Colors::Reset << "\n";
+    }
+
+    std::cout << "\n"
+              << Colors::Bold << "Aggregate: " << Colors::Reset
+              << BenchmarkResults::formatBytes(summary.totalMs > 0
+                                                   ? summary.totalBytes / (summary.totalMs / 1000.0)
+                                                   : 0.0)
+              << "/s" << Colors::Dim << " over the whole corpus, median " << std::fixed
+              << std::setprecision(3) << summary.medianMsPerMB << " ms/MB" << Colors::Reset
+              << "\n\n";
+
+    if (summary.worst.empty()) {
+        return;
+    }
+    std::cout << Colors::Bold << Colors::BrightWhite << "Slowest inputs per byte:" << Colors::Reset
+              << "\n";
+    for (size_t rank{0}; rank < summary.worst.size(); ++rank) {
+        const BenchmarkResults& r{results[summary.worst[rank]]};
+        const double factor{summary.medianMsPerMB > 0 ? msPerMB(r) / summary.medianMsPerMB : 0};
+        std::cout << "  " << rank + 1 << ". " << (factor >= OutlierFactor ? Colors::BrightRed : "")
+                  << r.name << Colors::Reset << Colors::Dim << "  " << std::fixed
+                  << std::setprecision(3) << msPerMB(r) << " ms/MB, " << std::setprecision(1)
+                  << factor << "× median" << Colors::Reset << "\n";
+    }
+    std::cout << "\n";
+}
+
+inline std::string toJson(const std::string& dir, const std::vector<BenchmarkResults>& results,
+                          const Summary& summary) {
+    std::ostringstream json{};
+    json << "{\n"
+         << "  \"corpus\": \"" << BenchmarkResults::escapeJson(dir) << "\",\n"
+         << "  \"benchmarks\": [\n";
+    for (size_t i{0}; i < results.size(); ++i) {
+        std::string item{results[i].toJson()};
+        item.pop_back();
+        json << item << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+
+    json << "  ],\n"
+         << "  \"summary\": {" << std::fixed << std::setprecision(3)
+         << "\"files\": " << results.size() << ", \"total_bytes\": " << std::setprecision(0)
+         << summary.totalBytes << ", \"bytes_per_sec\": "
+         << (summary.totalMs > 0 ? summary.totalBytes / (summary.totalMs / 1000.0) : 0.0)
+         << std::setprecision(3) << ", \"median_ms_per_mb\": " << summary.medianMsPerMB
+         << "},\n"
+         << "  \"worst\": [";
+    for (size_t rank{0}; rank < summary.worst.size(); ++rank) {
+        const BenchmarkResults& r{results[summary.worst[rank]]};
+        json << (rank > 0 ? ", " : "") << "{\"file\": \"" << BenchmarkResults::escapeJson(r.name)
+             << "\", \"ms_per_mb\": " << msPerMB(r) << ", \"vs_median\": "
+             << (summary.medianMsPerMB > 0 ? msPerMB(r) / summary.medianMsPerMB : 0.0) << "}";
+    }
+    json << "]\n"
+         << "}\n";
+    return json.str();
+}
+
+} // namespace Corpus
+
+#endif
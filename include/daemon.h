@@ -0,0 +1,482 @@
+#ifndef DAEMON_H
+#define DAEMON_H
+
+#include "argparser.h"
+#include "json.h"
+#include "runner.h"
+
+#include <cerrno>
+#include <cmath>
+#include <condition_variable>
+#include <csignal>
+#include <cstring>
+#include <deque>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifdef __linux__
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace Daemon {
+
+inline std::string defaultSocketPath() {
+    const char* runtimeDir{std::getenv("XDG_RUNTIME_DIR")};
+    if (runtimeDir && *runtimeDir) {
+        return std::string{runtimeDir} + "/vajra.sock";
+    }
+#ifdef __linux__
+    return "/tmp/vajra-" + std::to_string(getuid()) + ".sock";
+#else
+    return "vajra.sock";
+#endif
+}
+
+inline void printError(const std::string& message) {
+    std::cerr << Colors::BrightRed << "Error: " << Colors::Reset << message << "\n";
+}
+
+#ifdef __linux__
+
+/**
+ * @brief A client connection. Jobs hold a reference, so the socket stays open until the client
+ * has hung up and its last queued job has reported back.
+ */
+struct Connection {
+    int fd{-1};
+    std::mutex writeMutex{};
+
+    explicit Connection(int socket) : fd{socket} {}
+
+    ~Connection() {
+        close(fd);
+    }
+
+    void send(const std::string& line) {
+        std::lock_guard<std::mutex> lock{writeMutex};
+        std::string data{line + "\n"};
+        for (size_t sent{0}; sent < data.size();) {
+            ssize_t n{::send(fd, data.data() + sent, data.size() - sent, MSG_NOSIGNAL)};
+            if (n <= 0) {
+                return;
+            }
+            sent += static_cast<size_t>(n);
+        }
+    }
+};
+
+struct Job {
+    uint64_t id{};
+    BenchmarkConfig config{};
+    std::shared_ptr<Connection> client{};
+};
+
+/**
+ * @brief Calibration measured once at startup and reported with every result.
+ */
+struct Calibration {
+    double spawnMean{};
+    double spawnStdDev{};
+    double runDelayMean{};
+};
+
+class Server {
+  private:
+    BenchmarkConfig base;
+    std::vector<int> cpus;
+    Calibration calibration{};
+
+    std::mutex queueMutex{};
+    std::condition_variable queueReady{};
+    std::deque<Job> queue{};
+    uint64_t nextId{1};
+    size_t running{0};
+
+    static std::string event(const std::string& name, uint64_t id, const std::string& rest = "") {
+        std::string line{"{\"event\": \"" + name + "\", \"job\": " + std::to_string(id)};
+        if (!rest.empty()) {
+            line += ", " + rest;
+        }
+        return line + "}";
+    }
+
+    static std::string errorEvent(const std::string& message) {
+        return "{\"event\": \"error\", \"message\": \"" + BenchmarkResults::escapeJson(message) +
+               "\"}";
+    }
+
+    std::string calibrationJson() const {
+        std::ostringstream json{};
+        json << std::fixed << std::setprecision(3) << "\"calibration\": {\"spawn_overhead_ms\": "
+             << calibration.spawnMean << ", \"spawn_overhead_std_dev_ms\": "
+             << calibration.spawnStdDev << ", \"run_delay_ms\": " << calibration.runDelayMean
+             << "}";
+        return json.str();
+    }
+
+    /**
+     * @brief Read a count from an untrusted request: it must be a whole number in [0, INT_MAX].
+     */
+    static bool getCount(const Json::Value& request, const char* key, int fallback, int& out) {
+        const double value{request.getNumber(key, fallback)};
+        if (!std::isfinite(value) || value != std::floor(value) || value < 0 ||
+            value > std::numeric_limits<int>::max()) {
+            return false;
+        }
+        out = static_cast<int>(value);
+        return true;
+    }
+
+    bool makeJob(const Json::Value& request, Job& job, std::string& error) const {
+        job.config = base;
+        job.config.quiet = true;
+        job.config.command = request.getString("command");
+        job.config.prepare = request.getString("prepare", base.prepare);
+
+        if (job.config.command.empty()) {
+            error = "request has no command";
+            return false;
+        }
+        // Relative commands, inputs and PATH entries mean what they mean to the client
+        job.config.workDir = request.getString("cwd");
+        if (!job.config.workDir.starts_with('/')) {
+            error = "request has no absolute cwd";
+            return false;
+        }
+        if (const Json::Value* env{request.find("env")}) {
+            for (const auto& var : env->array) {
+                job.config.env.push_back(var.string);
+            }
+        }
+        if (!getCount(request, "warmup", base.warmup, job.config.warmup) ||
+            !getCount(request, "iterations", base.iterations, job.config.iterations) ||
+            job.config.iterations == 0) {
+            error = "iterations must be a positive and warmup a non-negative whole number";
+            return false;
+        }
+
+        if (request.getBool("shell")) {
+            job.config.cmdArgs = {"/bin/sh", "-c", job.config.command};
+        } else {
+            job.config.cmdArgs = parseCommand(job.config.command);
+        }
+        if (job.config.cmdArgs.empty()) {
+            error = "failed to parse command";
+            return false;
+        }
+
+        Exec::Mode mode{base.image ? base.image->mode : Exec::Mode::Resolved};
+        if (request.find("exec_mode") && !Exec::parseMode(request.getString("exec_mode"), mode)) {
+            error = "exec_mode must be 'path', 'resolved' or 'memfd'";
+            return false;
+        }
+
+        auto image{std::make_shared<Exec::Image>()};
+        if (!Exec::prepare(*image, job.config.cmdArgs, mode, job.config.env,
+                           job.config.workDir)) {
+            error = "cannot resolve '" + job.config.cmdArgs[0] + "'";
+            return false;
+        }
+        job.config.image = image;
+        return true;
+    }
+
+    void handleClient(std::shared_ptr<Connection> client) {
+        std::string pending{};
+        char buffer[4096];
+
+        while (true) {
+            ssize_t n{recv(client->fd, buffer, sizeof(buffer), 0)};
+            if (n <= 0) {
+                break;
+            }
+            pending.append(buffer, static_cast<size_t>(n));
+
+            for (size_t nl{pending.find('\n')}; nl != std::string::npos;
+                 nl = pending.find('\n')) {
+                std::string line{pending.substr(0, nl)};
+                pending.erase(0, nl + 1);
+                if (!line.empty()) {
+                    handleRequest(line, client);
+                }
+            }
+        }
+    }
+
+    void handleRequest(const std::string& line, const std::shared_ptr<Connection>& client) {
+        Json::Value request{};
+        if (!Json::parse(line, request) || request.type != Json::Value::Type::Object) {
+            client->send(errorEvent("malformed request, expected one JSON object per line"));
+            return;
+        }
+
+        if (request.getString("op", "run") == "status") {
+            std::lock_guard<std::mutex> lock{queueMutex};
+            client->send("{\"event\": \"status\", \"queued\": " + std::to_string(queue.size()) +
+                         ", \"running\": " + std::to_string(running) +
+                         ", \"workers\": " + std::to_string(cpus.size()) + ", " +
+                         calibrationJson() + "}");
+            return;
+        }
+
+        Job job{};
+        std::string error{};
+        if (!makeJob(request, job, error)) {
+            client->send(errorEvent(error));
+            return;
+        }
+        job.client = client;
+
+        size_t position{};
+        {
+            std::lock_guard<std::mutex> lock{queueMutex};
+            job.id = nextId++;
+            position = queue.size() + running;
+        }
+        client->send(event("queued", job.id, "\"ahead\": " + std::to_string(position)));
+
+        {
+            std::lock_guard<std::mutex> lock{queueMutex};
+            queue.push_back(std::move(job));
+        }
+        queueReady.notify_one();
+    }
+
+    void worker(int cpu) {
+        while (true) {
+            Job job{};
+            {
+                std::unique_lock<std::mutex> lock{queueMutex};
+                queueReady.wait(lock, [this]() { return !queue.empty(); });
+                job = std::move(queue.front());
+                queue.pop_front();
+                ++running;
+            }
+
+            job.config.cpu = cpu;
+            job.client->send(event("started", job.id, "\"cpu\": " + std::to_string(cpu)));
+
+            BenchmarkResults results{runBenchmark(job.config)};
+            if (results.reservationFailed) {
+                job.client->send(errorEvent("job " + std::to_string(job.id) +
+                                            ": CPUs are reserved by another vajra process"));
+            } else {
+                job.client->send(event("result", job.id,
+                                       calibrationJson() + ", \"results\": " +
+                                           Json::compact(results.toJson())));
+            }
+
+            std::lock_guard<std::mutex> lock{queueMutex};
+            --running;
+        }
+    }
+
+  public:
+    Server(const BenchmarkConfig& baseConfig, const std::vector<int>& workerCpus)
+        : base{baseConfig}, cpus{workerCpus} {
+        if (cpus.empty()) {
+            cpus.push_back(-1);
+        }
+    }
+
+    /**
+     * @brief Measure spawn overhead once so every job doesn't have to.
+     */
+    void calibrate() {
+        BenchmarkConfig probe{base};
+        probe.quiet = true;
+        probe.command = "true";
+        probe.cmdArgs = {"true"};
+        probe.prepare.clear();
+        probe.warmup = 20;
+        probe.iterations = 200;
+        probe.cpu = cpus[0];
+
+        auto image{std::make_shared<Exec::Image>()};
+        if (!Exec::prepare(*image, probe.cmdArgs, Exec::Mode::Resolved)) {
+            return;
+        }
+        probe.image = image;
+
+        BenchmarkResults r{runBenchmark(probe)};
+        calibration.spawnMean = r.mean;
+        calibration.spawnStdDev = r.stdDev;
+        calibration.runDelayMean = r.runDelayMean;
+    }
+
+    const Calibration& getCalibration() const {
+        return calibration;
+    }
+
+    size_t getWorkerCount() const {
+        return cpus.size();
+    }
+
+    void serve(int listenFd) {
+        for (int cpu : cpus) {
+            std::thread{&Server::worker, this, cpu}.detach();
+        }
+
+        while (true) {
+            int fd{accept(listenFd, nullptr, nullptr)};
+            if (fd == -1) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                return;
+            }
+            std::thread{&Server::handleClient, this, std::make_shared<Connection>(fd)}.detach();
+        }
+    }
+};
+
+inline char socketPathForSignal[sizeof(sockaddr_un::sun_path)]{};
+
+inline void removeSocketAndExit(int) {
+    unlink(socketPathForSignal);
+    _exit(0);
+}
+
+inline bool makeAddress(const std::string& path, sockaddr_un& addr) {
+    addr = {};
+    addr.sun_family = AF_UNIX;
+    if (path.size() >= sizeof(addr.sun_path)) {
+        printError("Socket path is too long: '" + path + "'");
+        return false;
+    }
+    std::memcpy(addr.sun_path, path.c_str(), path.size() + 1);
+    return true;
+}
+
+/**
+ * @brief Run the daemon in the foreground until interrupted.
+ */
+inline int run(const std::string& path, const BenchmarkConfig& base, const std::vector<int>& cpus) {
+    sockaddr_un addr{};
+    if (!makeAddress(path, addr)) {
+        return 1;
+    }
+
+    struct stat st{};
+    if (lstat(path.c_str(), &st) == 0) {
+        // Only ever remove a stale socket: something else at this path is not ours to delete
+        if (!S_ISSOCK(st.st_mode)) {
+            printError("'" + path + "' exists and is not a socket");
+            return 1;
+        }
+        int probeFd{socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+        if (probeFd == -1) {
+            printError(std::string{"Cannot create socket: "} + std::strerror(errno));
+            return 1;
+        }
+        const bool live{connect(probeFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) == 0};
+        const int probeError{errno};
+        close(probeFd);
+        if (live) {
+            printError("A vajra daemon is already listening on '" + path + "'");
+            return 1;
+        }
+        if (probeError != ECONNREFUSED) {
+            printError("Cannot probe '" + path + "': " + std::strerror(probeError));
+            return 1;
+        }
+        unlink(path.c_str());
+    }
+
+    int listenFd{socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+    if (listenFd == -1 || bind(listenFd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0 ||
+        listen(listenFd, 64) != 0) {
+        printError("Cannot listen on '" + path + "': " + std::strerror(errno));
+        return 1;
+    }
+    chmod(path.c_str(), 0600);
+
+    std::memcpy(socketPathForSignal, addr.sun_path, sizeof(socketPathForSignal));
+    std::signal(SIGINT, removeSocketAndExit);
+    std::signal(SIGTERM, removeSocketAndExit);
+    std::signal(SIGPIPE, SIG_IGN);
+
+    Server server{base, cpus};
+
+    std::cout << Colors::BrightCyan << "Calibrating..." << Colors::Reset << "\n" << std::flush;
+    server.calibrate();
+    const Calibration& cal{server.getCalibration()};
+
+    std::cout << Colors::BrightGreen << "vajra daemon listening on " << Colors::BrightYellow
+              << path << Colors::Reset << "\n";
+    std::cout << Colors::Dim << "  spawn overhead " << std::fixed << std::setprecision(3)
+              << cal.spawnMean << " ± " << cal.spawnStdDev << " ms, run-queue wait "
+              << cal.runDelayMean << " ms, " << server.getWorkerCount() << " worker(s)";
+    if (base.priority.any() || base.priority.lockMemory) {
+        std::cout << ", " << Priority::describe(base.priority);
+    }
+    std::cout << Colors::Reset << "\n" << std::flush;
+
+    server.serve(listenFd);
+    unlink(path.c_str());
+    return 0;
+}
+
+/**
+ * @brief Send one request to a running daemon and stream its events back.
+ * @param onEvent Called for every event line; return false to stop reading.
+ */
+template <typename Func>
+inline bool submit(const std::string& path, const std::string& request, Func onEvent) {
+    sockaddr_un addr{};
+    if (!makeAddress(path, addr)) {
+        return false;
+    }
+
+    int fd{socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0)};
+    if (fd == -1 || connect(fd, reinterpret_cast<sockaddr*>(&addr), sizeof(addr)) != 0) {
+        printError("Cannot connect to vajra daemon at '" + path + "': " + std::strerror(errno));
+        std::cerr << Colors::Dim << "Start one with: vajra daemon" << Colors::Reset << "\n";
+        if (fd != -1) {
+            close(fd);
+        }
+        return false;
+    }
+
+    std::string line{request + "\n"};
+    ::send(fd, line.data(), line.size(), MSG_NOSIGNAL);
+    shutdown(fd, SHUT_WR);
+
+    std::string pending{};
+    char buffer[4096];
+    bool keepReading{true};
+
+    while (keepReading) {
+        ssize_t n{recv(fd, buffer, sizeof(buffer), 0)};
+        if (n <= 0) {
+            break;
+        }
+        pending.append(buffer, static_cast<size_t>(n));
+
+        for (size_t nl{pending.find('\n')}; keepReading && nl != std::string::npos;
+             nl = pending.find('\n')) {
+            Json::Value event{};
+            if (Json::parse(pending.substr(0, nl), event)) {
+                keepReading = onEvent(event);
+            }
+            pending.erase(0, nl + 1);
+        }
+    }
+
+    close(fd);
+    return true;
+}
+
+#endif
+
+} // namespace Daemon
+
+#endif
@@ -0,0 +1,271 @@
+#ifndef EXEC_H
+#define EXEC_H
+
+#include "argparser.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
+namespace Exec {
+
+/**
+ * @brief How the benchmarked binary is located and loaded on every run.
+ */
+enum class Mode {
+    Path,     // execvp: PATH search on every run
+    Resolved, // execve on a path resolved once up front
+    Memfd,    // fexecve on a sealed in-memory copy of the binary
+};
+
+inline const char* modeName(Mode mode) {
+    switch (mode) {
+    case Mode::Path:
+        return "path";
+    case Mode::Memfd:
+        return "memfd";
+    default:
+        return "resolved";
+    }
+}
+
+inline bool parseMode(const std::string& name, Mode& mode) {
+    if (name == "path") {
+        mode = Mode::Path;
+    } else if (name == "resolved") {
+        mode = Mode::Resolved;
+    } else if (name == "memfd") {
+        mode = Mode::Memfd;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Everything the child needs to exec, built once so each run is a single system call.
+ */
+struct Image {
+    Mode mode{Mode::Resolved};
+    std::string path{};
+    int fd{-1};
+    bool script{false};
+    std::vector<std::string> args{};
+    std::vector<std::string> env{};
+    std::vector<char*> argv{};
+    std::vector<char*> envp{};
+
+    Image() = default;
+    Image(const Image&) = delete;
+    Image& operator=(const Image&) = delete;
+
+    ~Image() {
+#ifdef __linux__
+        if (fd != -1) {
+            close(fd);
+        }
+#endif
+    }
+};
+
+#ifdef __linux__
+
+inline bool isExecutable(const std::string& path) {
+    struct stat st{};
+    return stat(path.c_str(), &st) == 0 && S_ISREG(st.st_mode) && access(path.c_str(), X_OK) == 0;
+}
+
+/**
+ * @brief Locate a command the way execvp would, returning an empty string if it isn't found.
+ * @param pathEnv The PATH to search, or null for the built-in default.
+ * @param workDir Directory relative names and PATH entries are taken from; empty for the current
+ * one.
+ */
+inline std::string resolve(const std::string& name, const char* pathEnv,
+                           const std::string& workDir = {}) {
+    auto within{[&workDir](const std::string& path) {
+        return workDir.empty() || path.starts_with('/') ? path : workDir + "/" + path;
+    }};
+
+    if (name.find('/') != std::string::npos) {
+        return isExecutable(within(name)) ? within(name) : std::string{};
+    }
+
+    std::string searchPath{pathEnv ? pathEnv : "/usr/local/bin:/usr/bin:/bin"};
+    size_t pos{0};
+
+    while (pos <= searchPath.size()) {
+        size_t colon{searchPath.find(':', pos)};
+        std::string dir{searchPath.substr(pos, colon == std::string::npos ? std::string::npos
+                                                                          : colon - pos)};
+        std::string candidate{within(dir.empty() ? std::string{"."} : dir) + "/" + name};
+
+        if (isExecutable(candidate)) {
+            return candidate;
+        }
+
+        if (colon == std::string::npos) {
+            break;
+        }
+        pos = colon + 1;
+    }
+
+    return {};
+}
+
+/**
+ * @brief Copy the binary into a sealed memfd. Sets @p script when it starts with a #! line.
+ * @return The memfd, or -1 with errno set.
+ */
+inline int loadMemfd(const std::string& path, bool& script) {
+    int src{open(path.c_str(), O_RDONLY | O_CLOEXEC)};
+    if (src == -1) {
+        return -1;
+    }
+
+    // Close-on-exec so other children don't inherit it; exec() hands the child its own copy
+    int fd{memfd_create("vajra-exec", MFD_ALLOW_SEALING | MFD_CLOEXEC)};
+    if (fd == -1) {
+        int err{errno};
+        close(src);
+        errno = err;
+        return -1;
+    }
+
+    char buffer[1 << 16];
+    ssize_t n{};
+    script = false;
+    for (bool first{true}; (n = read(src, buffer, sizeof(buffer))) > 0; first = false) {
+        if (first) {
+            script = n >= 2 && buffer[0] == '#' && buffer[1] == '!';
+        }
+        for (ssize_t written{0}; written < n;) {
+            ssize_t w{write(fd, buffer + written, static_cast<size_t>(n - written))};
+            if (w == -1) {
+                int err{errno};
+                close(src);
+                close(fd);
+                errno = err;
+                return -1;
+            }
+            written += w;
+        }
+    }
+
+    int err{errno};
+    close(src);
+    if (n == -1) {
+        close(fd);
+        errno = err;
+        return -1;
+    }
+
+    fchmod(fd, 0755);
+    fcntl(fd, F_ADD_SEALS, F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE | F_SEAL_SEAL);
+    return fd;
+}
+
+#endif
+
+/**
+ * @brief Resolve and optionally load the binary, and build argv/envp.
+ * @param env Environment for the command, or empty to pass on vajra's own.
+ * @param workDir Directory the command will run in, or empty for vajra's own.
+ */
+inline bool prepare(Image& image, const std::vector<std::string>& args, Mode mode,
+                    const std::vector<std::string>& env = {}, const std::string& workDir = {}) {
+    image.mode = mode;
+    image.args = args;
+
+#ifdef __linux__
+    image.env = env;
+    if (env.empty()) {
+        for (char** e{environ}; e && *e; ++e) {
+            image.env.emplace_back(*e);
+        }
+    }
+
+    if (mode != Mode::Path) {
+        const char* pathEnv{nullptr};
+        for (const auto& var : image.env) {
+            if (var.starts_with("PATH=")) {
+                pathEnv = var.c_str() + 5;
+            }
+        }
+        image.path = resolve(args[0], pathEnv, workDir);
+        if (image.path.empty()) {
+            std::cerr << Colors::BrightRed << "Error: " << Colors::Reset << "Command not found: '"
+                      << args[0] << "'\n";
+            std::cerr << Colors::Dim << "Check the spelling or use --shell for shell builtins."
+                      << Colors::Reset << "\n";
+            return false;
+        }
+    }
+
+    if (mode == Mode::Memfd) {
+        image.fd = loadMemfd(image.path, image.script);
+        if (image.fd == -1) {
+            std::cerr << Colors::BrightRed << "Error: " << Colors::Reset << "Cannot load '"
+                      << image.path << "' into memory: " << std::strerror(errno) << "\n";
+            return false;
+        }
+    }
+#endif
+
+    for (auto& arg : image.args) {
+        image.argv.push_back(arg.data());
+    }
+    image.argv.push_back(nullptr);
+
+    for (auto& var : image.env) {
+        image.envp.push_back(var.data());
+    }
+    image.envp.push_back(nullptr);
+
+    return true;
+}
+
+#ifdef __linux__
+
+/**
+ * @brief Replace the calling process with the prepared image. Only returns on failure.
+ */
+inline void exec(const Image& image) {
+    switch (image.mode) {
+    case Mode::Path:
+        // execvp searches the PATH of, and passes on, environ
+        environ = const_cast<char**>(image.envp.data());
+        execvp(image.argv[0], image.argv.data());
+        break;
+    case Mode::Resolved:
+        execve(image.path.c_str(), image.argv.data(), image.envp.data());
+        break;
+    case Mode::Memfd: {
+        // The memfd is close-on-exec, which is fine for ELF binaries. A script is re-opened by its
+        // interpreter through /dev/fd/N, so it gets a duplicate that survives the exec
+        const int fd{image.script ? dup(image.fd) : image.fd};
+        if (fd != -1) {
+            fexecve(fd, image.argv.data(), image.envp.data());
+        }
+        break;
+    }
+    }
+}
+
+#endif
+
+} // namespace Exec
+
+#endif
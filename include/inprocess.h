@@ -0,0 +1,160 @@
+#ifndef INPROCESS_H
+#define INPROCESS_H
+
+#include "argparser.h"
+#include "journal.h"
+#include "runner.h"
+#include "vajra.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <dlfcn.h>
+#endif
+
+namespace InProcess {
+
+/**
+ * @brief The one signature --dlopen calls: the same shape as a libFuzzer entry point, so existing
+ * fuzz targets can be benchmarked as they are. The return value is ignored.
+ */
+using Function = int (*)(const uint8_t* data, size_t size);
+
+/**
+ * @brief A loaded library function plus the input it is called with.
+ */
+class Target {
+  private:
+    void* handle{nullptr};
+
+  public:
+    Function function{nullptr};
+    std::vector<uint8_t> input{};
+    std::string label{};
+
+    Target() = default;
+    Target(const Target&) = delete;
+    Target& operator=(const Target&) = delete;
+
+    ~Target() {
+#ifdef __linux__
+        if (handle) {
+            dlclose(handle);
+        }
+#endif
+    }
+
+    /**
+     * @brief Load 'library.so:symbol' and read argFile (if any) into memory.
+     */
+    bool load(const std::string& spec, const std::string& argFile) {
+        const size_t colon{spec.rfind(':')};
+        if (colon == std::string::npos || colon == 0 || colon + 1 == spec.size()) {
+            std::cerr << Colors::BrightRed << "Error: " << Colors::Reset
+                      << "--dlopen expects 'library.so:symbol' (got '" << spec << "')\n";
+            return false;
+        }
+        const std::string path{spec.substr(0, colon)};
+        const std::string symbol{spec.substr(colon + 1)};
+
+#ifdef __linux__
+        const std::string openPath{path.find('/') == std::string::npos ? "./" + path : path};
+        handle = dlopen(openPath.c_str(), RTLD_NOW | RTLD_LOCAL);
+        if (!handle) {
+            std::cerr << Colors::BrightRed << "Error: " << Colors::Reset << "Cannot load library: "
+                      << dlerror() << "\n";
+            return false;
+        }
+
+        function = reinterpret_cast<Function>(dlsym(handle, symbol.c_str()));
+        if (!function) {
+            std::cerr << Colors::BrightRed << "Error: " << Colors::Reset << "Symbol '" << symbol
+                      << "' not found in '" << path << "'\n";
+            std::cerr << Colors::Dim << "It must be declared extern \"C\" "
+                      << "int " << symbol << "(const uint8_t* data, size_t size)" << Colors::Reset
+                      << "\n";
+            return false;
+        }
+#else
+        std::cerr << Colors::BrightRed << "Error: " << Colors::Reset
+                  << "--dlopen is only supported on Linux\n";
+        return false;
+#endif
+
+        if (!argFile.empty()) {
+            std::ifstream file{argFile, std::ios::binary};
+            if (!file) {
+                std::cerr << Colors::BrightRed << "Error: " << Colors::Reset << "Cannot read '"
+                          << argFile << "'\n";
+                return false;
+            }
+            input.assign(std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{});
+        }
+
+        label = symbol + "() in " + path;
+        if (!argFile.empty()) {
+            label += " < " + argFile;
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief Benchmark the target in this process: warmup and iterations count batches, each batch
+ * calling the function enough times to dwarf the timer's own cost.
+ * @param batch Calls per batch, or 0 to calibrate.
+ */
+inline BenchmarkResults run(const Target& target, const BenchmarkConfig& config, size_t batch) {
+    const uint8_t* data{target.input.empty() ? nullptr : target.input.data()};
+    const size_t size{target.input.size()};
+    volatile int sink{0};
+    auto call{[&]() { sink = sink + target.function(data, size); }};
+
+    if (batch == 0) {
+        batch = Benchmark::calibrateBatch(call);
+    }
+
+    if (!config.quiet) {
+        std::cout << Colors::BrightCyan << "Running benchmark: " << Colors::BrightYellow
+                  << target.label << Colors::Reset << "\n";
+        std::cout << Colors::White << "Warmup: " << config.warmup
+                  << " | Iterations: " << config.iterations << " | " << batch
+                  << " calls per iteration | in-process" << Colors::Reset << "\n"
+                  << std::flush;
+    }
+
+    auto many{[&call, batch]() {
+        for (size_t i{0}; i < batch; ++i) {
+            call();
+        }
+    }};
+    Benchmark bench{target.label, static_cast<size_t>(config.iterations),
+                    static_cast<size_t>(config.warmup)};
+    // Whole batches are kept as exact integers; the per-call division happens at display time
+    const std::vector<uint64_t> batchNs{bench.runNs(many)};
+
+    std::vector<Journal::Sample> samples{};
+    samples.reserve(batchNs.size());
+    for (uint64_t ns : batchNs) {
+        samples.push_back({ns, {}, {}, {}});
+    }
+
+    BenchmarkResults results{};
+    results.command = target.label;
+    results.callsPerIteration = static_cast<long long>(batch);
+    summarize(samples, results);
+    results.execMode = "in-process";
+    results.bytesPerRun = config.workBytes;
+    results.itemsPerRun = config.workItems;
+    return results;
+}
+
+} // namespace InProcess
+
+#endif
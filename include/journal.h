@@ -0,0 +1,294 @@
+#ifndef JOURNAL_H
+#define JOURNAL_H
+
+#include "argparser.h"
+#include "procstat.h"
+
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace Journal {
+
+/**
+ * @brief One timed run: wall time plus whatever /proc accounting was available.
+ */
+struct Sample {
+    uint64_t wallNs{};
+    ProcStat::SchedStats sched{};
+    ProcStat::IoStats io{};
+    std::vector<std::pair<std::string, double>> metrics{};
+    ProcStat::Usage usage{};
+    int64_t outputBytes{-1};
+    uint64_t startNs{0}; // wall-clock start, nanoseconds since the Unix epoch; 0 if unknown
+};
+
+/**
+ * @brief Benchmark parameters recorded at the top of a journal, so --resume can continue without
+ * repeating them on the command line.
+ */
+struct Header {
+    std::string command{};
+    bool useShell{false};
+    int warmup{};
+    int iterations{};
+};
+
+constexpr const char* Magic{"vajra-journal 1"};
+
+inline std::string formatSample(const Sample& s) {
+    std::ostringstream line{};
+    // Wall time in integer nanoseconds
+    line << "n " << s.wallNs << " " << s.sched.valid << " " << s.sched.cpuTimeNs << " "
+         << s.sched.runDelayNs << " " << s.sched.nrSwitches << " " << s.sched.nrMigrations << " "
+         << s.io.valid << " " << s.io.rchar << " " << s.io.wchar << " " << s.io.syscr << " "
+         << s.io.syscw << " " << s.io.readBytes << " " << s.io.writeBytes;
+    // Then wait4() usage and output size as @name=value, which no collector metric can start with
+    if (s.usage.valid) {
+        line << " @user_ns=" << s.usage.userNs << " @sys_ns=" << s.usage.systemNs
+             << " @maxrss=" << s.usage.maxRssBytes;
+    }
+    if (s.outputBytes >= 0) {
+        line << " @output=" << s.outputBytes;
+    }
+    if (s.startNs > 0) {
+        line << " @t=" << s.startNs;
+    }
+    // Collector metrics follow as name=value; names must not contain whitespace
+    line.precision(17);
+    for (const auto& [name, value] : s.metrics) {
+        line << " " << name << "=" << value;
+    }
+    line << "\n";
+    return line.str();
+}
+
+inline bool parseSample(const std::string& line, Sample& s) {
+    std::istringstream in{line};
+    std::string tag{};
+    in >> tag;
+    if (tag != "n") {
+        return false;
+    }
+    in >> s.wallNs;
+    in >> s.sched.valid >> s.sched.cpuTimeNs >> s.sched.runDelayNs >> s.sched.nrSwitches >>
+        s.sched.nrMigrations >> s.io.valid >> s.io.rchar >> s.io.wchar >> s.io.syscr >>
+        s.io.syscw >> s.io.readBytes >> s.io.writeBytes;
+    if (!in) {
+        return false;
+    }
+
+    for (std::string pair{}; in >> pair;) {
+        const size_t eq{pair.rfind('=')};
+        const char* start{eq == std::string::npos ? nullptr : pair.c_str() + eq + 1};
+        char* end{nullptr};
+        const double value{start ? std::strtod(start, &end) : 0.0};
+        if (!start || end == start) {
+            return false;
+        }
+
+        const std::string name{pair.substr(0, eq)};
+        if (name == "@t") {
+            // Parsed as an integer: epoch nanoseconds do not fit a double exactly
+            s.startNs = std::strtoull(start, nullptr, 10);
+        } else if (name == "@user_ns") {
+            s.usage.valid = true;
+            s.usage.userNs = static_cast<uint64_t>(value);
+        } else if (name == "@sys_ns") {
+            s.usage.systemNs = static_cast<uint64_t>(value);
+        } else if (name == "@maxrss") {
+            s.usage.maxRssBytes = static_cast<uint64_t>(value);
+        } else if (name == "@output") {
+            s.outputBytes = static_cast<int64_t>(value);
+        } else {
+            s.metrics.emplace_back(name, value);
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Parse a non-negative count from a header line.
+ */
+inline bool parseCount(const std::string& text, int& out) {
+    char* end{nullptr};
+    errno = 0;
+    const long value{std::strtol(text.c_str(), &end, 10)};
+    if (end == text.c_str() || *end != '\0' || errno == ERANGE || value < 0 ||
+        value > std::numeric_limits<int>::max()) {
+        return false;
+    }
+    out = static_cast<int>(value);
+    return true;
+}
+
+/**
+ * @brief Read a journal. A torn final line (e.g. after a power cut) has no newline yet and is
+ * silently dropped.
+ */
+inline bool load(const std::string& path, Header& header, std::vector<Sample>& samples) {
+    std::ifstream file{path};
+    std::string line{};
+
+    if (!file || !std::getline(file, line) || line != Magic) {
+        std::cerr << Colors::BrightRed << "Error: " << Colors::Reset << "'" << path
+                  << "' is not a vajra journal\n";
+        return false;
+    }
+
+    while (std::getline(file, line)) {
+        if (file.eof()) {
+            break; // no newline after it, so the write was cut short
+        }
+        if (line.rfind("n ", 0) == 0) {
+            Sample s{};
+            if (parseSample(line, s)) {
+                samples.push_back(s);
+            }
+        } else if (line.rfind("command ", 0) == 0) {
+            header.command = line.substr(8);
+        } else if (line.rfind("shell ", 0) == 0) {
+            header.useShell = line.substr(6) == "1";
+        } else if ((line.rfind("warmup ", 0) == 0 && !parseCount(line.substr(7), header.warmup)) ||
+                   (line.rfind("iterations ", 0) == 0 &&
+                    !parseCount(line.substr(11), header.iterations))) {
+            std::cerr << Colors::BrightRed << "Error: " << Colors::Reset << "Corrupt journal '"
+                      << path << "': bad header line '" << line << "'\n";
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Append-only sample journal. Samples are written immediately but only fsync'd every
+ * SyncEvery samples or SyncInterval, so durability costs little per run.
+ */
+class Writer {
+  private:
+    std::FILE* file{nullptr};
+    int unsynced{0};
+    std::chrono::steady_clock::time_point lastSync{std::chrono::steady_clock::now()};
+
+    static constexpr int SyncEvery{64};
+    static constexpr std::chrono::seconds SyncInterval{1};
+
+    /**
+     * @brief Cut an unterminated final line off, so the next sample doesn't get glued to it.
+     */
+    static void dropTornLine(const std::string& path) {
+        std::ifstream in{path, std::ios::binary};
+        const std::string content{std::istreambuf_iterator<char>{in}, {}};
+        if (content.empty() || content.back() == '\n') {
+            return;
+        }
+        const size_t keep{content.rfind('\n') + 1}; // npos + 1 == 0 drops everything
+        std::error_code ec{};
+        std::filesystem::resize_file(path, keep, ec);
+    }
+
+  public:
+    Writer() = default;
+    Writer(const Writer&) = delete;
+    Writer& operator=(const Writer&) = delete;
+
+    ~Writer() {
+        close();
+    }
+
+    /**
+     * @brief Open for appending, writing the header if the journal is new.
+     */
+    bool open(const std::string& path, const Header& header, bool resuming) {
+        bool exists{false};
+        {
+            std::ifstream probe{path};
+            exists = probe && probe.peek() != std::ifstream::traits_type::eof();
+        }
+
+        if (exists && resuming) {
+            dropTornLine(path);
+        }
+        if (exists && !resuming) {
+            std::cerr << Colors::BrightRed << "Error: " << Colors::Reset << "Journal '" << path
+                      << "' already exists\n";
+            std::cerr << Colors::Dim << "Use --resume " << path
+                      << " to continue it, or pick a new file." << Colors::Reset << "\n";
+            return false;
+        }
+
+        file = std::fopen(path.c_str(), "ab");
+        if (!file) {
+            std::cerr << Colors::BrightRed << "Error: " << Colors::Reset << "Cannot open journal '"
+                      << path << "'\n";
+            return false;
+        }
+
+        if (!exists) {
+            std::fprintf(file, "%s\ncommand %s\nshell %d\nwarmup %d\niterations %d\n", Magic,
+                         header.command.c_str(), header.useShell ? 1 : 0, header.warmup,
+                         header.iterations);
+            sync();
+        }
+        return true;
+    }
+
+    void append(const Sample& sample) {
+        if (!file) {
+            return;
+        }
+
+        const std::string line{formatSample(sample)};
+        std::fwrite(line.data(), 1, line.size(), file);
+
+        auto now{std::chrono::steady_clock::now()};
+        if (++unsynced >= SyncEvery || now - lastSync >= SyncInterval) {
+            sync();
+        }
+    }
+
+    void sync() {
+        if (!file) {
+            return;
+        }
+
+        std::fflush(file);
+#ifdef _WIN32
+        _commit(_fileno(file));
+#else
+        fsync(fileno(file));
+#endif
+        unsynced = 0;
+        lastSync = std::chrono::steady_clock::now();
+    }
+
+    void close() {
+        if (file) {
+            sync();
+            std::fclose(file);
+            file = nullptr;
+        }
+    }
+};
+
+} // namespace Journal
+
+#endif
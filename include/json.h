@@ -0,0 +1,343 @@
+#ifndef JSON_H
+#define JSON_H
+
+#include "argparser.h"
+
+#include <cctype>
+#include <cstdlib>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace Json {
+
+/**
+ * @brief A parsed JSON value. Objects keep their keys in document order.
+ */
+struct Value {
+    enum class Type { Null, Bool, Number, String, Array, Object };
+
+    Type type{Type::Null};
+    bool boolean{false};
+    double number{0.0};
+    std::string string{};
+    std::vector<Value> array{};
+    std::vector<std::pair<std::string, Value>> object{};
+
+    const Value* find(const std::string& key) const {
+        for (const auto& [k, v] : object) {
+            if (k == key) {
+                return &v;
+            }
+        }
+        return nullptr;
+    }
+
+    double getNumber(const std::string& key, double fallback = 0.0) const {
+        const Value* v{find(key)};
+        return (v && v->type == Type::Number) ? v->number : fallback;
+    }
+
+    std::string getString(const std::string& key, const std::string& fallback = "") const {
+        const Value* v{find(key)};
+        return (v && v->type == Type::String) ? v->string : fallback;
+    }
+
+    bool getBool(const std::string& key, bool fallback = false) const {
+        const Value* v{find(key)};
+        return (v && v->type == Type::Bool) ? v->boolean : fallback;
+    }
+};
+
+class Parser {
+  private:
+    const std::string& text;
+    size_t pos{0};
+
+    void skipSpaces() {
+        while (pos < text.size() && std::isspace(static_cast<unsigned char>(text[pos]))) {
+            ++pos;
+        }
+    }
+
+    bool parseString(std::string& out) {
+        if (text[pos] != '"') {
+            return false;
+        }
+        ++pos;
+
+        while (pos < text.size() && text[pos] != '"') {
+            char c{text[pos++]};
+            if (c != '\\') {
+                out += c;
+                continue;
+            }
+            if (pos >= text.size()) {
+                return false;
+            }
+            char esc{text[pos++]};
+            switch (esc) {
+            case 'n':
+                out += '\n';
+                break;
+            case 't':
+                out += '\t';
+                break;
+            case 'r':
+                out += '\r';
+                break;
+            case 'u':
+                // Only the ASCII range is needed for our own output
+                if (pos + 4 > text.size()) {
+                    return false;
+                }
+                out += static_cast<char>(std::strtol(text.substr(pos, 4).c_str(), nullptr, 16));
+                pos += 4;
+                break;
+            default:
+                out += esc;
+            }
+        }
+
+        if (pos >= text.size()) {
+            return false;
+        }
+        ++pos;
+        return true;
+    }
+
+    bool parseValue(Value& value, int depth) {
+        skipSpaces();
+        if (pos >= text.size() || depth > 64) {
+            return false;
+        }
+
+        char c{text[pos]};
+        if (c == '{') {
+            ++pos;
+            value.type = Value::Type::Object;
+            skipSpaces();
+            if (pos < text.size() && text[pos] == '}') {
+                ++pos;
+                return true;
+            }
+            while (true) {
+                skipSpaces();
+                std::string key{};
+                if (pos >= text.size() || !parseString(key)) {
+                    return false;
+                }
+                skipSpaces();
+                if (pos >= text.size() || text[pos] != ':') {
+                    return false;
+                }
+                ++pos;
+                Value member{};
+                if (!parseValue(member, depth + 1)) {
+                    return false;
+                }
+                value.object.emplace_back(std::move(key), std::move(member));
+                skipSpaces();
+                if (pos < text.size() && text[pos] == ',') {
+                    ++pos;
+                } else if (pos < text.size() && text[pos] == '}') {
+                    ++pos;
+                    return true;
+                } else {
+                    return false;
+                }
+            }
+        }
+
+        if (c == '[') {
+            ++pos;
+            value.type = Value::Type::Array;
+            skipSpaces();
+            if (pos < text.size() && text[pos] == ']') {
+                ++pos;
+                return true;
+            }
+            while (true) {
+                Value item{};
+                if (!parseValue(item, depth + 1)) {
+                    return false;
+                }
+                value.array.push_back(std::move(item));
+                skipSpaces();
+                if (pos < text.size() && text[pos] == ',') {
+                    ++pos;
+                } else if (pos < text.size() && text[pos] == ']') {
+                    ++pos;
+                    return true;
+                } else {
+                    return false;
+                }
+            }
+        }
+
+        if (c == '"') {
+            value.type = Value::Type::String;
+            return parseString(value.string);
+        }
+
+        if (text.compare(pos, 4, "true") == 0 || text.compare(pos, 5, "false") == 0) {
+            value.type = Value::Type::Bool;
+            value.boolean = (c == 't');
+            pos += value.boolean ? 4 : 5;
+            return true;
+        }
+
+        if (text.compare(pos, 4, "null") == 0) {
+            pos += 4;
+            return true;
+        }
+
+        const char* start{text.c_str() + pos};
+        char* end;
+        value.number = std::strtod(start, &end);
+        if (end == start) {
+            return false;
+        }
+        value.type = Value::Type::Number;
+        pos += static_cast<size_t>(end - start);
+        return true;
+    }
+
+  public:
+    explicit Parser(const std::string& source) : text{source} {}
+
+    bool parse(Value& value) {
+        if (!parseValue(value, 0)) {
+            return false;
+        }
+        skipSpaces();
+        return pos == text.size();
+    }
+};
+
+inline bool parse(const std::string& text, Value& value) {
+    Parser parser{text};
+    return parser.parse(value);
+}
+
+/**
+ * @brief Collapse pretty-printed JSON onto one line, e.g. for JSON-lines protocols. Newlines
+ * inside strings are already escaped, so dropping raw ones is safe.
+ */
+inline std::string compact(const std::string& json) {
+    std::string out{};
+    out.reserve(json.size());
+    bool lineStart{false};
+
+    for (char c : json) {
+        if (c == '\n') {
+            lineStart = true;
+        } else if (lineStart && c == ' ') {
+            continue;
+        } else {
+            lineStart = false;
+            out += c;
+        }
+    }
+    return out;
+}
+
+/**
+ * @brief Rebuild BenchmarkResults from the object written by BenchmarkResults::toJson().
+ */
+inline BenchmarkResults toResults(const Value& v) {
+    BenchmarkResults r{};
+    r.name = v.getString("name");
+    r.command = v.getString("command");
+    // The timing fields are null when no timed run finished (iterations == 0); read them as 0
+    r.mean = v.getNumber("mean_ms");
+    r.stdDev = v.getNumber("std_dev_ms");
+    r.min = v.getNumber("min_ms");
+    r.max = v.getNumber("max_ms");
+    r.iterations = static_cast<int>(v.getNumber("iterations"));
+    r.numaNode = static_cast<int>(v.getNumber("numa_node", -1));
+    r.execMode = v.getString("exec_mode");
+    r.callsPerIteration = static_cast<long long>(v.getNumber("calls_per_iteration"));
+    r.plannedIterations = static_cast<int>(v.getNumber("planned_iterations"));
+    r.resumedIterations = static_cast<int>(v.getNumber("resumed_iterations"));
+    r.interrupted = v.getBool("interrupted");
+
+    if (const Value* cache{v.find("cache")}) {
+        r.cacheKey = cache->getString("key");
+        r.cachedAt = static_cast<long long>(cache->getNumber("measured_at"));
+    }
+
+    if (const Value* failures{v.find("failures")}) {
+        r.failedRuns = static_cast<int>(failures->getNumber("runs"));
+        r.failureExit = static_cast<int>(failures->getNumber("exit_code"));
+        r.failureSignal = static_cast<int>(failures->getNumber("signal"));
+    }
+
+    if (const Value* reservation{v.find("reservation")}) {
+        r.reservation = reservation->getString("policy");
+        r.reservedCpus = static_cast<int>(reservation->getNumber("cpus"));
+        r.contendedCpus = static_cast<int>(reservation->getNumber("contended_cpus"));
+    }
+
+    if (const Value* tags{v.find("tags")}) {
+        for (const auto& tag : tags->array) {
+            r.tags.push_back(tag.string);
+        }
+    }
+
+    if (v.find("run_delay_mean_ms")) {
+        r.hasSched = true;
+        r.runDelayMean = v.getNumber("run_delay_mean_ms");
+        r.runDelayStdDev = v.getNumber("run_delay_std_dev_ms");
+        r.runDelayMin = v.getNumber("run_delay_min_ms");
+        r.runDelayMax = v.getNumber("run_delay_max_ms");
+        r.switchesPerRun = v.getNumber("switches_per_run");
+        r.migrationsPerRun = v.getNumber("migrations_per_run");
+    }
+
+    if (const Value* io{v.find("io")}) {
+        r.hasIo = true;
+        r.readBytesPerRun = io->getNumber("read_bytes_per_run");
+        r.writeBytesPerRun = io->getNumber("write_bytes_per_run");
+        r.rcharPerRun = io->getNumber("rchar_per_run");
+        r.wcharPerRun = io->getNumber("wchar_per_run");
+        r.syscrPerRun = io->getNumber("syscr_per_run");
+        r.syscwPerRun = io->getNumber("syscw_per_run");
+    }
+
+    if (const Value* throughput{v.find("throughput")}) {
+        r.bytesPerRun = throughput->getNumber("bytes_per_run");
+        r.itemsPerRun = throughput->getNumber("items_per_run");
+    }
+
+    if (const Value* usage{v.find("usage")}) {
+        r.hasUsage = true;
+        r.cpuMean = usage->getNumber("cpu_ms_mean");
+        r.cpuStdDev = usage->getNumber("cpu_ms_std_dev");
+        r.userCpuMean = usage->getNumber("user_ms_mean");
+        r.systemCpuMean = usage->getNumber("system_ms_mean");
+        r.peakRssMean = usage->getNumber("peak_rss_bytes_mean");
+        r.peakRssMax = usage->getNumber("peak_rss_bytes_max");
+    }
+
+    if (const Value* output{v.find("output")}) {
+        r.hasOutput = true;
+        r.outputBytesMean = output->getNumber("bytes_mean");
+        r.outputBytesMin = output->getNumber("bytes_min");
+        r.outputBytesMax = output->getNumber("bytes_max");
+    }
+
+    if (const Value* metrics{v.find("metrics")}) {
+        for (const auto& [name, m] : metrics->object) {
+            r.metrics.push_back({name, m.getNumber("mean"), m.getNumber("std_dev"),
+                                 m.getNumber("min"), m.getNumber("max"),
+                                 static_cast<int>(m.getNumber("samples"))});
+        }
+    }
+
+    return r;
+}
+
+} // namespace Json
+
+#endif
@@ -0,0 +1,370 @@
+#ifndef LIVESTATS_H
+#define LIVESTATS_H
+
+#include "argparser.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <csignal>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <new>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <time.h>
+#include <unistd.h>
+#endif
+
+namespace LiveStats {
+
+enum class Phase : uint32_t { Starting, Warmup, Measuring, Done, Interrupted };
+
+inline const char* phaseName(Phase phase) {
+    switch (phase) {
+    case Phase::Warmup:
+        return "warmup";
+    case Phase::Measuring:
+        return "measuring";
+    case Phase::Done:
+        return "done";
+    case Phase::Interrupted:
+        return "interrupted";
+    default:
+        return "starting";
+    }
+}
+
+constexpr uint32_t Magic{0x564a4c53}; // "VJLS"
+constexpr uint32_t Version{1};
+
+/**
+ * @brief Relative-error quantile sketch: bucket i holds values in (Gamma^(i-1), Gamma^i] ns, so
+ * any quantile is accurate to ~1% with a fixed size that fits in the shared segment.
+ */
+constexpr double Gamma{1.02};
+constexpr int SketchBuckets{1536}; // up to ~4.4 hours per sample
+
+/**
+ * @brief Everything a reader sees. Plain data, copied in and out under the sequence counter.
+ */
+struct Snapshot {
+    uint32_t magic{};
+    uint32_t version{};
+    int32_t pid{};
+    Phase phase{Phase::Starting};
+    uint64_t count{};
+    uint64_t planned{};
+    uint64_t warmupDone{};
+    uint64_t warmupPlanned{};
+    double mean{};
+    double m2{};
+    double min{};
+    double max{};
+    uint64_t updatedNs{};
+    char command[256]{};
+    uint32_t sketch[SketchBuckets]{};
+
+    double stdDev() const {
+        return count > 1 ? std::sqrt(m2 / static_cast<double>(count)) : 0.0;
+    }
+
+    /**
+     * @brief Approximate quantile from the sketch, in milliseconds.
+     * @param q Quantile in [0, 1].
+     */
+    double quantile(double q) const {
+        if (count == 0) {
+            return 0.0;
+        }
+        const uint64_t rank{static_cast<uint64_t>(std::ceil(q * static_cast<double>(count)))};
+        uint64_t seen{0};
+        for (int i{0}; i < SketchBuckets; ++i) {
+            seen += sketch[i];
+            if (seen >= std::max<uint64_t>(rank, 1)) {
+                // Midpoint of the bucket, which bounds the relative error by (Gamma-1)/(Gamma+1)
+                return 2.0 * std::pow(Gamma, i) / (Gamma + 1.0) / 1e6;
+            }
+        }
+        return max;
+    }
+};
+
+/**
+ * @brief Shared layout: a seqlock counter in front of the snapshot. The writer makes the counter
+ * odd, copies, and makes it even again; readers retry until they see the same even value on both
+ * sides of their copy.
+ */
+struct Segment {
+    std::atomic<uint64_t> sequence{};
+    Snapshot data{};
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free,
+              "the seqlock counter must be lock-free to live in shared memory");
+
+constexpr const char* SegmentPrefix{"vajra-live."};
+
+inline std::string segmentName(int pid) {
+    return "/" + std::string{SegmentPrefix} + std::to_string(pid);
+}
+
+#ifdef __linux__
+
+inline uint64_t monotonicNs() {
+    timespec ts{};
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<uint64_t>(ts.tv_sec) * 1000000000ULL + static_cast<uint64_t>(ts.tv_nsec);
+}
+
+/**
+ * @brief Owner side of a live statistics segment; one per benchmarking process. The running
+ * summary uses Welford's update so nothing per-sample has to be kept.
+ */
+class Publisher {
+  private:
+    Segment* segment{nullptr};
+    Snapshot local{};
+    std::string name{};
+
+    void publish() {
+        local.updatedNs = monotonicNs();
+        segment->sequence.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(&segment->data, &local, sizeof(Snapshot));
+        std::atomic_thread_fence(std::memory_order_release);
+        segment->sequence.fetch_add(1, std::memory_order_relaxed);
+    }
+
+  public:
+    Publisher() = default;
+    Publisher(const Publisher&) = delete;
+    Publisher& operator=(const Publisher&) = delete;
+
+    ~Publisher() {
+        if (segment) {
+            munmap(segment, sizeof(Segment));
+            shm_unlink(name.c_str());
+        }
+    }
+
+    bool open(const std::string& command) {
+        name = segmentName(getpid());
+        int fd{shm_open(name.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644)};
+        if (fd == -1) {
+            return false;
+        }
+        if (ftruncate(fd, sizeof(Segment)) != 0) {
+            close(fd);
+            shm_unlink(name.c_str());
+            return false;
+        }
+
+        void* memory{mmap(nullptr, sizeof(Segment), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)};
+        close(fd);
+        if (memory == MAP_FAILED) {
+            shm_unlink(name.c_str());
+            return false;
+        }
+
+        segment = new (memory) Segment{};
+        local.magic = Magic;
+        local.version = Version;
+        local.pid = static_cast<int32_t>(getpid());
+        std::strncpy(local.command, command.c_str(), sizeof(local.command) - 1);
+        publish();
+        return true;
+    }
+
+    /**
+     * @brief Begin a new benchmark in this process (e.g. the next NUMA node), clearing the summary.
+     */
+    void start(uint64_t warmupPlanned, uint64_t planned) {
+        const Snapshot header{local};
+        local = Snapshot{};
+        local.magic = header.magic;
+        local.version = header.version;
+        local.pid = header.pid;
+        std::memcpy(local.command, header.command, sizeof(local.command));
+        local.warmupPlanned = warmupPlanned;
+        local.planned = planned;
+        local.phase = warmupPlanned > 0 ? Phase::Warmup : Phase::Measuring;
+        publish();
+    }
+
+    void warmupStep() {
+        ++local.warmupDone;
+        if (local.warmupDone >= local.warmupPlanned) {
+            local.phase = Phase::Measuring;
+        }
+        publish();
+    }
+
+    void add(uint64_t wallNs) {
+        // The published moments are in ms, for display; the sketch buckets the exact count
+        const double ms{static_cast<double>(wallNs) / 1e6};
+        ++local.count;
+        const double delta{ms - local.mean};
+        local.mean += delta / static_cast<double>(local.count);
+        local.m2 += delta * (ms - local.mean);
+        local.min = local.count == 1 ? ms : std::min(local.min, ms);
+        local.max = local.count == 1 ? ms : std::max(local.max, ms);
+
+        const double ns{static_cast<double>(std::max<uint64_t>(wallNs, 1))};
+        int bucket{static_cast<int>(std::ceil(std::log(ns) / std::log(Gamma)))};
+        ++local.sketch[std::clamp(bucket, 0, SketchBuckets - 1)];
+        publish();
+    }
+
+    void finish(bool interrupted) {
+        local.phase = interrupted ? Phase::Interrupted : Phase::Done;
+        publish();
+    }
+};
+
+/**
+ * @brief Take a consistent copy of another process's segment without blocking it.
+ */
+inline bool read(int pid, Snapshot& out) {
+    int fd{shm_open(segmentName(pid).c_str(), O_RDONLY, 0)};
+    if (fd == -1) {
+        return false;
+    }
+    void* memory{mmap(nullptr, sizeof(Segment), PROT_READ, MAP_SHARED, fd, 0)};
+    close(fd);
+    if (memory == MAP_FAILED) {
+        return false;
+    }
+
+    const auto* segment{static_cast<const Segment*>(memory)};
+    bool ok{false};
+    for (int attempt{0}; attempt < 1000 && !ok; ++attempt) {
+        const uint64_t before{segment->sequence.load(std::memory_order_acquire)};
+        if (before & 1) {
+            continue;
+        }
+        std::memcpy(&out, &segment->data, sizeof(Snapshot));
+        std::atomic_thread_fence(std::memory_order_acquire);
+        ok = segment->sequence.load(std::memory_order_relaxed) == before;
+    }
+    munmap(memory, sizeof(Segment));
+    return ok && out.magic == Magic && out.version == Version;
+}
+
+/**
+ * @brief Pids of running vajra processes with a live segment. Segments left behind by a crashed
+ * process are removed.
+ */
+inline std::vector<int> list() {
+    std::vector<int> pids{};
+    DIR* dir{opendir("/dev/shm")};
+    if (!dir) {
+        return pids;
+    }
+
+    const std::string prefix{SegmentPrefix};
+    while (dirent* entry{readdir(dir)}) {
+        const std::string file{entry->d_name};
+        if (file.rfind(prefix, 0) != 0) {
+            continue;
+        }
+        int pid{std::atoi(file.c_str() + prefix.size())};
+        if (pid <= 0) {
+            continue;
+        }
+        if (kill(pid, 0) == -1 && errno == ESRCH) {
+            shm_unlink(segmentName(pid).c_str());
+            continue;
+        }
+        pids.push_back(pid);
+    }
+    closedir(dir);
+
+    std::sort(pids.begin(), pids.end());
+    return pids;
+}
+
+/**
+ * @brief 'vajra top': a table of every running vajra process that publishes live statistics,
+ * refreshed twice a second (or printed once when stdout is not a terminal).
+ */
+inline int top(const volatile std::sig_atomic_t& stop) {
+    const bool refresh{isatty(STDOUT_FILENO) != 0};
+
+    do {
+        std::ostringstream screen{};
+        if (refresh) {
+            screen << "\033[H\033[2J";
+        }
+        screen << Colors::Bold << Colors::BrightWhite << std::left << std::setw(8) << "PID"
+               << std::setw(12) << "PHASE" << std::setw(14) << "RUNS" << std::right
+               << std::setw(11) << "μ ms" << std::setw(10) << "σ ms" << std::setw(10) << "p50 ms"
+               << std::setw(10) << "p99 ms" << "  COMMAND" << Colors::Reset << "\n";
+
+        const std::vector<int> pids{list()};
+        for (int pid : pids) {
+            static Snapshot snap{};
+            if (!read(pid, snap)) {
+                continue;
+            }
+            const std::string runs{snap.phase == Phase::Warmup
+                                       ? std::to_string(snap.warmupDone) + "/" +
+                                             std::to_string(snap.warmupPlanned)
+                                       : std::to_string(snap.count) + "/" +
+                                             std::to_string(snap.planned)};
+            const double age{static_cast<double>(monotonicNs() - snap.updatedNs) / 1e9};
+
+            screen << std::left << std::setw(8) << pid << std::setw(12) << phaseName(snap.phase)
+                   << std::setw(14) << runs << std::right << std::fixed << std::setprecision(3)
+                   << std::setw(10) << snap.mean << std::setw(9) << snap.stdDev()
+                   << std::setw(10) << snap.quantile(0.5) << std::setw(10)
+                   << snap.quantile(0.99) << "  " << snap.command;
+            if (age > 10.0) {
+                screen << Colors::Dim << "  (idle " << std::setprecision(0) << age << " s)"
+                       << Colors::Reset;
+            }
+            screen << "\n";
+        }
+        if (pids.empty()) {
+            screen << Colors::Dim << "No vajra process is publishing live statistics "
+                   << "(start one with --live)." << Colors::Reset << "\n";
+        }
+
+        std::cout << screen.str() << std::flush;
+        if (refresh) {
+            usleep(500000);
+        }
+    } while (refresh && !stop);
+
+    return 0;
+}
+
+#else
+
+class Publisher {
+  public:
+    bool open(const std::string&) {
+        return false;
+    }
+    void start(uint64_t, uint64_t) {}
+    void warmupStep() {}
+    void add(uint64_t) {}
+    void finish(bool) {}
+};
+
+#endif
+
+} // namespace LiveStats
+
+#endif
@@ -0,0 +1,310 @@
+#ifndef NUMA_H
+#define NUMA_H
+
+#include "argparser.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace Numa {
+
+// Values from linux/mempolicy.h; we talk to the kernel directly instead of linking libnuma
+constexpr int MpolDefault{0};
+constexpr int MpolBind{2};
+constexpr int MpolInterleave{3};
+
+constexpr size_t MaskWords{16};
+constexpr size_t MaskBits{MaskWords * 8 * sizeof(unsigned long)};
+
+/**
+ * @brief CPU and memory placement for the benchmarked command. Masks are built up front so that
+ * applying them between fork and exec is just two system calls.
+ */
+struct Placement {
+    int cpuNode{-1};
+    int memPolicy{MpolDefault};
+    std::vector<int> memNodes{};
+#ifdef __linux__
+    cpu_set_t cpus{};
+#endif
+    unsigned long nodeMask[MaskWords]{};
+
+    bool any() const {
+        return cpuNode >= 0 || memPolicy != MpolDefault;
+    }
+};
+
+/**
+ * @brief Parse a kernel list such as "0-3,8,10-11" (used by cpulist and node/online).
+ */
+inline std::vector<int> parseList(const std::string& text) {
+    std::vector<int> values{};
+    size_t pos{0};
+
+    while (pos < text.size()) {
+        size_t comma{text.find(',', pos)};
+        std::string part{text.substr(pos, comma == std::string::npos ? std::string::npos
+                                                                     : comma - pos)};
+        pos = (comma == std::string::npos) ? text.size() : comma + 1;
+
+        while (!part.empty() && (part.back() == '\n' || part.back() == ' ')) {
+            part.pop_back();
+        }
+        if (part.empty()) {
+            continue;
+        }
+
+        char* end;
+        long first{std::strtol(part.c_str(), &end, 10)};
+        if (end == part.c_str()) {
+            return {};
+        }
+
+        long last{first};
+        if (*end == '-') {
+            const char* rest{end + 1};
+            last = std::strtol(rest, &end, 10);
+            if (end == rest) {
+                return {};
+            }
+        }
+        if (*end != '\0') {
+            return {};
+        }
+
+        for (long v{first}; v <= last; ++v) {
+            values.push_back(static_cast<int>(v));
+        }
+    }
+
+    return values;
+}
+
+inline std::string readFirstLine(const std::string& path) {
+    std::ifstream file{path};
+    std::string line{};
+    std::getline(file, line);
+    return line;
+}
+
+/**
+ * @brief Online NUMA nodes, or just node 0 when the kernel exposes no topology.
+ */
+inline std::vector<int> onlineNodes() {
+    std::vector<int> nodes{parseList(readFirstLine("/sys/devices/system/node/online"))};
+    if (nodes.empty()) {
+        nodes.push_back(0);
+    }
+    return nodes;
+}
+
+inline std::vector<int> nodeCpus(int node) {
+    return parseList(
+        readFirstLine("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist"));
+}
+
+inline void printError(const std::string& message, const std::string& hint) {
+    std::cerr << Colors::BrightRed << "Error: " << Colors::Reset << message << "\n";
+    std::cerr << Colors::Dim << hint << Colors::Reset << "\n";
+}
+
+inline bool containsAll(const std::vector<int>& haystack, const std::vector<int>& needles) {
+    for (int n : needles) {
+        bool found{false};
+        for (int h : haystack) {
+            found = found || (h == n);
+        }
+        if (!found) {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Fill in the CPU and node masks for the given CPU node and memory node list.
+ */
+inline bool build(Placement& placement, const std::vector<int>& online) {
+    if (placement.cpuNode >= 0) {
+        std::vector<int> cpus{nodeCpus(placement.cpuNode)};
+        if (cpus.empty()) {
+            printError("NUMA node " + std::to_string(placement.cpuNode) + " has no CPUs",
+                       "Use a node listed in /sys/devices/system/node/online.");
+            return false;
+        }
+#ifdef __linux__
+        CPU_ZERO(&placement.cpus);
+        for (int cpu : cpus) {
+            if (cpu < CPU_SETSIZE) {
+                CPU_SET(cpu, &placement.cpus);
+            }
+        }
+#endif
+    }
+
+    if (placement.memPolicy != MpolDefault) {
+        if (!containsAll(online, placement.memNodes)) {
+            printError("Memory node list refers to an offline or unknown node",
+                       "Available nodes: " + readFirstLine("/sys/devices/system/node/online"));
+            return false;
+        }
+
+        for (auto& word : placement.nodeMask) {
+            word = 0;
+        }
+        for (int node : placement.memNodes) {
+            size_t bit{static_cast<size_t>(node)};
+            if (bit < MaskBits) {
+                placement.nodeMask[bit / (8 * sizeof(unsigned long))] |=
+                    1UL << (bit % (8 * sizeof(unsigned long)));
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * @brief Parse --numa-node, --membind and --interleave.
+ * @param perNode Set when --numa-node all asks for one benchmark per node.
+ */
+inline bool parsePlacement(const ArgParser& parser, Placement& placement, bool& perNode) {
+    perNode = false;
+    if (!parser.has("numa-node") && !parser.has("membind") && !parser.has("interleave")) {
+        return true;
+    }
+
+#ifdef __linux__
+    if (parser.has("membind") && parser.has("interleave")) {
+        printError("--membind and --interleave are mutually exclusive",
+                   "Pick one memory policy for the benchmarked command.");
+        return false;
+    }
+
+    const std::vector<int> online{onlineNodes()};
+
+    if (online.size() < 2) {
+        std::cerr << Colors::BrightYellow << "Note: " << Colors::Reset
+                  << "single NUMA node host; --numa-node/--membind/--interleave have no effect\n";
+        return true;
+    }
+
+    if (parser.has("numa-node")) {
+        std::string spec{parser.get("numa-node")};
+        if (spec == "all") {
+            perNode = true;
+        } else {
+            std::vector<int> nodes{parseList(spec)};
+            if (nodes.size() != 1 || !containsAll(online, nodes)) {
+                printError("--numa-node must be a single online node or 'all' (got '" + spec +
+                               "')",
+                           "Available nodes: " +
+                               readFirstLine("/sys/devices/system/node/online"));
+                return false;
+            }
+            placement.cpuNode = nodes[0];
+        }
+    }
+
+    const std::string memKey{parser.has("membind") ? "membind" : "interleave"};
+    if (parser.has(memKey)) {
+        std::string spec{parser.get(memKey)};
+        placement.memPolicy = (memKey == "membind") ? MpolBind : MpolInterleave;
+
+        if (spec.empty() || spec == "local") {
+            // Follow the CPU node; resolved per node when running with --numa-node all
+            if (placement.cpuNode < 0 && !perNode) {
+                printError("--" + memKey + " without a node list needs --numa-node",
+                           "Example: --numa-node 1 --" + memKey + " local");
+                return false;
+            }
+            placement.memNodes = {placement.cpuNode};
+        } else {
+            placement.memNodes = (spec == "all") ? online : parseList(spec);
+            if (placement.memNodes.empty()) {
+                printError("Invalid node list for --" + memKey + ": '" + spec + "'",
+                           "Example: --" + memKey + " 0,1 or --" + memKey + " 0-1");
+                return false;
+            }
+        }
+    }
+
+    return perNode || build(placement, online);
+#else
+    (void)placement;
+    std::cerr << Colors::BrightYellow << "Note: " << Colors::Reset
+              << "NUMA placement is only supported on Linux; ignoring NUMA options\n";
+    return true;
+#endif
+}
+
+/**
+ * @brief Placement for one node of a --numa-node all sweep.
+ */
+inline bool forNode(const Placement& base, int node, Placement& placement) {
+    placement = base;
+    placement.cpuNode = node;
+
+    bool followsCpu{placement.memNodes.size() == 1 && placement.memNodes[0] < 0};
+    if (followsCpu) {
+        placement.memNodes = {node};
+    }
+
+    return build(placement, onlineNodes());
+}
+
+/**
+ * @brief Apply the placement to the calling process.
+ * @return 0 on success, otherwise errno.
+ * @note Only performs raw system calls, so it is safe to use between fork and exec.
+ */
+inline int apply(const Placement& placement) {
+#ifdef __linux__
+    if (placement.cpuNode >= 0 && sched_setaffinity(0, sizeof(placement.cpus), &placement.cpus)) {
+        return errno;
+    }
+
+    if (placement.memPolicy != MpolDefault &&
+        syscall(SYS_set_mempolicy, placement.memPolicy, placement.nodeMask, MaskBits + 1) != 0) {
+        return errno;
+    }
+#else
+    (void)placement;
+#endif
+    return 0;
+}
+
+inline std::string describe(const Placement& placement) {
+    std::string text{};
+
+    if (placement.cpuNode >= 0) {
+        text += "node " + std::to_string(placement.cpuNode);
+    }
+
+    if (placement.memPolicy != MpolDefault) {
+        if (!text.empty())
+            text += " | ";
+        text += (placement.memPolicy == MpolBind) ? "membind " : "interleave ";
+        for (size_t i{0}; i < placement.memNodes.size(); ++i) {
+            if (i > 0)
+                text += ",";
+            text += std::to_string(placement.memNodes[i]);
+        }
+    }
+
+    return text;
+}
+
+} // namespace Numa
+
+#endif
@@ -0,0 +1,267 @@
+#ifndef OPENMETRICS_H
+#define OPENMETRICS_H
+
+#include "argparser.h"
+#include "vajra.hpp"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <iostream>
+#include <numeric>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#include <io.h>
+#else
+#include <unistd.h>
+#endif
+
+namespace OpenMetrics {
+
+/**
+ * @brief Largest number of finite buckets per histogram; above it the schema is coarsened, the
+ * same way Prometheus native histograms reduce resolution.
+ */
+constexpr int MaxBuckets{160};
+constexpr int DefaultSchema{3};
+
+inline std::string escapeLabel(const std::string& value) {
+    std::string out{};
+    for (char c : value) {
+        if (c == '\\') {
+            out += "\\\\";
+        } else if (c == '"') {
+            out += "\\\"";
+        } else if (c == '\n') {
+            out += "\\n";
+        } else {
+            out += c;
+        }
+    }
+    return out;
+}
+
+inline std::string labels(const BenchmarkResults& r) {
+    std::string out{"command=\"" + escapeLabel(r.command) + "\""};
+    if (!r.name.empty()) {
+        out += ",name=\"" + escapeLabel(r.name) + "\"";
+    }
+    if (r.numaNode >= 0) {
+        out += ",numa_node=\"" + std::to_string(r.numaNode) + "\"";
+    }
+    return out;
+}
+
+inline std::string number(double value) {
+    std::ostringstream out{};
+    out.precision(12);
+    out << value;
+    return out.str();
+}
+
+/**
+ * @brief Upper bounds of the native-histogram buckets spanning [min, max] seconds: powers of
+ * 2^(2^-schema), so the bucket layout is identical across runs and hosts and merges cleanly.
+ */
+inline std::vector<double> bucketBounds(double min, double max) {
+    std::vector<double> bounds{};
+    if (min <= 0 || max <= 0) {
+        return bounds;
+    }
+
+    for (int schema{DefaultSchema}; schema >= -4; --schema) {
+        const double base{std::pow(2.0, std::pow(2.0, -schema))};
+        const int first{static_cast<int>(std::ceil(std::log(min) / std::log(base)))};
+        const int last{static_cast<int>(std::ceil(std::log(max) / std::log(base)))};
+        if (last - first + 1 <= MaxBuckets) {
+            for (int k{first}; k <= last; ++k) {
+                bounds.push_back(std::pow(base, k));
+            }
+            return bounds;
+        }
+    }
+    return bounds;
+}
+
+/**
+ * @brief Render results in the OpenMetrics text exposition format.
+ */
+inline std::string format(const std::vector<BenchmarkResults>& results) {
+    std::ostringstream out{};
+    const double now{static_cast<double>(std::time(nullptr))};
+
+    out << "# TYPE vajra_run_duration_seconds histogram\n"
+        << "# UNIT vajra_run_duration_seconds seconds\n"
+        << "# HELP vajra_run_duration_seconds Wall time of one run of the command.\n";
+    for (const auto& r : results) {
+        const auto wall{r.wallNs()};
+        if (wall.empty()) {
+            continue;
+        }
+        std::vector<double> seconds{};
+        seconds.reserve(wall.size());
+        for (uint64_t ns : wall) {
+            seconds.push_back(r.toMs(static_cast<double>(ns)) / 1000.0);
+        }
+        // Summed as integers, so the total is exact however many runs there were
+        const uint64_t totalNs{std::accumulate(wall.begin(), wall.end(), uint64_t{0})};
+        std::sort(seconds.begin(), seconds.end());
+
+        const std::string l{labels(r)};
+        for (double bound : bucketBounds(seconds.front(), seconds.back())) {
+            auto count{std::upper_bound(seconds.begin(), seconds.end(), bound) - seconds.begin()};
+            out << "vajra_run_duration_seconds_bucket{" << l << ",le=\"" << number(bound)
+                << "\"} " << count << "\n";
+        }
+        out << "vajra_run_duration_seconds_bucket{" << l << ",le=\"+Inf\"} " << seconds.size()
+            << "\n"
+            << "vajra_run_duration_seconds_count{" << l << "} " << seconds.size() << "\n"
+            << "vajra_run_duration_seconds_sum{" << l << "} "
+            << number(r.toMs(static_cast<double>(totalNs)) / 1000.0) << "\n";
+    }
+
+    out << "# TYPE vajra_run_duration_summary_seconds summary\n"
+        << "# UNIT vajra_run_duration_summary_seconds seconds\n"
+        << "# HELP vajra_run_duration_summary_seconds Quantiles of the run wall time.\n";
+    for (const auto& r : results) {
+        const std::string l{labels(r)};
+        // Results relayed from a daemon carry no samples; they still get count and sum
+        for (double q : r.wallNs().empty() ? std::vector<double>{} : std::vector{0.5, 0.9, 0.99}) {
+            out << "vajra_run_duration_summary_seconds{" << l << ",quantile=\"" << number(q)
+                << "\"} "
+                << number(r.toMs(Statistics::percentile(r.wallNs(), q * 100.0)) / 1000.0) << "\n";
+        }
+        out << "vajra_run_duration_summary_seconds_count{" << l << "} " << r.iterations << "\n"
+            << "vajra_run_duration_summary_seconds_sum{" << l << "} "
+            << number(r.mean * r.iterations / 1000.0) << "\n";
+    }
+
+    auto gauge{[&](const char* metric, const char* help, auto value) {
+        out << "# TYPE " << metric << " gauge\n";
+        if (std::string{metric}.ends_with("_seconds")) {
+            out << "# UNIT " << metric << " seconds\n";
+        }
+        out << "# HELP " << metric << " " << help << "\n";
+        for (const auto& r : results) {
+            out << metric << "{" << labels(r) << "} " << number(value(r)) << "\n";
+        }
+    }};
+    gauge("vajra_run_duration_mean_seconds", "Mean wall time per run.",
+          [](const BenchmarkResults& r) { return r.mean / 1000.0; });
+    gauge("vajra_run_duration_stddev_seconds", "Standard deviation of the wall time.",
+          [](const BenchmarkResults& r) { return r.stdDev / 1000.0; });
+    gauge("vajra_run_duration_min_seconds", "Fastest run.",
+          [](const BenchmarkResults& r) { return r.min / 1000.0; });
+    gauge("vajra_run_duration_max_seconds", "Slowest run.",
+          [](const BenchmarkResults& r) { return r.max / 1000.0; });
+    gauge("vajra_last_run_timestamp_seconds", "When this benchmark last finished.",
+          [now](const BenchmarkResults&) { return now; });
+
+    // Totals over the last benchmark's runs: each export replaces the previous one, so they
+    // can go down and are gauges, not counters
+    auto total{[&](const char* metric, const char* help, auto value, auto present) {
+        bool any{false};
+        for (const auto& r : results) {
+            any = any || present(r);
+        }
+        if (!any) {
+            return;
+        }
+        out << "# TYPE " << metric << " gauge\n"
+            << "# HELP " << metric << " " << help << "\n";
+        for (const auto& r : results) {
+            if (present(r)) {
+                out << metric << "{" << labels(r) << "} "
+                    << number(std::round(value(r) * r.iterations)) << "\n";
+            }
+        }
+    }};
+    auto always{[](const BenchmarkResults&) { return true; }};
+    auto sched{[](const BenchmarkResults& r) { return r.hasSched; }};
+    auto io{[](const BenchmarkResults& r) { return r.hasIo; }};
+
+    total("vajra_runs", "Timed runs.", [](const BenchmarkResults&) { return 1.0; }, always);
+    total("vajra_context_switches", "Context switches of the command over the timed runs.",
+          [](const BenchmarkResults& r) { return r.switchesPerRun; }, sched);
+    total("vajra_cpu_migrations", "CPU migrations of the command over the timed runs.",
+          [](const BenchmarkResults& r) { return r.migrationsPerRun; }, sched);
+    total("vajra_storage_read_bytes", "Bytes read from storage over the timed runs.",
+          [](const BenchmarkResults& r) { return r.readBytesPerRun; }, io);
+    total("vajra_storage_write_bytes", "Bytes written to storage over the timed runs.",
+          [](const BenchmarkResults& r) { return r.writeBytesPerRun; }, io);
+    total("vajra_read_syscalls", "read-type syscalls over the timed runs.",
+          [](const BenchmarkResults& r) { return r.syscrPerRun; }, io);
+    total("vajra_write_syscalls", "write-type syscalls over the timed runs.",
+          [](const BenchmarkResults& r) { return r.syscwPerRun; }, io);
+
+    bool anyMetrics{false};
+    for (const auto& r : results) {
+        anyMetrics = anyMetrics || !r.metrics.empty();
+    }
+    if (anyMetrics) {
+        out << "# TYPE vajra_collector_metric gauge\n"
+            << "# HELP vajra_collector_metric Per-run value reported by a collector plugin.\n";
+        for (const auto& r : results) {
+            for (const auto& m : r.metrics) {
+                const std::string l{labels(r) + ",metric=\"" + escapeLabel(m.name) + "\""};
+                out << "vajra_collector_metric{" << l << ",stat=\"mean\"} " << number(m.mean)
+                    << "\n"
+                    << "vajra_collector_metric{" << l << ",stat=\"std_dev\"} "
+                    << number(m.stdDev) << "\n"
+                    << "vajra_collector_metric{" << l << ",stat=\"min\"} " << number(m.min)
+                    << "\n"
+                    << "vajra_collector_metric{" << l << ",stat=\"max\"} " << number(m.max)
+                    << "\n";
+            }
+        }
+    }
+
+    out << "# EOF\n";
+    return out.str();
+}
+
+/**
+ * @brief Write the exposition to a temporary file next to the target and rename it into place, so
+ * a textfile collector never reads a half-written file.
+ */
+inline bool write(const std::string& path, const std::vector<BenchmarkResults>& results) {
+#ifdef _WIN32
+    const std::string temp{path + ".tmp"};
+#else
+    const std::string temp{path + ".tmp." + std::to_string(getpid())};
+#endif
+    const std::string text{format(results)};
+
+    std::FILE* file{std::fopen(temp.c_str(), "wb")};
+    bool ok{file != nullptr};
+    if (file) {
+        ok = std::fwrite(text.data(), 1, text.size(), file) == text.size();
+        ok = std::fflush(file) == 0 && ok;
+#ifdef _WIN32
+        _commit(_fileno(file));
+#else
+        fsync(fileno(file));
+#endif
+        ok = std::fclose(file) == 0 && ok;
+    }
+
+#ifdef _WIN32
+    std::remove(path.c_str());
+#endif
+    if (!ok || std::rename(temp.c_str(), path.c_str()) != 0) {
+        std::remove(temp.c_str());
+        std::cerr << Colors::BrightRed << "Error: " << Colors::Reset << "Cannot write '" << path
+                  << "'\n";
+        return false;
+    }
+    return true;
+}
+
+} // namespace OpenMetrics
+
+#endif
@@ -0,0 +1,228 @@
+#ifndef PARETO_H
+#define PARETO_H
+
+#include "argparser.h"
+
+#include <algorithm>
+#include <cmath>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace Pareto {
+
+/**
+ * @brief Relative difference below which two candidates count as equal on an objective, so run
+ * to run noise doesn't decide who dominates whom.
+ */
+constexpr double Tolerance{0.01};
+
+/**
+ * @brief A quantity to minimize, available only if every compared result measured it.
+ */
+struct Objective {
+    const char* name;
+    const char* key;
+    double (*value)(const BenchmarkResults&);
+    std::string (*format)(double);
+};
+
+inline std::string formatMs(double ms) {
+    std::ostringstream out{};
+    out << std::fixed << std::setprecision(3) << ms << " ms";
+    return out.str();
+}
+
+inline std::vector<Objective> objectives(const std::vector<BenchmarkResults>& results) {
+    auto every{[&](bool BenchmarkResults::*flag) {
+        return std::all_of(results.begin(), results.end(),
+                           [flag](const BenchmarkResults& r) { return r.*flag; });
+    }};
+
+    // When every benchmark declares its input size, a sweep over inputs of different sizes is
+    // compared per megabyte; otherwise the smallest input would dominate everything else
+    const bool perByte{std::all_of(results.begin(), results.end(),
+                                   [](const BenchmarkResults& r) { return r.bytesPerRun > 0; })};
+    if (perByte) {
+        std::vector<Objective> all{{"wall time/MB", "wall_ms_per_mb",
+                                    [](const BenchmarkResults& r) {
+                                        return r.mean * 1048576.0 / r.bytesPerRun;
+                                    },
+                                    formatMs}};
+        if (every(&BenchmarkResults::hasUsage)) {
+            all.push_back({"CPU time/MB", "cpu_ms_per_mb",
+                           [](const BenchmarkResults& r) {
+                               return r.cpuMean * 1048576.0 / r.bytesPerRun;
+                           },
+                           formatMs});
+            all.push_back({"peak RSS", "peak_rss_bytes",
+                           [](const BenchmarkResults& r) { return r.peakRssMean; },
+                           BenchmarkResults::formatBytes});
+        }
+        if (every(&BenchmarkResults::hasOutput)) {
+            all.push_back({"output ratio", "output_bytes_per_byte",
+                           [](const BenchmarkResults& r) {
+                               return r.outputBytesMean / r.bytesPerRun;
+                           },
+                           [](double ratio) {
+                               std::ostringstream out{};
+                               out << std::fixed << std::setprecision(3) << ratio;
+                               return out.str();
+                           }});
+        }
+        return all;
+    }
+
+    std::vector<Objective> all{
+        {"wall time", "wall_ms", [](const BenchmarkResults& r) { return r.mean; }, formatMs}};
+    if (every(&BenchmarkResults::hasUsage)) {
+        all.push_back({"CPU time", "cpu_ms",
+                       [](const BenchmarkResults& r) { return r.cpuMean; }, formatMs});
+        all.push_back({"peak RSS", "peak_rss_bytes",
+                       [](const BenchmarkResults& r) { return r.peakRssMean; },
+                       BenchmarkResults::formatBytes});
+    }
+    if (every(&BenchmarkResults::hasOutput)) {
+        all.push_back({"output size", "output_bytes",
+                       [](const BenchmarkResults& r) { return r.outputBytesMean; },
+                       BenchmarkResults::formatBytes});
+    }
+    return all;
+}
+
+/**
+ * @brief a dominates b if it is no worse on every objective and clearly better on at least one.
+ */
+inline bool dominates(const BenchmarkResults& a, const BenchmarkResults& b,
+                      const std::vector<Objective>& objectives) {
+    bool better{false};
+    for (const auto& o : objectives) {
+        const double va{o.value(a)};
+        const double vb{o.value(b)};
+        const double slack{Tolerance * std::max(std::abs(va), std::abs(vb))};
+        if (va > vb + slack) {
+            return false;
+        }
+        if (va < vb - slack) {
+            better = true;
+        }
+    }
+    return better;
+}
+
+/**
+ * @brief For every result, the index of one result that dominates it, or -1 if it is on the front.
+ */
+inline std::vector<int> dominatedBy(const std::vector<BenchmarkResults>& results,
+                                    const std::vector<Objective>& objectives) {
+    std::vector<int> by(results.size(), -1);
+    for (size_t i{0}; i < results.size(); ++i) {
+        for (size_t j{0}; j < results.size() && by[i] == -1; ++j) {
+            if (i != j && !results[j].reservationFailed &&
+                dominates(results[j], results[i], objectives)) {
+                by[i] = static_cast<int>(j);
+            }
+        }
+    }
+    return by;
+}
+
+inline std::string label(const BenchmarkResults& r) {
+    return r.name.empty() ? r.command : r.name;
+}
+
+/**
+ * @brief Print the trade-off table: front members first (fastest first), then dominated ones
+ * with the candidate that beats them.
+ */
+inline void display(const std::vector<BenchmarkResults>& results) {
+    const std::vector<Objective> objs{objectives(results)};
+    if (results.size() < 2 || objs.size() < 2) {
+        return; // with wall time alone the front is just the fastest benchmark
+    }
+    const std::vector<int> by{dominatedBy(results, objs)};
+
+    std::vector<size_t> order(results.size());
+    for (size_t i{0}; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        if ((by[a] == -1) != (by[b] == -1)) {
+            return by[a] == -1;
+        }
+        return results[a].mean < results[b].mean;
+    });
+
+    size_t nameWidth{4};
+    for (const auto& r : results) {
+        nameWidth = std::max(nameWidth, label(r).size());
+    }
+
+    std::cout << Colors::Bold << Colors::BrightWhite << "Pareto front: " << Colors::Reset
+              << Colors::Dim;
+    for (size_t k{0}; k < objs.size(); ++k) {
+        std::cout << (k > 0 ? ", " : "") << objs[k].name;
+    }
+    std::cout << " (lower is better)" << Colors::Reset << "\n";
+
+    std::cout << Colors::Bold << "    " << std::left << std::setw(static_cast<int>(nameWidth))
+              << "name" << std::right;
+    for (const auto& o : objs) {
+        std::cout << std::setw(14) << o.name;
+    }
+    std::cout << Colors::Reset << "\n";
+
+    for (size_t i : order) {
+        const bool front{by[i] == -1};
+        std::cout << "  " << (front ? Colors::BrightGreen + "★ " : Colors::Dim + "· ")
+                  << std::left << std::setw(static_cast<int>(nameWidth)) << label(results[i])
+                  << std::right;
+        for (const auto& o : objs) {
+            std::cout << std::setw(14) << o.format(o.value(results[i]));
+        }
+        if (!front) {
+            std::cout << "  dominated by " << label(results[static_cast<size_t>(by[i])]);
+        }
+        std::cout << Colors::Reset << "\n";
+    }
+    std::cout << "\n";
+}
+
+inline std::string toJson(const std::vector<BenchmarkResults>& results) {
+    const std::vector<Objective> objs{objectives(results)};
+    const std::vector<int> by{dominatedBy(results, objs)};
+
+    std::ostringstream json{};
+    json << "  \"pareto\": {\"objectives\": [";
+    for (size_t k{0}; k < objs.size(); ++k) {
+        json << (k > 0 ? ", " : "") << "\"" << objs[k].key << "\"";
+    }
+    json << "], \"front\": [";
+    bool first{true};
+    for (size_t i{0}; i < results.size(); ++i) {
+        if (by[i] == -1) {
+            json << (first ? "" : ", ") << "\"" << BenchmarkResults::escapeJson(label(results[i]))
+                 << "\"";
+            first = false;
+        }
+    }
+    json << "], \"dominated\": {";
+    first = true;
+    for (size_t i{0}; i < results.size(); ++i) {
+        if (by[i] != -1) {
+            json << (first ? "" : ", ") << "\"" << BenchmarkResults::escapeJson(label(results[i]))
+                 << "\": \""
+                 << BenchmarkResults::escapeJson(label(results[static_cast<size_t>(by[i])]))
+                 << "\"";
+            first = false;
+        }
+    }
+    json << "}}";
+    return json.str();
+}
+
+} // namespace Pareto
+
+#endif
@@ -0,0 +1,570 @@
+#ifndef PERFFUZZ_H
+#define PERFFUZZ_H
+
+#include "argparser.h"
+#include "corpus.h"
+#include "exec.h"
+#include "runner.h"
+#include "suite.h"
+
+#include <algorithm>
+#include <cmath>
+#include <csignal>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace PerfFuzz {
+
+/**
+ * @brief Work below this is mostly timer and scheduler noise; an input must cost at least this
+ * much beyond process startup before its cost per byte counts.
+ */
+constexpr double MinWorkMs{1.0};
+/**
+ * @brief How much costlier per byte a candidate must look before it is re-measured, and how much
+ * it must still be after that, so noise alone doesn't fill the population.
+ */
+constexpr double Margin{1.1};
+/**
+ * @brief Runs taken to confirm a promising candidate, and to measure seeds and the baseline.
+ */
+constexpr int ConfirmRuns{10};
+/**
+ * @brief CPU limit in seconds while the baseline and seeds are measured, before one can be
+ * derived from them; a seed that never finishes still can't stall the run.
+ */
+constexpr int SeedCpuLimit{60};
+/**
+ * @brief Chunk removals tried per kept input while minimizing it.
+ */
+constexpr int MinimizeEvals{48};
+/**
+ * @brief Without --cpu-limit, a run may use this many times the costliest seed's CPU time
+ * (at least a second) before it is stopped and its input saved as a hang.
+ */
+constexpr double HangFactor{20.0};
+
+struct Options {
+    std::string templ{};
+    std::string seedDir{};
+    std::string outDir{"perf-fuzz-out"};
+    int runs{3};          // per candidate; the minimum is kept
+    int maxEvals{300};    // candidates measured, minimization included
+    size_t keep{8};       // population size
+    size_t maxLen{0};     // 0: twice the largest seed, at least 64 bytes
+    double minSlowdown{1.5};
+    int cpuLimitSeconds{0}; // 0: derived from the seeds
+    uint64_t rngSeed{0};
+};
+
+enum class Verdict { Ok, Crash, Hang };
+
+struct Input {
+    std::vector<uint8_t> data{};
+    double workMs{0};      // CPU time beyond an empty input's, best of the runs taken
+    std::string origin{};  // the seed it descends from
+    bool seed{false};
+};
+
+/**
+ * @brief Cost per megabyte, or 0 when the input does too little work to tell from noise.
+ */
+inline double density(const Input& input) {
+    if (input.workMs < MinWorkMs || input.data.empty()) {
+        return 0.0;
+    }
+    return input.workMs * 1048576.0 / static_cast<double>(input.data.size());
+}
+
+struct Outcome {
+    double baselineMs{0};
+    double referenceDensity{0}; // median seed cost per MB
+    std::vector<Input> seeds{};
+    std::vector<Input> slow{};  // minimized, slowest per byte first
+    std::vector<std::string> crashes{};
+    std::vector<std::string> hangs{};
+    int cpuLimitSeconds{0};
+    int evaluations{0};
+    bool interrupted{false};
+    bool failed{false};
+};
+
+/**
+ * @brief Mutation-based search for inputs that cost the most per byte, in the spirit of PerfFuzz
+ * but without coverage instrumentation: the only feedback is the measured CPU time. A population
+ * of the costliest inputs seen so far is mutated (bit flips, bytes taken from the seeds, block
+ * duplication, deletion and splicing); a candidate that looks costlier per byte than the cheapest
+ * member is re-measured and, if it holds up, replaces it. Survivors are then shrunk by removing
+ * chunks while their cost per byte holds.
+ */
+class Fuzzer {
+  private:
+    const Options& options;
+    BenchmarkConfig config;
+    const Exec::Mode mode;
+    const bool quiet;
+    std::mt19937_64 rng;
+    std::string candidatePath{};
+    std::vector<uint8_t> alphabet{}; // every byte value that occurs in the seeds
+    size_t maxLen{0};
+    Outcome outcome{};
+
+    size_t pick(size_t n) {
+        return std::uniform_int_distribution<size_t>{0, n - 1}(rng);
+    }
+
+    bool prepare() {
+        std::error_code ec{};
+        std::filesystem::create_directories(options.outDir, ec);
+        if (ec) {
+            Suite::printError("Cannot create '" + options.outDir + "': " + ec.message());
+            return false;
+        }
+        candidatePath = options.outDir + "/.candidate";
+
+        config.quiet = true;
+        config.command =
+            Suite::replaceAll(options.templ, "{file}", Corpus::quote(candidatePath));
+        if (config.useShell) {
+            // measure() spawns the command itself, so --shell needs an explicit shell argv
+            config.cmdArgs = {"/bin/sh", "-c", config.command};
+        } else {
+            config.cmdArgs = parseCommand(config.command);
+            if (config.cmdArgs.empty()) {
+                Suite::printError("Failed to parse command");
+                return false;
+            }
+#ifdef __linux__
+            auto image{std::make_shared<Exec::Image>()};
+            if (!Exec::prepare(*image, config.cmdArgs, mode)) {
+                return false;
+            }
+            config.image = image;
+#endif
+        }
+        return true;
+    }
+
+    /**
+     * @brief Run the command on data 'runs' times; the least CPU time (wall time if usage is
+     * unavailable) minus the baseline. A run stopped by the CPU limit is a hang, one killed by
+     * any other signal a crash; either ends the measurement.
+     */
+    bool measure(const std::vector<uint8_t>& data, int runs, double& workMs, Verdict& verdict) {
+        {
+            std::ofstream file{candidatePath, std::ios::binary | std::ios::trunc};
+            file.write(reinterpret_cast<const char*>(data.data()),
+                       static_cast<std::streamsize>(data.size()));
+            if (!file) {
+                Suite::printError("Cannot write '" + candidatePath + "'");
+                return false;
+            }
+        }
+
+        double best{-1};
+        verdict = Verdict::Ok;
+        for (int i{0}; i < runs && verdict == Verdict::Ok && !interruptRequested; ++i) {
+            const RunResult run{executeCommand(config)};
+            if (run.signal == SIGXCPU || (run.signal == SIGKILL && config.cpuLimitSeconds > 0)) {
+                verdict = Verdict::Hang;
+            } else if (run.signal != 0) {
+                verdict = Verdict::Crash;
+            }
+            const double ms{run.usage.valid
+                                ? static_cast<double>(run.usage.userNs + run.usage.systemNs) / 1e6
+                                : static_cast<double>(run.wallNs) / 1e6};
+            best = best < 0 ? ms : std::min(best, ms);
+        }
+        workMs = std::max(0.0, best - outcome.baselineMs);
+        return best >= 0;
+    }
+
+    /**
+     * @brief Keep an input that crashed or hung the command; those are findings too.
+     * @return true if the verdict was Ok.
+     */
+    bool triage(const std::vector<uint8_t>& data, Verdict verdict) {
+        if (verdict == Verdict::Ok) {
+            return true;
+        }
+        std::vector<std::string>& list{verdict == Verdict::Hang ? outcome.hangs
+                                                                 : outcome.crashes};
+        std::ostringstream name{};
+        name << options.outDir << (verdict == Verdict::Hang ? "/hang-" : "/crash-")
+             << std::setw(3) << std::setfill('0') << list.size() + 1 << ".bin";
+        std::ofstream file{name.str(), std::ios::binary | std::ios::trunc};
+        file.write(reinterpret_cast<const char*>(data.data()),
+                   static_cast<std::streamsize>(data.size()));
+        list.push_back(name.str());
+        return false;
+    }
+
+    std::vector<uint8_t> mutate(const std::vector<Input>& population, const Input& parent) {
+        std::vector<uint8_t> data{parent.data};
+        const size_t stack{1 + pick(4)};
+        for (size_t s{0}; s < stack; ++s) {
+            if (data.empty()) {
+                data.push_back(alphabet[pick(alphabet.size())]);
+                continue;
+            }
+            const size_t at{pick(data.size())};
+            const size_t len{1 + pick(std::min<size_t>(data.size() - at, 64))};
+            switch (pick(6)) {
+            case 0:
+                data[at] = static_cast<uint8_t>(data[at] ^ (1u << pick(8)));
+                break;
+            case 1:
+                data[at] = alphabet[pick(alphabet.size())];
+                break;
+            case 2: {
+                // Repetition and nesting are where super-linear behaviour usually hides
+                const std::vector<uint8_t> block(data.begin() + static_cast<long>(at),
+                                                 data.begin() + static_cast<long>(at + len));
+                const size_t copies{1 + pick(8)};
+                for (size_t c{0}; c < copies; ++c) {
+                    data.insert(data.begin() + static_cast<long>(at), block.begin(), block.end());
+                }
+                break;
+            }
+            case 3:
+                if (data.size() > len) {
+                    data.erase(data.begin() + static_cast<long>(at),
+                               data.begin() + static_cast<long>(at + len));
+                }
+                break;
+            case 4: {
+                const size_t to{pick(data.size())};
+                const std::vector<uint8_t> block(data.begin() + static_cast<long>(at),
+                                                 data.begin() + static_cast<long>(at + len));
+                for (size_t k{0}; k < block.size() && to + k < data.size(); ++k) {
+                    data[to + k] = block[k];
+                }
+                break;
+            }
+            default: {
+                const Input& other{population[pick(population.size())]};
+                if (!other.data.empty()) {
+                    const size_t from{pick(other.data.size())};
+                    data.resize(at);
+                    data.insert(data.end(), other.data.begin() + static_cast<long>(from),
+                                other.data.end());
+                }
+                break;
+            }
+            }
+        }
+        if (data.size() > maxLen) {
+            data.resize(maxLen);
+        }
+        return data;
+    }
+
+    bool budgetLeft() const {
+        return outcome.evaluations < options.maxEvals && !interruptRequested;
+    }
+
+    /**
+     * @brief Remove ever smaller chunks while the cost per byte stays within 10%.
+     */
+    void minimize(Input& input) {
+        const double target{0.9 * density(input)};
+        int tries{0};
+        for (size_t chunk{input.data.size() / 2}; chunk > 0 && tries < MinimizeEvals;
+             chunk /= 2) {
+            for (size_t at{0}; at + chunk <= input.data.size() && tries < MinimizeEvals;) {
+                if (!budgetLeft()) {
+                    return;
+                }
+                std::vector<uint8_t> smaller{input.data};
+                smaller.erase(smaller.begin() + static_cast<long>(at),
+                              smaller.begin() + static_cast<long>(at + chunk));
+                ++tries;
+                ++outcome.evaluations;
+
+                Input candidate{std::move(smaller), 0, input.origin, false};
+                Verdict verdict{};
+                if (measure(candidate.data, options.runs, candidate.workMs, verdict) &&
+                    verdict == Verdict::Ok && density(candidate) >= target) {
+                    input = std::move(candidate);
+                } else {
+                    at += chunk;
+                }
+            }
+        }
+        Verdict verdict{};
+        measure(input.data, ConfirmRuns, input.workMs, verdict);
+    }
+
+  public:
+    Fuzzer(const Options& options, const BenchmarkConfig& base, Exec::Mode mode)
+        : options{options}, config{base}, mode{mode}, quiet{base.quiet}, rng{options.rngSeed} {
+        config.cache = nullptr;
+        config.journal = nullptr;
+        config.collectors = nullptr;
+        config.live = nullptr;
+        config.outputSize.clear();
+    }
+
+    Outcome run() {
+        if (!prepare()) {
+            outcome.failed = true;
+            return outcome;
+        }
+
+        std::set<uint8_t> bytes{};
+        for (const auto& path : Corpus::listFiles(options.seedDir)) {
+            std::ifstream file{path, std::ios::binary};
+            Input seed{{std::istreambuf_iterator<char>{file}, std::istreambuf_iterator<char>{}},
+                       0,
+                       std::filesystem::relative(path, options.seedDir).string(),
+                       true};
+            bytes.insert(seed.data.begin(), seed.data.end());
+            outcome.seeds.push_back(std::move(seed));
+        }
+        if (outcome.seeds.empty()) {
+            Suite::printError("No seed files found in '" + options.seedDir + "'");
+            outcome.failed = true;
+            return outcome;
+        }
+        alphabet.assign(bytes.begin(), bytes.end());
+        if (alphabet.empty()) {
+            alphabet.push_back(0);
+        }
+        maxLen = options.maxLen;
+        if (maxLen == 0) {
+            for (const auto& seed : outcome.seeds) {
+                maxLen = std::max(maxLen, 2 * seed.data.size());
+            }
+            maxLen = std::max<size_t>(maxLen, 64);
+        }
+
+        config.cpuLimitSeconds =
+            options.cpuLimitSeconds > 0 ? options.cpuLimitSeconds : SeedCpuLimit;
+
+        double workMs{0};
+        Verdict verdict{};
+        if (!measure({}, ConfirmRuns, workMs, verdict)) {
+            outcome.failed = true;
+            return outcome;
+        }
+        outcome.baselineMs = workMs;
+
+        std::vector<double> seedDensities{};
+        for (auto& seed : outcome.seeds) {
+            measure(seed.data, ConfirmRuns, seed.workMs, verdict);
+            triage(seed.data, verdict);
+            if (!seed.data.empty()) {
+                seedDensities.push_back(seed.workMs * 1048576.0 /
+                                        static_cast<double>(seed.data.size()));
+            }
+        }
+        if (!seedDensities.empty()) {
+            std::sort(seedDensities.begin(), seedDensities.end());
+            outcome.referenceDensity = seedDensities[seedDensities.size() / 2];
+        }
+
+        double costliest{0};
+        for (const auto& seed : outcome.seeds) {
+            costliest = std::max(costliest, outcome.baselineMs + seed.workMs);
+        }
+        config.cpuLimitSeconds =
+            options.cpuLimitSeconds > 0
+                ? options.cpuLimitSeconds
+                : std::max(1, static_cast<int>(std::ceil(HangFactor * costliest / 1000.0)));
+        outcome.cpuLimitSeconds = config.cpuLimitSeconds;
+
+        std::vector<Input> population{outcome.seeds};
+        auto cheapest{[&population]() {
+            return std::min_element(population.begin(), population.end(),
+                                    [](const Input& a, const Input& b) {
+                                        return density(a) < density(b);
+                                    });
+        }};
+
+        // Leave a quarter of the budget for minimizing what was found
+        const int searchBudget{options.maxEvals - options.maxEvals / 4};
+        while (outcome.evaluations < searchBudget && !interruptRequested) {
+            const Input& parent{population[pick(population.size())]};
+            Input candidate{mutate(population, parent), 0, parent.origin, false};
+            ++outcome.evaluations;
+            if (!measure(candidate.data, options.runs, candidate.workMs, verdict)) {
+                break;
+            }
+            if (!triage(candidate.data, verdict)) {
+                continue;
+            }
+
+            const double floor{population.size() < options.keep ? 0.0
+                                                                : density(*cheapest())};
+            if (density(candidate) <= Margin * floor || density(candidate) == 0.0) {
+                continue;
+            }
+            if (!measure(candidate.data, ConfirmRuns, candidate.workMs, verdict) ||
+                !triage(candidate.data, verdict) ||
+                density(candidate) <= Margin * floor) {
+                continue;
+            }
+
+            if (!quiet) {
+                std::cout << "  " << Colors::Dim << "[" << std::setw(4) << outcome.evaluations
+                          << "] " << Colors::Reset << "kept " << candidate.data.size()
+                          << " bytes from " << candidate.origin << Colors::Dim << "  "
+                          << std::fixed << std::setprecision(3) << density(candidate)
+                          << " ms/MB" << Colors::Reset << "\n"
+                          << std::flush;
+            }
+            if (population.size() >= options.keep) {
+                population.erase(cheapest());
+            }
+            population.push_back(std::move(candidate));
+        }
+        outcome.interrupted = interruptRequested != 0;
+
+        for (auto& input : population) {
+            if (!input.seed) {
+                outcome.slow.push_back(std::move(input));
+            }
+        }
+        std::sort(outcome.slow.begin(), outcome.slow.end(),
+                  [](const Input& a, const Input& b) { return density(a) > density(b); });
+        for (auto& input : outcome.slow) {
+            minimize(input);
+        }
+
+        // Keep only clear slowdowns, and drop an input if a no larger one is at least as costly
+        const double reference{outcome.referenceDensity};
+        std::erase_if(outcome.slow, [&](const Input& input) {
+            return reference <= 0 || density(input) < options.minSlowdown * reference;
+        });
+        std::sort(outcome.slow.begin(), outcome.slow.end(),
+                  [](const Input& a, const Input& b) { return density(a) > density(b); });
+        std::vector<Input> minimal{};
+        for (auto& input : outcome.slow) {
+            const bool redundant{std::any_of(minimal.begin(), minimal.end(), [&](const Input& k) {
+                return k.data.size() <= input.data.size() && density(k) >= density(input);
+            })};
+            if (!redundant) {
+                minimal.push_back(std::move(input));
+            }
+        }
+        outcome.slow = std::move(minimal);
+
+        for (size_t i{0}; i < outcome.slow.size(); ++i) {
+            std::ostringstream name{};
+            name << options.outDir << "/slow-" << std::setw(3) << std::setfill('0') << i + 1
+                 << ".bin";
+            std::ofstream file{name.str(), std::ios::binary | std::ios::trunc};
+            file.write(reinterpret_cast<const char*>(outcome.slow[i].data.data()),
+                       static_cast<std::streamsize>(outcome.slow[i].data.size()));
+        }
+        std::remove(candidatePath.c_str());
+        return outcome;
+    }
+};
+
+inline double slowdown(const Outcome& outcome, const Input& input) {
+    return outcome.referenceDensity > 0 ? density(input) / outcome.referenceDensity : 0.0;
+}
+
+inline void display(const Options& options, const Outcome& outcome) {
+    std::cout << "\n"
+              << Colors::Bold << Colors::BrightWhite << "Perf-fuzz result: " << Colors::Reset
+              << Colors::Dim << outcome.evaluations << " inputs measured, startup "
+              << std::fixed << std::setprecision(3) << outcome.baselineMs
+              << " ms, seeds median " << outcome.referenceDensity << " ms/MB" << Colors::Reset
+              << "\n";
+    if (outcome.interrupted) {
+        std::cout << "  " << Colors::BrightYellow << "⚠ " << Colors::Reset
+                  << "interrupted; these are the inputs found so far\n";
+    }
+
+    if (outcome.slow.empty()) {
+        std::cout << "  " << Colors::BrightGreen << "✓ " << Colors::Reset
+                  << "no input was " << std::setprecision(1) << options.minSlowdown
+                  << "× costlier per byte than the seeds\n";
+    } else {
+        std::cout << Colors::Bold << "  file" << std::setw(20) << "size" << std::setw(14)
+                  << "work (ms)" << std::setw(14) << "ms/MB" << std::setw(12) << "slowdown"
+                  << "  seed" << Colors::Reset << "\n";
+        for (size_t i{0}; i < outcome.slow.size(); ++i) {
+            const Input& input{outcome.slow[i]};
+            std::ostringstream name{};
+            name << "slow-" << std::setw(3) << std::setfill('0') << i + 1 << ".bin";
+            std::cout << "  " << Colors::BrightRed << std::left << std::setw(12) << name.str()
+                      << std::right << Colors::Reset << std::setw(12)
+                      << BenchmarkResults::formatBytes(static_cast<double>(input.data.size()))
+                      << std::setprecision(3) << std::setw(14) << input.workMs << std::setw(14)
+                      << density(input) << Colors::BrightRed << std::setprecision(1)
+                      << std::setw(11) << slowdown(outcome, input) << "×" << Colors::Reset
+                      << "  " << Colors::Dim << input.origin << Colors::Reset << "\n";
+        }
+        std::cout << "  " << Colors::Dim << "written to " << options.outDir << "/"
+                  << Colors::Reset << "\n";
+    }
+
+    if (!outcome.hangs.empty()) {
+        std::cout << "  " << Colors::BrightYellow << "⚠ " << Colors::Reset << outcome.hangs.size()
+                  << " input(s) exceeded the " << outcome.cpuLimitSeconds
+                  << " s CPU limit, saved as " << options.outDir << "/hang-*.bin\n";
+    }
+    if (!outcome.crashes.empty()) {
+        std::cout << "  " << Colors::BrightYellow << "⚠ " << Colors::Reset
+                  << outcome.crashes.size() << " input(s) crashed the command, saved as "
+                  << options.outDir << "/crash-*.bin\n";
+    }
+    std::cout << "\n";
+}
+
+inline std::string toJson(const Options& options, const Outcome& outcome) {
+    std::ostringstream json{};
+    json << std::fixed << std::setprecision(3) << "{\n"
+         << "  \"command\": \"" << BenchmarkResults::escapeJson(options.templ) << "\",\n"
+         << "  \"seed_dir\": \"" << BenchmarkResults::escapeJson(options.seedDir) << "\",\n"
+         << "  \"evaluations\": " << outcome.evaluations << ",\n"
+         << "  \"interrupted\": " << (outcome.interrupted ? "true" : "false") << ",\n"
+         << "  \"baseline_ms\": " << outcome.baselineMs << ",\n"
+         << "  \"seed_median_ms_per_mb\": " << outcome.referenceDensity << ",\n"
+         << "  \"slow_inputs\": [";
+    for (size_t i{0}; i < outcome.slow.size(); ++i) {
+        const Input& input{outcome.slow[i]};
+        std::ostringstream name{};
+        name << options.outDir << "/slow-" << std::setw(3) << std::setfill('0') << i + 1
+             << ".bin";
+        json << (i > 0 ? "," : "") << "\n    {\"file\": \""
+             << BenchmarkResults::escapeJson(name.str()) << "\", \"bytes\": "
+             << input.data.size() << ", \"work_ms\": " << input.workMs
+             << ", \"ms_per_mb\": " << density(input)
+             << ", \"slowdown\": " << slowdown(outcome, input) << ", \"seed\": \""
+             << BenchmarkResults::escapeJson(input.origin) << "\"}";
+    }
+    json << (outcome.slow.empty() ? "" : "\n  ") << "],\n"
+         << "  \"crashes\": [";
+    for (size_t i{0}; i < outcome.crashes.size(); ++i) {
+        json << (i > 0 ? ", " : "") << "\"" << BenchmarkResults::escapeJson(outcome.crashes[i])
+             << "\"";
+    }
+    json << "],\n"
+         << "  \"hangs\": [";
+    for (size_t i{0}; i < outcome.hangs.size(); ++i) {
+        json << (i > 0 ? ", " : "") << "\"" << BenchmarkResults::escapeJson(outcome.hangs[i])
+             << "\"";
+    }
+    json << "],\n"
+         << "  \"cpu_limit_seconds\": " << outcome.cpuLimitSeconds << "\n"
+         << "}\n";
+    return json.str();
+}
+
+} // namespace PerfFuzz
+
+#endif
@@ -0,0 +1,316 @@
+#ifndef PRIORITY_H
+#define PRIORITY_H
+
+#include "argparser.h"
+
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <limits>
+#include <optional>
+#include <string>
+
+#ifdef __linux__
+#include <sched.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace Priority {
+
+/**
+ * @brief Scheduling priority, scheduling class and I/O priority to apply to a process.
+ */
+struct Settings {
+    std::optional<int> nice{};
+    std::optional<int> policy{};
+    int rtPriority{0};
+    std::optional<int> ioClass{};
+    int ioLevel{0};
+    bool applyToSelf{false};
+    bool lockMemory{false};
+
+    bool any() const {
+        return nice || policy || ioClass;
+    }
+};
+
+// Values from linux/ioprio.h, which glibc does not expose
+constexpr int IoprioClassRt{1};
+constexpr int IoprioClassBe{2};
+constexpr int IoprioClassIdle{3};
+constexpr int IoprioClassShift{13};
+constexpr int IoprioWhoProcess{1};
+
+inline bool parseInt(const std::string& text, int& out) {
+    if (text.empty()) {
+        return false;
+    }
+
+    char* end;
+    errno = 0;
+    long value{std::strtol(text.c_str(), &end, 10)};
+    if (*end != '\0' || errno == ERANGE || value < std::numeric_limits<int>::min() ||
+        value > std::numeric_limits<int>::max()) {
+        return false;
+    }
+
+    out = static_cast<int>(value);
+    return true;
+}
+
+inline void printError(const std::string& message, const std::string& hint) {
+    std::cerr << Colors::BrightRed << "Error: " << Colors::Reset << message << "\n";
+    std::cerr << Colors::Dim << hint << Colors::Reset << "\n";
+}
+
+/**
+ * @brief Parse a scheduling policy of the form "other", "batch", "idle", "fifo:<prio>" or
+ * "rr:<prio>".
+ */
+inline bool parseSched(const std::string& spec, Settings& settings) {
+#ifdef __linux__
+    auto colon{spec.find(':')};
+    std::string name{spec.substr(0, colon)};
+    std::string prio{colon == std::string::npos ? "" : spec.substr(colon + 1)};
+
+    if (name == "fifo" || name == "rr") {
+        settings.policy = (name == "fifo") ? SCHED_FIFO : SCHED_RR;
+
+        int minPrio{sched_get_priority_min(*settings.policy)};
+        int maxPrio{sched_get_priority_max(*settings.policy)};
+
+        if (!parseInt(prio, settings.rtPriority) || settings.rtPriority < minPrio ||
+            settings.rtPriority > maxPrio) {
+            printError("--sched " + name + " needs a priority between " + std::to_string(minPrio) +
+                           " and " + std::to_string(maxPrio) + " (got '" + spec + "')",
+                       "Example: --sched fifo:50");
+            return false;
+        }
+
+        return true;
+    }
+
+    if (!prio.empty()) {
+        printError("--sched " + name + " does not take a priority (got '" + spec + "')",
+                   "Only fifo and rr are real-time classes with a priority.");
+        return false;
+    }
+
+    if (name == "other") {
+        settings.policy = SCHED_OTHER;
+    } else if (name == "batch") {
+        settings.policy = SCHED_BATCH;
+    } else if (name == "idle") {
+        settings.policy = SCHED_IDLE;
+    } else {
+        printError("Unknown scheduling policy '" + name + "'",
+                   "Available policies: other, batch, idle, fifo:<prio>, rr:<prio>");
+        return false;
+    }
+
+    return true;
+#else
+    (void)settings;
+    printError("--sched '" + spec + "' is only supported on Linux", "Remove --sched to continue.");
+    return false;
+#endif
+}
+
+/**
+ * @brief Parse an I/O priority of the form "idle", "be[:<level>]" or "rt[:<level>]".
+ */
+inline bool parseIonice(const std::string& spec, Settings& settings) {
+#ifdef __linux__
+    auto colon{spec.find(':')};
+    std::string name{spec.substr(0, colon)};
+    std::string level{colon == std::string::npos ? "" : spec.substr(colon + 1)};
+
+    if (name == "rt") {
+        settings.ioClass = IoprioClassRt;
+    } else if (name == "be") {
+        settings.ioClass = IoprioClassBe;
+    } else if (name == "idle") {
+        settings.ioClass = IoprioClassIdle;
+    } else {
+        printError("Unknown I/O scheduling class '" + name + "'",
+                   "Available classes: rt[:0-7], be[:0-7], idle");
+        return false;
+    }
+
+    settings.ioLevel = (name == "idle") ? 0 : 4;
+    if (!level.empty()) {
+        if (name == "idle" || !parseInt(level, settings.ioLevel) || settings.ioLevel < 0 ||
+            settings.ioLevel > 7) {
+            printError("Invalid I/O priority level in --ionice '" + spec + "'",
+                       "Levels range from 0 (highest) to 7 (lowest); idle takes no level.");
+            return false;
+        }
+    }
+
+    return true;
+#else
+    (void)settings;
+    printError("--ionice '" + spec + "' is only supported on Linux",
+               "Remove --ionice to continue.");
+    return false;
+#endif
+}
+
+/**
+ * @brief Collect --nice, --sched, --ionice, --sched-self and --mlock from the command line.
+ */
+inline bool parseSettings(const ArgParser& parser, Settings& settings) {
+    if (parser.has("nice")) {
+        int nice{};
+        if (!parseInt(parser.get("nice"), nice) || nice < -20 || nice > 19) {
+            printError("--nice must be between -20 and 19 (got '" + parser.get("nice") + "')",
+                       "Lower values mean higher priority; negative values need privileges.");
+            return false;
+        }
+        settings.nice = nice;
+    }
+
+    if (parser.has("sched") && !parseSched(parser.get("sched"), settings)) {
+        return false;
+    }
+
+    if (parser.has("ionice") && !parseIonice(parser.get("ionice"), settings)) {
+        return false;
+    }
+
+    settings.applyToSelf = parser.has("sched-self");
+    settings.lockMemory = parser.has("mlock");
+
+    return true;
+}
+
+/**
+ * @brief Apply the settings to the calling process.
+ * @return 0 on success, otherwise the errno of the first failing call.
+ * @note Only performs raw system calls, so it is safe to use between fork and exec.
+ */
+inline int apply(const Settings& settings) {
+#ifdef __linux__
+    if (settings.nice && setpriority(PRIO_PROCESS, 0, *settings.nice) != 0) {
+        return errno;
+    }
+
+    if (settings.policy) {
+        sched_param param{};
+        param.sched_priority = settings.rtPriority;
+        if (sched_setscheduler(0, *settings.policy, &param) != 0) {
+            return errno;
+        }
+    }
+
+    if (settings.ioClass) {
+        int ioprio{(*settings.ioClass << IoprioClassShift) | settings.ioLevel};
+        if (syscall(SYS_ioprio_set, IoprioWhoProcess, 0, ioprio) != 0) {
+            return errno;
+        }
+    }
+#else
+    (void)settings;
+#endif
+    return 0;
+}
+
+/**
+ * @brief Check in a throwaway child whether the settings can be applied, so a missing privilege
+ * is reported once instead of silently failing every run.
+ */
+inline int probe(const Settings& settings) {
+#ifdef __linux__
+    pid_t pid{fork()};
+    if (pid == -1) {
+        return errno;
+    }
+
+    if (pid == 0) {
+        _exit(apply(settings));
+    }
+
+    int status{};
+    waitpid(pid, &status, 0);
+    return WIFEXITED(status) ? WEXITSTATUS(status) : ECHILD;
+#else
+    (void)settings;
+    return 0;
+#endif
+}
+
+/**
+ * @brief Lock vajra's own pages in memory so its page faults don't land in samples.
+ * @return 0 on success, otherwise errno.
+ */
+inline int lockMemory() {
+#ifdef __linux__
+    if (mlockall(MCL_CURRENT | MCL_FUTURE) != 0) {
+        return errno;
+    }
+#endif
+    return 0;
+}
+
+inline std::string describe(const Settings& settings) {
+    std::string text{};
+    auto append{[&text](const std::string& part) {
+        if (!text.empty())
+            text += " | ";
+        text += part;
+    }};
+
+    if (settings.nice) {
+        append("nice " + std::to_string(*settings.nice));
+    }
+
+#ifdef __linux__
+    if (settings.policy) {
+        switch (*settings.policy) {
+        case SCHED_FIFO:
+            append("sched fifo:" + std::to_string(settings.rtPriority));
+            break;
+        case SCHED_RR:
+            append("sched rr:" + std::to_string(settings.rtPriority));
+            break;
+        case SCHED_BATCH:
+            append("sched batch");
+            break;
+        case SCHED_IDLE:
+            append("sched idle");
+            break;
+        default:
+            append("sched other");
+            break;
+        }
+    }
+#endif
+
+    if (settings.ioClass) {
+        static const char* classNames[]{"none", "rt", "be", "idle"};
+        std::string io{std::string{"ionice "} + classNames[*settings.ioClass]};
+        if (*settings.ioClass != IoprioClassIdle) {
+            io += ":" + std::to_string(settings.ioLevel);
+        }
+        append(io);
+    }
+
+    if (settings.applyToSelf && settings.any()) {
+        append("supervisor too");
+    }
+
+    if (settings.lockMemory) {
+        append("mlockall");
+    }
+
+    return text;
+}
+
+} // namespace Priority
+
+#endif
@@ -0,0 +1,168 @@
+#ifndef PROC_STAT_H
+#define PROC_STAT_H
+
+#include <cstdint>
+#include <string>
+
+#ifdef __linux__
+#include <fstream>
+#include <sstream>
+#endif
+
+#ifndef _WIN32
+#include <sys/resource.h>
+#endif
+
+namespace ProcStat {
+
+/**
+ * @brief Scheduler accounting of a single child process, read from /proc/<pid>/schedstat and
+ * /proc/<pid>/sched while the child is still a zombie. Main thread only.
+ */
+struct SchedStats {
+    bool valid{false};
+    uint64_t cpuTimeNs{};
+    uint64_t runDelayNs{};
+    uint64_t timeslices{};
+    uint64_t nrSwitches{};
+    uint64_t nrVoluntarySwitches{};
+    uint64_t nrInvoluntarySwitches{};
+    uint64_t nrMigrations{};
+};
+
+/**
+ * @brief I/O accounting of a single child process, read from /proc/<pid>/io.
+ */
+struct IoStats {
+    bool valid{false};
+    uint64_t rchar{};
+    uint64_t wchar{};
+    uint64_t syscr{};
+    uint64_t syscw{};
+    uint64_t readBytes{};
+    uint64_t writeBytes{};
+    uint64_t cancelledWriteBytes{};
+};
+
+/**
+ * @brief Resource usage of a single reaped child, from wait4().
+ */
+struct Usage {
+    bool valid{false};
+    uint64_t userNs{};
+    uint64_t systemNs{};
+    uint64_t maxRssBytes{};
+};
+
+#ifndef _WIN32
+
+inline Usage fromRusage(const rusage& ru) {
+    Usage usage{};
+    usage.valid = true;
+    usage.userNs = static_cast<uint64_t>(ru.ru_utime.tv_sec) * 1000000000ULL +
+                   static_cast<uint64_t>(ru.ru_utime.tv_usec) * 1000ULL;
+    usage.systemNs = static_cast<uint64_t>(ru.ru_stime.tv_sec) * 1000000000ULL +
+                     static_cast<uint64_t>(ru.ru_stime.tv_usec) * 1000ULL;
+#ifdef __APPLE__
+    usage.maxRssBytes = static_cast<uint64_t>(ru.ru_maxrss);
+#else
+    usage.maxRssBytes = static_cast<uint64_t>(ru.ru_maxrss) * 1024ULL; // kilobytes on Linux
+#endif
+    return usage;
+}
+
+#endif
+
+#ifdef __linux__
+
+/**
+ * @brief Reads the scheduler figures of a zombie child. These cover the main thread (thread-group
+ * leader) only: the other threads have already exited and their schedstat is gone by now.
+ */
+inline SchedStats readSchedStats(int pid) {
+    SchedStats stats{};
+    const std::string base{"/proc/" + std::to_string(pid)};
+
+    std::ifstream schedstat{base + "/schedstat"};
+    if (!(schedstat >> stats.cpuTimeNs >> stats.runDelayNs >> stats.timeslices)) {
+        return stats;
+    }
+    stats.valid = true;
+
+    std::ifstream sched{base + "/sched"};
+    std::string line{};
+
+    while (std::getline(sched, line)) {
+        auto colon{line.find(':')};
+        if (colon == std::string::npos) {
+            continue;
+        }
+
+        std::istringstream keyStream{line.substr(0, colon)};
+        std::string key{};
+        keyStream >> key;
+
+        uint64_t value{};
+        std::istringstream valueStream{line.substr(colon + 1)};
+        if (!(valueStream >> value)) {
+            continue;
+        }
+
+        if (key == "nr_switches") {
+            stats.nrSwitches = value;
+        } else if (key == "nr_voluntary_switches") {
+            stats.nrVoluntarySwitches = value;
+        } else if (key == "nr_involuntary_switches") {
+            stats.nrInvoluntarySwitches = value;
+        } else if (key == "se.nr_migrations") {
+            stats.nrMigrations = value;
+        }
+    }
+
+    return stats;
+}
+
+inline IoStats readIoStats(int pid) {
+    IoStats stats{};
+    std::ifstream io{"/proc/" + std::to_string(pid) + "/io"};
+    std::string key{};
+    uint64_t value{};
+
+    while (io >> key >> value) {
+        stats.valid = true;
+
+        if (key == "rchar:") {
+            stats.rchar = value;
+        } else if (key == "wchar:") {
+            stats.wchar = value;
+        } else if (key == "syscr:") {
+            stats.syscr = value;
+        } else if (key == "syscw:") {
+            stats.syscw = value;
+        } else if (key == "read_bytes:") {
+            stats.readBytes = value;
+        } else if (key == "write_bytes:") {
+            stats.writeBytes = value;
+        } else if (key == "cancelled_write_bytes:") {
+            stats.cancelledWriteBytes = value;
+        }
+    }
+
+    return stats;
+}
+
+#else
+
+inline SchedStats readSchedStats(int) {
+    return {};
+}
+
+inline IoStats readIoStats(int) {
+    return {};
+}
+
+#endif
+
+} // namespace ProcStat
+
+#endif
@@ -0,0 +1,344 @@
+#ifndef RESERVE_H
+#define RESERVE_H
+
+#include "argparser.h"
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <sched.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace Reserve {
+
+/**
+ * @brief How to behave when another vajra process is using the same CPUs.
+ */
+enum class Policy {
+    Share, // shared locks; coexist with other sharers but record the contention
+    Wait,  // exclusive locks; block until the CPUs are free
+    Fail,  // exclusive locks; give up immediately if the CPUs are busy
+    None,  // no coordination at all
+};
+
+inline const char* policyName(Policy policy) {
+    switch (policy) {
+    case Policy::Wait:
+        return "wait";
+    case Policy::Fail:
+        return "fail";
+    case Policy::None:
+        return "none";
+    default:
+        return "share";
+    }
+}
+
+inline bool parsePolicy(const std::string& name, Policy& policy) {
+    if (name == "share") {
+        policy = Policy::Share;
+    } else if (name == "wait") {
+        policy = Policy::Wait;
+    } else if (name == "fail") {
+        policy = Policy::Fail;
+    } else if (name == "none") {
+        policy = Policy::None;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+#ifdef __linux__
+
+/**
+ * @brief Create (if needed) a world-writable sticky directory and check it is safe to use: a real
+ * directory rather than a symlink, with the sticky bit set so nobody can swap our lock files.
+ */
+inline bool sharedDirectory(const char* dir) {
+    if (mkdir(dir, 01777) == 0) {
+        // mkdir honours the umask, which would leave the directory unusable by other users
+        chmod(dir, 01777);
+    }
+
+    struct stat st{};
+    if (lstat(dir, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        return false;
+    }
+    if (!(st.st_mode & S_ISVTX) && st.st_uid == geteuid()) {
+        // Left behind without the sticky bit by an older version, and ours to fix
+        if (chmod(dir, 01777) != 0 || lstat(dir, &st) != 0) {
+            return false;
+        }
+    }
+    return (st.st_mode & S_ISVTX) && access(dir, W_OK) == 0;
+}
+
+/**
+ * @brief Directory holding the per-CPU lock files. /run/vajra is shared by every user on the
+ * host; $XDG_RUNTIME_DIR/vajra and /tmp are fallbacks for unprivileged first use.
+ */
+inline std::string lockDirectory() {
+    const char* custom{std::getenv("VAJRA_LOCK_DIR")};
+    if (custom && *custom) {
+        return custom;
+    }
+
+    if (sharedDirectory("/run/vajra")) {
+        return "/run/vajra";
+    }
+
+    const char* runtimeDir{std::getenv("XDG_RUNTIME_DIR")};
+    if (runtimeDir && *runtimeDir) {
+        std::string dir{std::string{runtimeDir} + "/vajra"};
+        mkdir(dir.c_str(), 0700);
+        struct stat st{};
+        if (lstat(dir.c_str(), &st) == 0 && S_ISDIR(st.st_mode) && st.st_uid == geteuid()) {
+            return dir;
+        }
+    }
+
+    if (sharedDirectory("/tmp/vajra-locks")) {
+        return "/tmp/vajra-locks";
+    }
+    return "";
+}
+
+/**
+ * @brief Open a lock file without following symlinks. Only a file we created ourselves is made
+ * lockable by other users; a pre-existing one must be a plain regular file and is never modified.
+ * @return The descriptor, or -1 with errno set.
+ */
+inline int openLockFile(const std::string& path) {
+    bool created{true};
+    int fd{open(path.c_str(), O_RDWR | O_CREAT | O_EXCL | O_NOFOLLOW | O_CLOEXEC, 0666)};
+    if (fd == -1 && errno == EEXIST) {
+        created = false;
+        fd = open(path.c_str(), O_RDWR | O_NOFOLLOW | O_CLOEXEC);
+    }
+    if (fd == -1) {
+        return -1;
+    }
+
+    struct stat st{};
+    if (fstat(fd, &st) != 0 || !S_ISREG(st.st_mode) || st.st_nlink != 1 ||
+        (created && st.st_uid != geteuid())) {
+        close(fd);
+        errno = EPERM;
+        return -1;
+    }
+    if (created) {
+        fchmod(fd, 0666);
+    }
+    return fd;
+}
+
+/**
+ * @brief Take (or convert to) a whole-file OFD lock. Unlike flock(2), fcntl conversions between
+ * shared and exclusive are atomic.
+ */
+inline bool lockFile(int fd, short type, bool wait) {
+    struct flock lock{};
+    lock.l_type = type;
+    lock.l_whence = SEEK_SET;
+    int result{};
+    do {
+        result = fcntl(fd, wait ? F_OFD_SETLKW : F_OFD_SETLK, &lock);
+    } while (result == -1 && errno == EINTR);
+    return result == 0;
+}
+
+/**
+ * @brief Whether any other open file description holds a lock on the file.
+ */
+inline bool lockedByOthers(int fd) {
+    struct flock lock{};
+    lock.l_type = F_WRLCK;
+    lock.l_whence = SEEK_SET;
+    return fcntl(fd, F_OFD_GETLK, &lock) == 0 && lock.l_type != F_UNLCK;
+}
+
+/**
+ * @brief CPUs the calling process may run on.
+ */
+inline std::vector<int> allowedCpus() {
+    std::vector<int> cpus{};
+    cpu_set_t set{};
+    if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+        for (int cpu{0}; cpu < CPU_SETSIZE; ++cpu) {
+            if (CPU_ISSET(cpu, &set)) {
+                cpus.push_back(cpu);
+            }
+        }
+    }
+    return cpus;
+}
+
+#endif
+
+/**
+ * @brief Cooperative reservation of a set of CPUs via open file description locks on one lock
+ * file per CPU. Locks are always taken in ascending CPU order so two waiting instances can't
+ * deadlock.
+ *
+ * Nothing is written to the lock files: a sharer checks for other holders when it takes the lock,
+ * after every iteration and again at release time.
+ */
+class Reservation {
+  private:
+    Policy policy{Policy::None};
+    std::vector<int> fds{};
+    std::vector<int> cpus{};
+    std::vector<char> shared{};
+    int contended{0};
+
+    void releaseAll() {
+#ifdef __linux__
+        for (int fd : fds) {
+            // Closing the descriptor drops its OFD lock
+            close(fd);
+        }
+#endif
+        fds.clear();
+        shared.clear();
+    }
+
+    /**
+     * @brief The lock files can't be used. Advisory sharing is not worth failing a run over, so
+     * 'share' carries on unreserved; 'wait' and 'fail' asked for a guarantee and stop.
+     * @return Whether the run may go ahead.
+     */
+    bool unavailable(const std::string& message) {
+        releaseAll();
+        if (policy != Policy::Share) {
+            std::cerr << Colors::BrightRed << "Error: " << Colors::Reset << message << "\n";
+            return false;
+        }
+        std::cerr << Colors::BrightYellow << "Note: " << Colors::Reset << message
+                  << "; running without a CPU reservation\n";
+        policy = Policy::None;
+        cpus.clear();
+        return true;
+    }
+
+  public:
+    Reservation() = default;
+    Reservation(const Reservation&) = delete;
+    Reservation& operator=(const Reservation&) = delete;
+
+    ~Reservation() {
+        releaseAll();
+    }
+
+    /**
+     * @brief Reserve the CPUs according to the policy.
+     * @return False only when the policy is 'fail' and a CPU is busy, or on a lock file error
+     * under 'wait' or 'fail'.
+     */
+    bool acquire(Policy reservePolicy, const std::vector<int>& reserveCpus) {
+        policy = reservePolicy;
+        cpus = reserveCpus;
+        contended = 0;
+
+#ifdef __linux__
+        if (policy == Policy::None) {
+            return true;
+        }
+
+        const std::string dir{lockDirectory()};
+        if (dir.empty()) {
+            return unavailable("No safe lock directory (set VAJRA_LOCK_DIR)");
+        }
+
+        const short type{policy == Policy::Share ? short{F_RDLCK} : short{F_WRLCK}};
+        for (int cpu : cpus) {
+            const std::string path{dir + "/cpu" + std::to_string(cpu) + ".lock"};
+            int fd{openLockFile(path)};
+            if (fd == -1) {
+                return unavailable("Cannot open lock file '" + path +
+                                   "': " + std::strerror(errno));
+            }
+            fds.push_back(fd);
+            shared.push_back(0);
+
+            if (lockFile(fd, type, false)) {
+                if (policy == Policy::Share && lockedByOthers(fd)) {
+                    shared.back() = 1;
+                }
+                continue;
+            }
+
+            if (policy == Policy::Fail) {
+                std::cerr << Colors::BrightRed << "Error: " << Colors::Reset << "CPU " << cpu
+                          << " is reserved by another vajra process\n";
+                std::cerr << Colors::Dim << "Use --reserve wait to queue behind it."
+                          << Colors::Reset << "\n";
+                releaseAll();
+                return false;
+            }
+
+            // Either waiting our turn, or sharing and blocked by an exclusive holder
+            std::cerr << Colors::BrightYellow << "Note: " << Colors::Reset
+                      << "waiting for another vajra process to release CPU " << cpu << "\n";
+            if (policy == Policy::Share) {
+                shared.back() = 1;
+            }
+            if (!lockFile(fd, type, true)) {
+                return unavailable("Cannot lock '" + path + "': " + std::strerror(errno));
+            }
+        }
+#endif
+        return true;
+    }
+
+    /**
+     * @brief Note any CPU another process is sharing right now. One fcntl per CPU; call it between
+     * iterations, outside the timed region.
+     */
+    void check() {
+#ifdef __linux__
+        if (policy != Policy::Share) {
+            return;
+        }
+        for (size_t i{0}; i < fds.size(); ++i) {
+            if (!shared[i] && lockedByOthers(fds[i])) {
+                shared[i] = 1;
+            }
+        }
+#endif
+    }
+
+    /**
+     * @brief Release the reservation, counting CPUs another process shared at any point.
+     */
+    void release() {
+        check();
+        contended = static_cast<int>(std::count(shared.begin(), shared.end(), char{1}));
+        releaseAll();
+    }
+
+    Policy getPolicy() const {
+        return policy;
+    }
+
+    int getCpuCount() const {
+        return static_cast<int>(cpus.size());
+    }
+
+    int getContended() const {
+        return contended;
+    }
+};
+
+} // namespace Reserve
+
+#endif
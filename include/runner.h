@@ -0,0 +1,865 @@
+#ifndef RUNNER_H
+#define RUNNER_H
+
+#include "argparser.h"
+#include "cache.h"
+#include "collector.h"
+#include "exec.h"
+#include "journal.h"
+#include "livestats.h"
+#include "numa.h"
+#include "priority.h"
+#include "procstat.h"
+#include "reserve.h"
+#include "vajra.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <csignal>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#ifdef _WIN32
+#ifndef NOMINMAX
+#define NOMINMAX
+#endif
+
+#include <io.h>
+#include <windows.h>
+#endif
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+/**
+ * @brief Set from the SIGINT handler; the benchmark loop stops at the next sample boundary.
+ */
+inline volatile std::sig_atomic_t interruptRequested{0};
+
+struct RunResult {
+    int exitCode{-1};
+    int signal{0};      // what killed the child, if it didn't exit
+    uint64_t wallNs{0}; // spawn to exit, taken before any /proc reads or collector hooks
+    ProcStat::SchedStats sched{};
+    ProcStat::IoStats io{};
+    ProcStat::Usage usage{};
+    Collector::Values metrics{};
+};
+
+struct BenchmarkConfig {
+    std::string command{};
+    std::vector<std::string> cmdArgs{};
+    bool useShell{false};
+    bool quiet{false};
+    int warmup{5};
+    int iterations{100};
+    int cpu{-1};
+    std::string prepare{};
+    Reserve::Policy reserve{Reserve::Policy::Share};
+    Priority::Settings priority{};
+    Numa::Placement placement{};
+    std::shared_ptr<const Exec::Image> image{};
+    std::shared_ptr<Journal::Writer> journal{};
+    std::vector<Journal::Sample> resumed{};
+    std::shared_ptr<LiveStats::Publisher> live{};
+    std::shared_ptr<const Collector::Set> collectors{};
+    std::shared_ptr<const Cache::Policy> cache{};
+    std::string outputSize{}; // file whose size each run produces, or "-" for stdout
+    int stdoutFd{-1};         // where the child's stdout goes instead of /dev/null
+    double workBytes{0};      // declared work per run, for throughput
+    double workItems{0};
+    int cpuLimitSeconds{0};   // RLIMIT_CPU for the child, 0 for none
+    std::string workDir{};    // where the child runs, if not vajra's own directory
+    std::vector<std::string> env{}; // the child's environment without an image, if not vajra's
+};
+
+inline RunResult executeCommand(const BenchmarkConfig& config) {
+    RunResult result{};
+    const std::vector<std::string>& args{config.cmdArgs};
+    Timer::Timer timer{};
+
+#ifdef _WIN32
+    std::string cmdLine;
+    for (size_t i{0}; i < args.size(); ++i) {
+        if (i > 0)
+            cmdLine += " ";
+        if (args[i].find(' ') != std::string::npos) {
+            cmdLine += "\"" + args[i] + "\"";
+        } else {
+            cmdLine += args[i];
+        }
+    }
+
+    STARTUPINFOA si{};
+    PROCESS_INFORMATION pi{};
+    si.cb = sizeof(si);
+    si.dwFlags = STARTF_USESTDHANDLES;
+
+    HANDLE hNul{
+        CreateFileA("NUL", GENERIC_WRITE, FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, 0, nullptr)};
+    if (hNul != INVALID_HANDLE_VALUE) {
+        si.hStdOutput = hNul;
+        si.hStdError = hNul;
+    }
+
+    timer.start();
+    BOOL success{CreateProcessA(nullptr, const_cast<char*>(cmdLine.c_str()), nullptr, nullptr, TRUE,
+                                CREATE_NO_WINDOW, nullptr, nullptr, &si, &pi)};
+
+    if (hNul != INVALID_HANDLE_VALUE) {
+        CloseHandle(hNul);
+    }
+
+    if (!success) {
+        return result;
+    }
+
+    WaitForSingleObject(pi.hProcess, INFINITE);
+    timer.stop();
+    result.wallNs = timer.elapsedNanoseconds();
+
+    DWORD exitCode{0};
+    GetExitCodeProcess(pi.hProcess, &exitCode);
+
+    CloseHandle(pi.hProcess);
+    CloseHandle(pi.hThread);
+
+    result.exitCode = static_cast<int>(exitCode);
+    return result;
+#else
+    if (config.collectors) {
+        config.collectors->beforeSpawn();
+    }
+
+    // Built before fork: the child of a multithreaded daemon must not allocate
+    std::vector<char*> envp{};
+    for (const auto& var : config.env) {
+        envp.push_back(const_cast<char*>(var.c_str()));
+    }
+    envp.push_back(nullptr);
+
+    timer.start();
+    pid_t pid{fork()};
+
+    if (pid == -1) {
+        return result;
+    } else if (pid == 0) {
+        if (config.priority.any() && Priority::apply(config.priority) != 0) {
+            _exit(126);
+        }
+
+        if (config.placement.any() && Numa::apply(config.placement) != 0) {
+            _exit(126);
+        }
+
+#ifdef __linux__
+        if (config.cpu >= 0) {
+            cpu_set_t cpus{};
+            CPU_ZERO(&cpus);
+            CPU_SET(config.cpu, &cpus);
+            sched_setaffinity(0, sizeof(cpus), &cpus);
+        }
+#endif
+
+        if (config.cpuLimitSeconds > 0) {
+            // Soft limit sends SIGXCPU, the hard one a second later SIGKILL
+            const rlimit limit{static_cast<rlim_t>(config.cpuLimitSeconds),
+                               static_cast<rlim_t>(config.cpuLimitSeconds + 1)};
+            setrlimit(RLIMIT_CPU, &limit);
+        }
+
+        if (config.collectors) {
+            config.collectors->inChild();
+        }
+
+        if (!config.workDir.empty() && chdir(config.workDir.c_str()) != 0) {
+            _exit(126);
+        }
+        if (!config.env.empty()) {
+            environ = envp.data();
+        }
+
+        int devNull{open("/dev/null", O_WRONLY)};
+        if (devNull != -1) {
+            dup2(devNull, STDOUT_FILENO);
+            dup2(devNull, STDERR_FILENO);
+            close(devNull);
+        }
+        if (config.stdoutFd != -1) {
+            dup2(config.stdoutFd, STDOUT_FILENO);
+        }
+
+#ifdef __linux__
+        if (config.image) {
+            Exec::exec(*config.image);
+            _exit(127);
+        }
+#endif
+
+        std::vector<char*> argv;
+        argv.reserve(args.size() + 1);
+
+        for (const auto& arg : args) {
+            argv.push_back(const_cast<char*>(arg.c_str()));
+        }
+
+        argv.push_back(nullptr);
+
+        execvp(argv[0], argv.data());
+        _exit(127);
+    } else {
+#ifdef __linux__
+#ifdef SYS_pidfd_open
+        if (config.collectors && config.collectors->period().count() > 0) {
+            // Wake every period while the child runs; a pidfd becomes readable when it exits
+            int pidfd{static_cast<int>(syscall(SYS_pidfd_open, pid, 0))};
+            if (pidfd != -1) {
+                pollfd exited{pidfd, POLLIN, 0};
+                const int timeout{static_cast<int>(config.collectors->period().count())};
+                while (poll(&exited, 1, timeout) == 0) {
+                    config.collectors->periodic(pid);
+                }
+                close(pidfd);
+            }
+        }
+#endif
+
+        // Leave the child a zombie until its /proc accounting has been read
+        siginfo_t info{};
+        const int waited{waitid(P_PID, static_cast<id_t>(pid), &info, WEXITED | WNOWAIT)};
+        timer.stop();
+        result.wallNs = timer.elapsedNanoseconds();
+        if (waited == 0) {
+            result.sched = ProcStat::readSchedStats(pid);
+            result.io = ProcStat::readIoStats(pid);
+            if (config.collectors) {
+                result.metrics = config.collectors->afterExit(pid);
+            }
+        }
+#endif
+
+        int status;
+        rusage usage{};
+
+        if (wait4(pid, &status, 0, &usage) == pid) {
+            result.usage = ProcStat::fromRusage(usage);
+        }
+#ifndef __linux__
+        timer.stop();
+        result.wallNs = timer.elapsedNanoseconds();
+#endif
+
+        result.exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+        result.signal = WIFSIGNALED(status) ? WTERMSIG(status) : 0;
+        return result;
+    }
+#endif
+}
+
+/**
+ * @brief Parse a work amount like "512", "64K" or "1.5M". Byte amounts use binary multiples
+ * (K = 1024), item counts decimal ones (K = 1000).
+ */
+inline bool parseAmount(const std::string& text, bool binary, double& amount) {
+    if (text.empty()) {
+        return false;
+    }
+    char* end{nullptr};
+    const double value{std::strtod(text.c_str(), &end)};
+    if (end == text.c_str() || !(value > 0)) {
+        return false;
+    }
+
+    const std::string suffix{end};
+    const double unit{binary ? 1024.0 : 1000.0};
+    if (suffix.empty()) {
+        amount = value;
+    } else if (suffix == "K" || suffix == "k") {
+        amount = value * unit;
+    } else if (suffix == "M") {
+        amount = value * unit * unit;
+    } else if (suffix == "G") {
+        amount = value * unit * unit * unit;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Size of a file in bytes, for --bytes-from and the suite's bytes_from key.
+ */
+inline bool fileBytes(const std::string& path, double& bytes) {
+    std::error_code ec{};
+    const auto size{std::filesystem::file_size(path, ec)};
+    if (ec) {
+        return false;
+    }
+    bytes = static_cast<double>(size);
+    return true;
+}
+
+inline std::vector<std::string> parseCommand(const std::string& command) {
+    std::vector<std::string> args;
+    std::string current;
+    bool inQuote{false};
+
+    for (size_t i{0}; i < command.size(); ++i) {
+        char c{command[i]};
+
+        if (c == '"' || c == '\'') {
+            inQuote = !inQuote;
+        } else if (c == ' ' && !inQuote) {
+            if (!current.empty()) {
+                args.push_back(current);
+                current.clear();
+            }
+        } else {
+            current += c;
+        }
+    }
+
+    if (!current.empty()) {
+        args.push_back(current);
+    }
+
+    return args;
+}
+
+inline void runPrepare(const BenchmarkConfig& config) {
+    if (config.prepare.empty()) {
+        return;
+    }
+
+    BenchmarkConfig hook{};
+#ifdef _WIN32
+    hook.cmdArgs = {"cmd", "/c", config.prepare};
+#else
+    hook.cmdArgs = {"/bin/sh", "-c", config.prepare};
+#endif
+    hook.cpu = config.cpu;
+    hook.workDir = config.workDir;
+    hook.env = config.env;
+    executeCommand(hook);
+}
+
+inline RunResult runOnce(const BenchmarkConfig& config) {
+    if (config.useShell) {
+        RunResult result{};
+        Timer::Timer timer{};
+        timer.start();
+        const int status{std::system(config.command.c_str())};
+        timer.stop();
+        result.wallNs = timer.elapsedNanoseconds();
+#ifdef _WIN32
+        result.exitCode = status;
+#else
+        if (status != -1) {
+            result.exitCode = WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+            result.signal = WIFSIGNALED(status) ? WTERMSIG(status) : 0;
+        }
+        // std::system ignores SIGINT in the caller, so notice it through the shell's status
+        if (result.signal == SIGINT) {
+            interruptRequested = 1;
+        }
+#endif
+        return result;
+    }
+
+    return executeCommand(config);
+}
+
+/**
+ * @brief Measures what each run produced for --output-size: the size of a file the command writes,
+ * or for "-" its stdout, captured in an unlinked temporary file instead of /dev/null.
+ */
+class OutputMeter {
+  private:
+    std::string path{};
+    int fd{-1};
+
+  public:
+    OutputMeter() = default;
+    OutputMeter(const OutputMeter&) = delete;
+    OutputMeter& operator=(const OutputMeter&) = delete;
+
+    ~OutputMeter() {
+#ifndef _WIN32
+        if (fd != -1) {
+            close(fd);
+        }
+#endif
+    }
+
+    bool open(const std::string& target) {
+        path = target;
+        if (path != "-") {
+            return true;
+        }
+#ifdef _WIN32
+        return false;
+#else
+        const char* tmp{std::getenv("TMPDIR")};
+        std::string name{std::string{tmp && *tmp ? tmp : "/tmp"} + "/vajra-output-XXXXXX"};
+        fd = mkstemp(name.data());
+        if (fd == -1) {
+            return false;
+        }
+        unlink(name.c_str());
+        return true;
+#endif
+    }
+
+    int stdoutFd() const {
+        return fd;
+    }
+
+    /**
+     * @brief Empty the stdout capture before the next run. Output files are left alone; the
+     * command is expected to overwrite them.
+     */
+    void reset() const {
+#ifndef _WIN32
+        if (fd != -1 && ftruncate(fd, 0) == 0) {
+            lseek(fd, 0, SEEK_SET);
+        }
+#endif
+    }
+
+    /**
+     * @return Bytes produced by the last run, or -1 if nothing was there to measure.
+     */
+    int64_t measure() const {
+#ifndef _WIN32
+        struct stat st{};
+        if (fd != -1 ? fstat(fd, &st) == 0 : stat(path.c_str(), &st) == 0) {
+            return static_cast<int64_t>(st.st_size);
+        }
+        return -1;
+#else
+        std::ifstream file{path, std::ios::binary | std::ios::ate};
+        return file ? static_cast<int64_t>(file.tellg()) : -1;
+#endif
+    }
+};
+
+/**
+ * @brief CPUs a benchmark's children will run on, which is what gets reserved.
+ */
+inline std::vector<int> benchmarkCpus(const BenchmarkConfig& config) {
+    if (config.cpu >= 0) {
+        return {config.cpu};
+    }
+#ifdef __linux__
+    if (config.placement.cpuNode >= 0) {
+        return Numa::nodeCpus(config.placement.cpuNode);
+    }
+    return Reserve::allowedCpus();
+#else
+    return {};
+#endif
+}
+
+/**
+ * @brief Lay the collected samples out as columns: wall, scheduler, I/O, wait4() usage, output
+ * size and collector metrics (prefixed "metric:"), one row per run. Timestamps are relative to
+ * the first run, whose wall-clock start is kept as start_epoch_ns metadata.
+ */
+inline Samples::SampleSet toSampleSet(const std::vector<Journal::Sample>& samples) {
+    Samples::SampleSet set{};
+    const size_t wall{set.define<uint64_t>(Samples::WallNs)};
+    set.reserve(samples.size());
+
+    uint64_t origin{0};
+    for (const auto& sample : samples) {
+        if (sample.startNs > 0 && (origin == 0 || sample.startNs < origin)) {
+            origin = sample.startNs;
+        }
+    }
+    if (origin > 0) {
+        set.metadata["start_epoch_ns"] = std::to_string(origin);
+    }
+
+    auto integer{[&](const char* name, uint64_t value) {
+        set.set(set.define<uint64_t>(name), value);
+    }};
+    for (const auto& sample : samples) {
+        set.addRow();
+        set.set(wall, sample.wallNs);
+        if (sample.startNs > 0) {
+            integer(Samples::TimestampNs, sample.startNs - origin);
+        }
+        if (sample.sched.valid) {
+            integer("run_delay_ns", sample.sched.runDelayNs);
+            integer("switches", sample.sched.nrSwitches);
+            integer("migrations", sample.sched.nrMigrations);
+        }
+        if (sample.io.valid) {
+            integer("rchar_bytes", sample.io.rchar);
+            integer("wchar_bytes", sample.io.wchar);
+            integer("syscr", sample.io.syscr);
+            integer("syscw", sample.io.syscw);
+            integer("read_bytes", sample.io.readBytes);
+            integer("write_bytes", sample.io.writeBytes);
+        }
+        if (sample.usage.valid) {
+            integer(Samples::CpuNs, sample.usage.userNs + sample.usage.systemNs);
+            integer("user_ns", sample.usage.userNs);
+            integer("system_ns", sample.usage.systemNs);
+            integer(Samples::MaxRssBytes, sample.usage.maxRssBytes);
+        }
+        if (sample.outputBytes >= 0) {
+            integer("output_bytes", static_cast<uint64_t>(sample.outputBytes));
+        }
+        for (const auto& [name, value] : sample.metrics) {
+            set.set(set.define("metric:" + name), value);
+        }
+    }
+    return set;
+}
+
+/**
+ * @brief Fold the collected samples into results; shared by complete, resumed and interrupted runs.
+ * Times stay integer nanoseconds in the sample set and are converted to ms only here, for display.
+ */
+inline void summarize(const std::vector<Journal::Sample>& samples, BenchmarkResults& results) {
+    results.samples = toSampleSet(samples);
+    const Samples::SampleSet& set{results.samples};
+
+    // Columns some runs lack (e.g. resumed from an older journal) are skipped where missing
+    std::vector<uint64_t> scratch{};
+    auto column{[&](const char* name) {
+        return Samples::present(set.column<uint64_t>(name), scratch);
+    }};
+    auto inMs{[](double ns) { return ns / 1e6; }};
+
+    const auto wall{results.wallNs()};
+    results.mean = results.toMs(Statistics::mean(wall));
+    results.stdDev = results.toMs(Statistics::stddev(wall));
+    results.min = results.toMs(static_cast<double>(Statistics::min(wall)));
+    results.max = results.toMs(static_cast<double>(Statistics::max(wall)));
+    results.iterations = static_cast<int>(set.rows());
+
+    if (set.has("run_delay_ns")) {
+        const auto delays{column("run_delay_ns")};
+        results.hasSched = true;
+        results.runDelayMean = inMs(Statistics::mean(delays));
+        results.runDelayStdDev = inMs(Statistics::stddev(delays));
+        results.runDelayMin = inMs(static_cast<double>(Statistics::min(delays)));
+        results.runDelayMax = inMs(static_cast<double>(Statistics::max(delays)));
+        results.switchesPerRun = Statistics::mean(column("switches"));
+        results.migrationsPerRun = Statistics::mean(column("migrations"));
+    }
+
+    if (set.has("rchar_bytes")) {
+        results.hasIo = true;
+        results.rcharPerRun = Statistics::mean(column("rchar_bytes"));
+        results.wcharPerRun = Statistics::mean(column("wchar_bytes"));
+        results.syscrPerRun = Statistics::mean(column("syscr"));
+        results.syscwPerRun = Statistics::mean(column("syscw"));
+        results.readBytesPerRun = Statistics::mean(column("read_bytes"));
+        results.writeBytesPerRun = Statistics::mean(column("write_bytes"));
+    }
+
+    if (set.has(Samples::CpuNs)) {
+        const auto cpu{column(Samples::CpuNs)};
+        results.hasUsage = true;
+        results.cpuMean = inMs(Statistics::mean(cpu));
+        results.cpuStdDev = inMs(Statistics::stddev(cpu));
+        results.userCpuMean = inMs(Statistics::mean(column("user_ns")));
+        results.systemCpuMean = inMs(Statistics::mean(column("system_ns")));
+        const auto rss{column(Samples::MaxRssBytes)};
+        results.peakRssMean = Statistics::mean(rss);
+        results.peakRssMax = static_cast<double>(Statistics::max(rss));
+    }
+
+    if (set.has("output_bytes")) {
+        const auto outputs{column("output_bytes")};
+        results.hasOutput = true;
+        results.outputBytesMean = Statistics::mean(outputs);
+        results.outputBytesMin = static_cast<double>(Statistics::min(outputs));
+        results.outputBytesMax = static_cast<double>(Statistics::max(outputs));
+    }
+
+    // Collector metrics, in the order they first appeared
+    std::vector<double> metricScratch{};
+    for (const auto& name : set.columnNames()) {
+        if (name.rfind("metric:", 0) != 0) {
+            continue;
+        }
+        const auto values{Samples::present(set.column(name), metricScratch)};
+        results.metrics.push_back({name.substr(7), Statistics::mean(values),
+                                   Statistics::stddev(values), Statistics::min(values),
+                                   Statistics::max(values), static_cast<int>(values.size())});
+    }
+}
+
+/**
+ * @brief Everything a stored result depends on: the binary and the libraries it loads, the
+ * arguments and any files they name, declared inputs, the environment that matters, the machine,
+ * and how vajra was asked to measure.
+ */
+inline Cache::Key cacheKey(const BenchmarkConfig& config) {
+    Cache::Key key{};
+    key.add("format", "1");
+
+    std::vector<std::string> words{config.cmdArgs};
+    if (config.useShell) {
+        std::istringstream split{config.command};
+        words.assign(std::istream_iterator<std::string>{split}, {});
+    }
+
+    std::string executable{config.image ? config.image->path : std::string{}};
+#ifdef __linux__
+    if (executable.empty() && !words.empty()) {
+        executable = Exec::resolve(words[0], std::getenv("PATH"));
+    }
+#endif
+    std::string digest{};
+    if (!executable.empty() && Cache::hashFile(executable, digest)) {
+        key.add("exe:" + executable, digest);
+        for (const auto& library : Cache::sharedLibraries(executable)) {
+            if (Cache::hashFile(library, digest)) {
+                key.add("lib:" + library, digest);
+            }
+        }
+    }
+
+    key.add("command", config.command);
+    key.add("shell", config.useShell ? "yes" : "no");
+    for (size_t i{1}; i < words.size(); ++i) {
+        if (Cache::isRegularFile(words[i]) && Cache::hashFile(words[i], digest)) {
+            key.add("file:" + words[i], digest);
+        }
+    }
+    for (const auto& input : config.cache->inputs) {
+        Cache::addInput(key, input);
+    }
+
+    for (const auto& list : {Cache::DefaultEnv, config.cache->env}) {
+        for (const auto& name : list) {
+            const char* value{std::getenv(name.c_str())};
+            key.add("env:" + name, value ? value : "(unset)");
+        }
+    }
+
+    key.add("machine", Cache::machineFingerprint());
+
+    std::ostringstream settings{};
+    settings << "warmup=" << config.warmup << " iterations=" << config.iterations
+             << " cpu=" << config.cpu << " prepare=" << config.prepare
+             << " output-size=" << config.outputSize
+             << " reserve=" << Reserve::policyName(config.reserve)
+             << " priority=" << Priority::describe(config.priority)
+             << " placement=" << Numa::describe(config.placement)
+             << " exec=" << (config.image ? Exec::modeName(config.image->mode) : "");
+    key.add("settings", settings.str());
+    return key;
+}
+
+inline BenchmarkResults runBenchmark(const BenchmarkConfig& config) {
+    // Journals and collectors are about this particular run, so they always measure afresh
+    const bool cacheable{config.cache && !config.journal && !config.collectors};
+    Cache::Key key{};
+    if (cacheable) {
+        key = cacheKey(config);
+        BenchmarkResults cached{};
+        if (!config.cache->force && Cache::load(key, config.cache->maxAgeSeconds, cached)) {
+            if (!config.quiet) {
+                std::cout << Colors::BrightCyan << "Reusing cached result: " << Colors::BrightYellow
+                          << config.command << Colors::Reset << "\n";
+            }
+            cached.numaNode = config.placement.cpuNode;
+            cached.bytesPerRun = config.workBytes;
+            cached.itemsPerRun = config.workItems;
+            return cached;
+        }
+    }
+
+    const int resumed{static_cast<int>(config.resumed.size())};
+    const int iterations{std::max(0, config.iterations - resumed)};
+    const int warmup{iterations > 0 ? config.warmup : 0};
+
+    Reserve::Reservation reservation{};
+    if (!reservation.acquire(config.reserve, benchmarkCpus(config))) {
+        BenchmarkResults failed{};
+        failed.command = config.command;
+        failed.reservationFailed = true;
+        return failed;
+    }
+
+    if (!config.quiet) {
+        std::cout << Colors::BrightCyan << "Running benchmark: " << Colors::BrightYellow
+                  << config.command << Colors::Reset << "\n";
+        std::cout << Colors::White << "Warmup: " << warmup << " | Iterations: " << iterations;
+        if (resumed > 0) {
+            std::cout << " (resuming after " << resumed << ")";
+        }
+        if (config.priority.any() || config.priority.lockMemory) {
+            std::cout << " | " << Priority::describe(config.priority);
+        }
+        if (config.placement.any()) {
+            std::cout << " | " << Numa::describe(config.placement);
+        }
+        if (config.image) {
+            std::cout << " | exec " << Exec::modeName(config.image->mode);
+        }
+        if (!config.prepare.empty()) {
+            std::cout << " | prepare: " << config.prepare;
+        }
+        std::cout << Colors::Reset << "\n\n";
+    }
+
+    OutputMeter meter{};
+    const bool measureOutput{!config.outputSize.empty() && meter.open(config.outputSize)};
+    BenchmarkConfig capturing{};
+    if (meter.stdoutFd() != -1) {
+        capturing = config;
+        capturing.resumed.clear();
+        capturing.stdoutFd = meter.stdoutFd();
+    }
+    const BenchmarkConfig& target{meter.stdoutFd() != -1 ? capturing : config};
+
+    int totalRuns{warmup + iterations};
+    ProgressBar progressBar(totalRuns);
+    int currentRun{0};
+
+    if (config.live) {
+        config.live->start(static_cast<uint64_t>(warmup),
+                           static_cast<uint64_t>(config.iterations));
+        for (const auto& sample : config.resumed) {
+            config.live->add(sample.wallNs);
+        }
+    }
+
+    if (warmup > 0) {
+        if (!config.quiet) {
+            std::cout << Colors::BrightMagenta << "Warming up..." << Colors::Reset << "\n";
+        }
+        for (int i{0}; i < warmup && !interruptRequested; ++i) {
+            runPrepare(config);
+            runOnce(target);
+            if (config.live) {
+                config.live->warmupStep();
+            }
+            if (!config.quiet) {
+                progressBar.update(++currentRun);
+            }
+        }
+        if (!config.quiet) {
+            std::cout << "\n";
+        }
+    }
+
+    if (!config.quiet) {
+        std::cout << Colors::BrightGreen << "Benchmarking..." << Colors::Reset << "\n";
+    }
+    std::vector<Journal::Sample> samples{config.resumed};
+    samples.reserve(static_cast<size_t>(resumed + iterations));
+    int failedRuns{0};
+    RunResult firstFailure{};
+
+    for (int i{0}; i < iterations && !interruptRequested; ++i) {
+        runPrepare(config);
+        meter.reset();
+        const auto startedAt{std::chrono::system_clock::now()};
+        RunResult run{runOnce(target)};
+        if (interruptRequested) {
+            // Ctrl-C reaches the child too, so this sample timed a killed process
+            break;
+        }
+        if (run.exitCode != 0 || run.signal != 0) {
+            if (failedRuns++ == 0) {
+                firstFailure = run;
+            }
+        }
+        const auto startNs{
+            std::chrono::duration_cast<std::chrono::nanoseconds>(startedAt.time_since_epoch())};
+        samples.push_back({run.wallNs, run.sched, run.io,
+                           std::move(run.metrics), run.usage,
+                           measureOutput ? meter.measure() : -1,
+                           static_cast<uint64_t>(startNs.count())});
+        if (config.journal) {
+            config.journal->append(samples.back());
+        }
+        if (config.live) {
+            config.live->add(samples.back().wallNs);
+        }
+        reservation.check();
+        if (!config.quiet) {
+            progressBar.update(++currentRun);
+        }
+    }
+    reservation.release();
+    if (config.journal) {
+        config.journal->sync();
+    }
+    if (config.live) {
+        config.live->finish(interruptRequested != 0);
+    }
+
+    if (!config.quiet) {
+        if (interruptRequested) {
+            std::cout << "\n\n";
+        } else {
+            progressBar.finish();
+            progressBar.clear();
+
+            int linesToClear{warmup > 0 ? 8 : 6};
+            for (int i{0}; i < linesToClear; ++i) {
+                std::cout << "\033[F\033[K";
+            }
+        }
+    }
+
+    BenchmarkResults results{};
+    results.command = config.command;
+    summarize(samples, results);
+    results.plannedIterations = config.iterations;
+    results.resumedIterations = resumed;
+    results.bytesPerRun = config.workBytes;
+    results.itemsPerRun = config.workItems;
+    results.interrupted = interruptRequested != 0;
+    results.failedRuns = failedRuns;
+    results.failureExit = firstFailure.exitCode;
+    results.failureSignal = firstFailure.signal;
+    results.numaNode = config.placement.cpuNode;
+    if (config.useShell) {
+        results.execMode = "shell";
+    } else if (config.image) {
+        results.execMode = Exec::modeName(config.image->mode);
+    }
+    if (reservation.getPolicy() != Reserve::Policy::None) {
+        results.reservation = Reserve::policyName(reservation.getPolicy());
+        results.reservedCpus = reservation.getCpuCount();
+        results.contendedCpus = reservation.getContended();
+    }
+
+    if (cacheable && !results.interrupted && !results.failed() && results.iterations > 0) {
+        Cache::store(key, results);
+        results.cacheKey = key.digest();
+    }
+
+    return results;
+}
+
+#endif
@@ -0,0 +1,374 @@
+#ifndef SLO_H
+#define SLO_H
+
+#include "argparser.h"
+#include "vajra.hpp"
+
+#include <cctype>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <limits>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace Slo {
+
+/**
+ * @brief Exit codes of a run with --assert; 1 stays "could not run", 130 "interrupted".
+ */
+constexpr int ExitFailed{2};
+constexpr int ExitInconclusive{3};
+
+enum class Kind { Time, Bytes, ByteRate, ItemRate };
+
+/**
+ * @brief One --assert, e.g. "p99<20ms": the metric, which side of the limit it must stay on, and
+ * the limit in the metric's base unit (ms, bytes, bytes/s or items/s).
+ */
+struct Assertion {
+    std::string text{};
+    std::string metric{};
+    double percentile{-1}; // for pNN and median
+    Kind kind{Kind::Time};
+    bool below{true};
+    bool inclusive{false};
+    double limit{0};
+};
+
+enum class Verdict { Pass, Fail, Inconclusive };
+
+struct Check {
+    Assertion assertion{};
+    Verdict verdict{Verdict::Inconclusive};
+    bool measured{false};
+    double estimate{0};
+    double bound{0}; // the 95% bound on the side the limit is on
+    std::string note{};
+};
+
+inline void printError(const std::string& message) {
+    std::cerr << Colors::BrightRed << "Error: " << Colors::Reset << message << "\n";
+}
+
+/**
+ * @brief Scale a number by its unit: ns/us/ms/s for times (default ms), B/K/M/G (binary, "B" and
+ * "/s" optional) for sizes and byte rates, K/M/G (decimal) for item rates.
+ */
+inline bool parseLimit(const std::string& text, Kind kind, double& limit) {
+    char* end{nullptr};
+    const double value{std::strtod(text.c_str(), &end)};
+    if (end == text.c_str() || !std::isfinite(value) || value < 0) {
+        return false;
+    }
+
+    std::string unit{end};
+    if ((kind == Kind::ByteRate || kind == Kind::ItemRate) && unit.size() >= 2 &&
+        unit.compare(unit.size() - 2, 2, "/s") == 0) {
+        unit.resize(unit.size() - 2);
+    }
+
+    if (kind == Kind::Time) {
+        const std::vector<std::pair<std::string, double>> units{
+            {"", 1.0}, {"ms", 1.0}, {"ns", 1e-6}, {"us", 1e-3}, {"μs", 1e-3}, {"s", 1e3}};
+        for (const auto& [name, scale] : units) {
+            if (unit == name) {
+                limit = value * scale;
+                return true;
+            }
+        }
+        return false;
+    }
+
+    const double step{kind == Kind::ItemRate ? 1000.0 : 1024.0};
+    if (kind != Kind::ItemRate && !unit.empty() && unit.back() == 'B') {
+        unit.pop_back();
+    }
+    if (unit.empty()) {
+        limit = value;
+    } else if (unit == "K" || unit == "k") {
+        limit = value * step;
+    } else if (unit == "M") {
+        limit = value * step * step;
+    } else if (unit == "G") {
+        limit = value * step * step * step;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Parse "<metric><op><limit>", op one of < <= > >=. Metrics: mean, median, pNN (p99,
+ * p99.9, ...), max, cpu, rss, output, throughput, items.
+ */
+inline bool parse(const std::string& text, Assertion& assertion) {
+    const size_t op{text.find_first_of("<>")};
+    if (op == std::string::npos || op == 0) {
+        printError("--assert expects <metric><op><limit>, e.g. \"p99<20ms\" (got '" + text + "')");
+        return false;
+    }
+
+    assertion.text = text;
+    assertion.metric = text.substr(0, op);
+    assertion.below = text[op] == '<';
+    assertion.inclusive = op + 1 < text.size() && text[op + 1] == '=';
+    const std::string limit{text.substr(op + (assertion.inclusive ? 2 : 1))};
+
+    const std::string& m{assertion.metric};
+    if (m == "median") {
+        assertion.percentile = 50.0;
+    } else if (m.size() > 1 && m[0] == 'p' && std::isdigit(static_cast<unsigned char>(m[1]))) {
+        // p999 is read as p99.9, as latency dashboards write it; p100 stays the maximum
+        std::string digits{m.substr(1)};
+        if (digits.size() > 2 && digits.starts_with("99") &&
+            digits.find('.') == std::string::npos) {
+            digits.insert(2, ".");
+        }
+        char* end{nullptr};
+        assertion.percentile = std::strtod(digits.c_str(), &end);
+        if (*end != '\0' || assertion.percentile > 100.0) {
+            printError("Unknown percentile '" + m + "' in --assert '" + text + "'");
+            return false;
+        }
+    } else if (m == "rss" || m == "output") {
+        assertion.kind = Kind::Bytes;
+    } else if (m == "throughput") {
+        assertion.kind = Kind::ByteRate;
+    } else if (m == "items") {
+        assertion.kind = Kind::ItemRate;
+    } else if (m != "mean" && m != "max" && m != "cpu") {
+        printError("Unknown metric '" + m + "' in --assert '" + text +
+                   "' (use mean, median, pNN, max, cpu, rss, output, throughput or items)");
+        return false;
+    }
+
+    if (!parseLimit(limit, assertion.kind, assertion.limit)) {
+        printError("Invalid limit '" + limit + "' in --assert '" + text + "'");
+        return false;
+    }
+    return true;
+}
+
+inline bool satisfies(const Assertion& a, double value) {
+    if (a.below) {
+        return a.inclusive ? value <= a.limit : value < a.limit;
+    }
+    return a.inclusive ? value >= a.limit : value > a.limit;
+}
+
+/**
+ * @brief Smallest sample with an order statistic beyond the percentile on the limit's side at
+ * 95%, mirroring Statistics::percentileBounds.
+ */
+inline long long iterationsForBound(const Assertion& a) {
+    const double q{a.below ? a.percentile / 100.0 : 1.0 - a.percentile / 100.0};
+    for (long long n{2}; n < 100000000; n += std::max(1LL, n / 1000)) {
+        const double nd{static_cast<double>(n)};
+        if (std::ceil(nd * q + 1.96 * std::sqrt(nd * q * (1.0 - q))) <= nd) {
+            return n;
+        }
+    }
+    return 100000000;
+}
+
+/**
+ * @brief Evaluate an assertion. It passes only if the 95% bound on the limit's side satisfies it
+ * (the upper bound for '<', the lower one for '>'); it fails if the estimate itself doesn't, and
+ * is inconclusive in between, where more iterations would decide it.
+ */
+inline Check evaluate(const Assertion& assertion, const BenchmarkResults& r) {
+    Check check{assertion};
+    double low{0};
+    double high{0};
+    const double n{static_cast<double>(r.iterations)};
+    const std::string& m{assertion.metric};
+
+    if (assertion.percentile >= 0) {
+        if (r.wallNs().empty()) {
+            check.note = "no per-run timings (cached result)";
+            return check;
+        }
+        // Order statistics of the integer samples, converted to ms only for the comparison
+        check.estimate = r.toMs(Statistics::percentile(r.wallNs(), assertion.percentile));
+        Statistics::percentileBounds(r.wallNs(), assertion.percentile, low, high);
+        low = r.toMs(low);
+        high = r.toMs(high);
+        if (!std::isfinite(assertion.below ? high : low)) {
+            check.note = "a bound on this percentile needs at least " +
+                         std::to_string(iterationsForBound(assertion)) + " iterations";
+        }
+    } else if (m == "mean") {
+        check.estimate = r.mean;
+        low = r.mean - r.meanHalfWidth();
+        high = r.mean + r.meanHalfWidth();
+    } else if (m == "max") {
+        check.estimate = low = high = r.max; // observed, not inferred
+    } else if (m == "cpu" || m == "rss") {
+        if (!r.hasUsage) {
+            check.note = "not measured (needs direct execution)";
+            return check;
+        }
+        if (m == "cpu") {
+            const double half{n > 1 ? 1.96 * r.cpuStdDev / std::sqrt(n - 1) : 0.0};
+            check.estimate = r.cpuMean;
+            low = r.cpuMean - half;
+            high = r.cpuMean + half;
+        } else {
+            check.estimate = low = high = r.peakRssMax; // the largest peak of any run
+        }
+    } else if (m == "output") {
+        if (!r.hasOutput) {
+            check.note = "not measured (needs --output-size)";
+            return check;
+        }
+        check.estimate = low = high = r.outputBytesMax;
+    } else {
+        const double amount{m == "throughput" ? r.bytesPerRun : r.itemsPerRun};
+        if (amount <= 0) {
+            check.note = m == "throughput" ? "needs --bytes or --bytes-from" : "needs --items";
+            return check;
+        }
+        r.rate(amount, check.estimate, low, high);
+    }
+
+    check.measured = true;
+    check.bound = assertion.below ? high : low;
+    if (!satisfies(assertion, check.estimate)) {
+        check.verdict = Verdict::Fail;
+    } else if (satisfies(assertion, check.bound)) {
+        check.verdict = Verdict::Pass;
+    } else if (check.note.empty()) {
+        check.note = "not significant at 95%; more iterations may decide it";
+    }
+    return check;
+}
+
+/**
+ * @brief Overall verdict: any failure fails, else any inconclusive check is inconclusive.
+ */
+inline Verdict overall(const std::vector<Check>& checks) {
+    Verdict verdict{Verdict::Pass};
+    for (const auto& check : checks) {
+        if (check.verdict == Verdict::Fail) {
+            return Verdict::Fail;
+        }
+        if (check.verdict == Verdict::Inconclusive) {
+            verdict = Verdict::Inconclusive;
+        }
+    }
+    return verdict;
+}
+
+inline int exitCode(Verdict verdict) {
+    return verdict == Verdict::Pass ? 0
+                                    : (verdict == Verdict::Fail ? ExitFailed : ExitInconclusive);
+}
+
+inline const char* verdictName(Verdict verdict) {
+    return verdict == Verdict::Pass ? "pass"
+                                    : (verdict == Verdict::Fail ? "fail" : "inconclusive");
+}
+
+inline std::string format(Kind kind, double value) {
+    if (!std::isfinite(value)) {
+        return value > 0 ? "∞" : "-∞";
+    }
+    switch (kind) {
+    case Kind::Bytes:
+        return BenchmarkResults::formatBytes(value);
+    case Kind::ByteRate:
+        return BenchmarkResults::formatBytes(value) + "/s";
+    case Kind::ItemRate:
+        return BenchmarkResults::formatCount(value) + " items/s";
+    default: {
+        std::ostringstream out{};
+        out << std::fixed << std::setprecision(3) << value << " ms";
+        return out.str();
+    }
+    }
+}
+
+inline void display(const std::vector<Check>& checks) {
+    std::cout << Colors::Bold << Colors::BrightWhite << "Assertions: " << Colors::Reset;
+    const Verdict verdict{overall(checks)};
+    std::cout << (verdict == Verdict::Pass   ? Colors::BrightGreen
+                  : verdict == Verdict::Fail ? Colors::BrightRed
+                                             : Colors::BrightYellow)
+              << verdictName(verdict) << Colors::Reset << "\n";
+
+    for (const auto& c : checks) {
+        const Kind kind{c.assertion.kind};
+        std::cout << "  "
+                  << (c.verdict == Verdict::Pass   ? Colors::BrightGreen + "✓ "
+                      : c.verdict == Verdict::Fail ? Colors::BrightRed + "✗ "
+                                                   : Colors::BrightYellow + "? ")
+                  << c.assertion.text << Colors::Reset;
+        if (c.measured) {
+            std::cout << Colors::Dim << "  " << c.assertion.metric << "="
+                      << format(kind, c.estimate);
+            if (c.bound != c.estimate) { // max, rss and output are observed, not inferred
+                std::cout << ", 95% " << (c.assertion.below ? "upper" : "lower") << " bound "
+                          << format(kind, c.bound);
+            }
+            std::cout << Colors::Reset;
+        }
+        if (!c.note.empty()) {
+            std::cout << Colors::Dim << "  (" << c.note << ")" << Colors::Reset;
+        }
+        std::cout << "\n";
+    }
+    std::cout << "\n";
+}
+
+inline std::string toJson(const std::vector<Check>& checks) {
+    auto number{[](double value) {
+        std::ostringstream out{};
+        if (std::isfinite(value)) {
+            out << std::fixed << std::setprecision(3) << value;
+        } else {
+            out << "null";
+        }
+        return out.str();
+    }};
+
+    std::ostringstream json{};
+    json << "  \"assertions\": {\"verdict\": \"" << verdictName(overall(checks))
+         << "\", \"checks\": [";
+    for (size_t i{0}; i < checks.size(); ++i) {
+        const Check& c{checks[i]};
+        json << (i > 0 ? "," : "") << "\n    {\"assertion\": \""
+             << BenchmarkResults::escapeJson(c.assertion.text) << "\", \"verdict\": \""
+             << verdictName(c.verdict) << "\", \"limit\": " << number(c.assertion.limit);
+        if (c.measured) {
+            json << ", \"estimate\": " << number(c.estimate) << ", \"bound\": " << number(c.bound);
+        }
+        if (!c.note.empty()) {
+            json << ", \"note\": \"" << BenchmarkResults::escapeJson(c.note) << "\"";
+        }
+        json << "}";
+    }
+    json << (checks.empty() ? "" : "\n  ") << "]}";
+    return json.str();
+}
+
+/**
+ * @brief Add the assertions object to a result's JSON, before its closing brace.
+ */
+inline std::string withAssertions(std::string json, const std::vector<Check>& checks) {
+    const size_t close{json.rfind('}')};
+    if (close == std::string::npos) {
+        return json;
+    }
+    size_t end{close};
+    while (end > 0 && std::isspace(static_cast<unsigned char>(json[end - 1]))) {
+        --end;
+    }
+    return json.substr(0, end) + ",\n" + toJson(checks) + "\n" + json.substr(close);
+}
+
+} // namespace Slo
+
+#endif
@@ -0,0 +1,663 @@
+#ifndef SUITE_H
+#define SUITE_H
+
+#include "argparser.h"
+#include "pareto.h"
+#include "runner.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cctype>
+#include <cerrno>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <map>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <utility>
+#include <variant>
+#include <vector>
+
+namespace Toml {
+
+/**
+ * @brief The subset of TOML values a suite file needs: strings, integers, booleans and arrays of
+ * strings.
+ */
+using Value = std::variant<std::string, long long, bool, std::vector<std::string>>;
+
+struct Table {
+    std::string name{};
+    std::map<std::string, Value> values{};
+};
+
+/**
+ * @brief A parsed document. Table 0 holds the top-level keys; the rest are kept in file order.
+ */
+struct Document {
+    std::vector<Table> tables{};
+};
+
+class Parser {
+  private:
+    const std::string& text;
+    size_t pos{0};
+    int line{1};
+    std::string error{};
+
+    bool fail(const std::string& message) {
+        if (error.empty()) {
+            error = "line " + std::to_string(line) + ": " + message;
+        }
+        return false;
+    }
+
+    char peek() const {
+        return pos < text.size() ? text[pos] : '\0';
+    }
+
+    void skipSpaces() {
+        while (peek() == ' ' || peek() == '\t') {
+            ++pos;
+        }
+    }
+
+    void skipComment() {
+        if (peek() == '#') {
+            while (pos < text.size() && text[pos] != '\n') {
+                ++pos;
+            }
+        }
+    }
+
+    // Whitespace, comments and newlines, as allowed inside arrays
+    void skipBlank() {
+        while (pos < text.size()) {
+            skipSpaces();
+            skipComment();
+            if (peek() == '\n' || peek() == '\r') {
+                if (peek() == '\n')
+                    ++line;
+                ++pos;
+            } else {
+                break;
+            }
+        }
+    }
+
+    bool endOfLine() {
+        skipSpaces();
+        skipComment();
+        if (peek() == '\r')
+            ++pos;
+        if (pos >= text.size())
+            return true;
+        if (peek() != '\n')
+            return fail("expected end of line");
+        ++pos;
+        ++line;
+        return true;
+    }
+
+    bool parseKey(std::string& key) {
+        skipSpaces();
+        if (peek() == '"') {
+            return parseString(key);
+        }
+
+        size_t start{pos};
+        while (pos < text.size() && (std::isalnum(static_cast<unsigned char>(text[pos])) ||
+                                     text[pos] == '_' || text[pos] == '-' || text[pos] == '.')) {
+            ++pos;
+        }
+        if (start == pos) {
+            return fail("expected a key");
+        }
+        key = text.substr(start, pos - start);
+        return true;
+    }
+
+    bool parseString(std::string& out) {
+        char quote{peek()};
+        ++pos;
+        out.clear();
+
+        while (pos < text.size() && text[pos] != quote) {
+            char c{text[pos++]};
+            if (c == '\n') {
+                return fail("unterminated string");
+            }
+            if (c == '\\' && quote == '"' && pos < text.size()) {
+                char esc{text[pos++]};
+                switch (esc) {
+                case 'n':
+                    out += '\n';
+                    break;
+                case 't':
+                    out += '\t';
+                    break;
+                case '"':
+                case '\\':
+                    out += esc;
+                    break;
+                default:
+                    return fail(std::string{"unsupported escape \\"} + esc);
+                }
+            } else {
+                out += c;
+            }
+        }
+
+        if (pos >= text.size()) {
+            return fail("unterminated string");
+        }
+        ++pos;
+        return true;
+    }
+
+    bool parseValue(Value& value) {
+        skipSpaces();
+        char c{peek()};
+
+        if (c == '"' || c == '\'') {
+            std::string s{};
+            if (!parseString(s))
+                return false;
+            value = s;
+            return true;
+        }
+
+        if (c == '[') {
+            ++pos;
+            std::vector<std::string> items{};
+            skipBlank();
+            while (peek() != ']') {
+                if (peek() != '"' && peek() != '\'') {
+                    return fail("arrays may only contain strings");
+                }
+                std::string item{};
+                if (!parseString(item))
+                    return false;
+                items.push_back(item);
+                skipBlank();
+                if (peek() == ',') {
+                    ++pos;
+                    skipBlank();
+                } else if (peek() != ']') {
+                    return fail("expected ',' or ']' in array");
+                }
+            }
+            ++pos;
+            value = items;
+            return true;
+        }
+
+        if (text.compare(pos, 4, "true") == 0) {
+            pos += 4;
+            value = true;
+            return true;
+        }
+        if (text.compare(pos, 5, "false") == 0) {
+            pos += 5;
+            value = false;
+            return true;
+        }
+
+        size_t start{pos};
+        if (c == '-' || c == '+')
+            ++pos;
+        while (std::isdigit(static_cast<unsigned char>(peek())) || peek() == '_') {
+            ++pos;
+        }
+        std::string digits{text.substr(start, pos - start)};
+        digits.erase(std::remove(digits.begin(), digits.end(), '_'), digits.end());
+        if (digits.empty() || digits == "-" || digits == "+") {
+            return fail("expected a string, integer, boolean or array of strings");
+        }
+        errno = 0;
+        value = std::strtoll(digits.c_str(), nullptr, 10);
+        if (errno == ERANGE) {
+            return fail("integer out of range");
+        }
+        return true;
+    }
+
+  public:
+    explicit Parser(const std::string& source) : text{source} {}
+
+    bool parse(Document& doc) {
+        doc.tables.clear();
+        doc.tables.push_back(Table{});
+
+        while (true) {
+            skipBlank();
+            if (pos >= text.size()) {
+                return true;
+            }
+
+            if (peek() == '[') {
+                ++pos;
+                std::string name{};
+                if (!parseKey(name))
+                    return false;
+                skipSpaces();
+                if (peek() != ']')
+                    return fail("expected ']' after table name");
+                ++pos;
+                for (const auto& t : doc.tables) {
+                    if (t.name == name)
+                        return fail("duplicate table [" + name + "]");
+                }
+                doc.tables.push_back(Table{name, {}});
+                if (!endOfLine())
+                    return false;
+                continue;
+            }
+
+            std::string key{};
+            if (!parseKey(key))
+                return false;
+            skipSpaces();
+            if (peek() != '=')
+                return fail("expected '=' after key '" + key + "'");
+            ++pos;
+
+            Value value{};
+            if (!parseValue(value))
+                return false;
+            if (!doc.tables.back().values.emplace(key, value).second)
+                return fail("duplicate key '" + key + "'");
+            if (!endOfLine())
+                return false;
+        }
+    }
+
+    const std::string& getError() const {
+        return error;
+    }
+};
+
+} // namespace Toml
+
+namespace Suite {
+
+/**
+ * @brief One benchmark of a suite, after inputs have been expanded.
+ */
+struct Entry {
+    std::string name{};
+    std::vector<std::string> tags{};
+    bool parallel{false};
+    BenchmarkConfig config{};
+};
+
+inline void printError(const std::string& message) {
+    std::cerr << Colors::BrightRed << "Error: " << Colors::Reset << message << "\n";
+}
+
+inline std::string replaceAll(std::string text, const std::string& from, const std::string& to) {
+    for (size_t pos{text.find(from)}; pos != std::string::npos;
+         pos = text.find(from, pos + to.size())) {
+        text.replace(pos, from.size(), to);
+    }
+    return text;
+}
+
+/**
+ * @brief Typed lookup of a key in a benchmark table, falling back to the suite's top-level keys.
+ */
+template <typename T>
+inline bool lookup(const Toml::Table& table, const Toml::Table& defaults, const std::string& key,
+                   T& out) {
+    for (const Toml::Table* t : {&table, &defaults}) {
+        auto it{t->values.find(key)};
+        if (it == t->values.end()) {
+            continue;
+        }
+        if (const T* v{std::get_if<T>(&it->second)}) {
+            out = *v;
+            return true;
+        }
+        printError("'" + key + "' in [" + (t->name.empty() ? "top level" : t->name) +
+                   "] has the wrong type");
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Load a suite file. Benchmarks are [benchmark.<name>] tables; top-level keys act as
+ * defaults for every benchmark.
+ */
+inline bool load(const std::string& path, const BenchmarkConfig& base, Exec::Mode mode,
+                 std::vector<Entry>& entries) {
+    std::ifstream file{path};
+    if (!file) {
+        printError("Cannot open suite file '" + path + "'");
+        return false;
+    }
+
+    std::stringstream buffer{};
+    buffer << file.rdbuf();
+    const std::string text{buffer.str()};
+
+    Toml::Document doc{};
+    Toml::Parser parser{text};
+    if (!parser.parse(doc)) {
+        printError(path + ": " + parser.getError());
+        return false;
+    }
+
+    static const std::set<std::string> knownKeys{
+        "command", "iterations",  "warmup", "prepare",    "inputs", "tags",
+        "placement", "shell", "output_size", "bytes", "bytes_from", "items"};
+    const Toml::Table& defaults{doc.tables[0]};
+    const std::string prefix{"benchmark."};
+
+    for (size_t i{1}; i < doc.tables.size(); ++i) {
+        const Toml::Table& table{doc.tables[i]};
+        if (table.name.rfind(prefix, 0) != 0) {
+            printError(path + ": unexpected table [" + table.name +
+                       "], expected [benchmark.<name>]");
+            return false;
+        }
+
+        for (const auto& [key, value] : table.values) {
+            if (knownKeys.count(key) == 0) {
+                printError(path + ": unknown key '" + key + "' in [" + table.name + "]");
+                return false;
+            }
+        }
+
+        std::string command{};
+        std::string prepare{};
+        std::string outputSize{base.outputSize};
+        std::string placement{"serial"};
+        long long iterations{base.iterations};
+        long long warmup{base.warmup};
+        long long bytes{static_cast<long long>(base.workBytes)};
+        long long items{static_cast<long long>(base.workItems)};
+        std::string bytesFrom{};
+        bool shell{false};
+        std::vector<std::string> inputs{};
+        std::vector<std::string> tags{};
+
+        if (!lookup(table, defaults, "command", command) ||
+            !lookup(table, defaults, "prepare", prepare) ||
+            !lookup(table, defaults, "output_size", outputSize) ||
+            !lookup(table, defaults, "placement", placement) ||
+            !lookup(table, defaults, "iterations", iterations) ||
+            !lookup(table, defaults, "warmup", warmup) ||
+            !lookup(table, defaults, "bytes", bytes) || !lookup(table, defaults, "items", items) ||
+            !lookup(table, defaults, "bytes_from", bytesFrom) ||
+            !lookup(table, defaults, "shell", shell) ||
+            !lookup(table, defaults, "inputs", inputs) || !lookup(table, defaults, "tags", tags)) {
+            return false;
+        }
+
+        const std::string name{table.name.substr(prefix.size())};
+        if (command.empty()) {
+            printError(path + ": [" + table.name + "] has no command");
+            return false;
+        }
+        if (iterations <= 0 || iterations > std::numeric_limits<int>::max() || warmup < 0 ||
+            warmup > std::numeric_limits<int>::max()) {
+            printError(path + ": [" + table.name +
+                       "] needs iterations > 0 and warmup >= 0, both at most " +
+                       std::to_string(std::numeric_limits<int>::max()));
+            return false;
+        }
+        if (placement != "serial" && placement != "core") {
+            printError(path + ": placement in [" + table.name + "] must be 'serial' or 'core'");
+            return false;
+        }
+        if (bytes < 0 || items < 0) {
+            printError(path + ": bytes and items in [" + table.name + "] must not be negative");
+            return false;
+        }
+
+        if (inputs.empty()) {
+            inputs.push_back("");
+        }
+
+        for (const auto& input : inputs) {
+            Entry entry{};
+            entry.name = input.empty() ? name : name + "[" + input + "]";
+            entry.tags = tags;
+            entry.parallel = (placement == "core");
+            entry.config = base;
+            entry.config.quiet = true;
+            entry.config.command = replaceAll(command, "{input}", input);
+            entry.config.prepare = replaceAll(prepare, "{input}", input);
+            entry.config.outputSize = replaceAll(outputSize, "{input}", input);
+            entry.config.iterations = static_cast<int>(iterations);
+            entry.config.warmup = static_cast<int>(warmup);
+            entry.config.workBytes = static_cast<double>(bytes);
+            entry.config.workItems = static_cast<double>(items);
+            if (!bytesFrom.empty()) {
+                // Per input, so a sweep over files of different sizes compares rates, not times
+                const std::string file{replaceAll(bytesFrom, "{input}", input)};
+                if (!fileBytes(file, entry.config.workBytes)) {
+                    printError(path + ": cannot read the size of '" + file + "' (bytes_from of [" +
+                               table.name + "])");
+                    return false;
+                }
+            }
+            entry.config.useShell = false;
+
+            if (shell) {
+#ifdef _WIN32
+                entry.config.cmdArgs = {"cmd", "/c", entry.config.command};
+#else
+                entry.config.cmdArgs = {"/bin/sh", "-c", entry.config.command};
+#endif
+            } else {
+                entry.config.cmdArgs = parseCommand(entry.config.command);
+            }
+
+            if (entry.config.cmdArgs.empty()) {
+                printError(path + ": failed to parse command of [" + table.name + "]");
+                return false;
+            }
+
+#ifdef __linux__
+            auto image{std::make_shared<Exec::Image>()};
+            if (!Exec::prepare(*image, entry.config.cmdArgs, mode)) {
+                return false;
+            }
+            entry.config.image = image;
+#endif
+
+            entries.push_back(std::move(entry));
+        }
+    }
+
+    if (entries.empty()) {
+        printError(path + ": no [benchmark.<name>] tables found");
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * @brief One logical CPU per physical core, so parallel benchmarks never share a core's SMT
+ * siblings.
+ */
+inline std::vector<int> physicalCores() {
+    std::vector<int> cores{};
+#ifdef __linux__
+    std::set<std::pair<int, int>> seen{};
+    const std::string base{"/sys/devices/system/cpu/"};
+
+    for (int cpu : Numa::parseList(Numa::readFirstLine(base + "online"))) {
+        const std::string topo{base + "cpu" + std::to_string(cpu) + "/topology/"};
+        std::string package{Numa::readFirstLine(topo + "physical_package_id")};
+        std::string core{Numa::readFirstLine(topo + "core_id")};
+
+        std::pair<int, int> key{package.empty() ? 0 : std::stoi(package),
+                                core.empty() ? cpu : std::stoi(core)};
+        if (seen.insert(key).second) {
+            cores.push_back(cpu);
+        }
+    }
+#endif
+    if (cores.empty()) {
+        unsigned int n{std::thread::hardware_concurrency()};
+        for (unsigned int i{0}; i < std::max(1u, n); ++i) {
+            cores.push_back(-1);
+        }
+    }
+    return cores;
+}
+
+/**
+ * @brief Run a suite: 'core' benchmarks in parallel, one per physical core, then 'serial'
+ * benchmarks one at a time with the machine to themselves. Results come back in file order.
+ */
+inline std::vector<BenchmarkResults> run(const std::vector<Entry>& entries, int maxJobs,
+                                         bool quiet) {
+    std::vector<BenchmarkResults> results(entries.size());
+    std::mutex outputMutex{};
+
+    auto finish{[&](size_t index, BenchmarkResults r) {
+        r.name = entries[index].name;
+        r.tags = entries[index].tags;
+
+        std::lock_guard<std::mutex> lock{outputMutex};
+        if (!quiet && r.reservationFailed) {
+            std::cout << "  " << Colors::BrightRed << "✗ " << Colors::Reset << r.name
+                      << Colors::Dim << "  skipped, CPUs reserved by another vajra process"
+                      << Colors::Reset << "\n"
+                      << std::flush;
+        } else if (!quiet) {
+            std::cout << "  " << Colors::BrightGreen << "✓ " << Colors::Reset << r.name
+                      << Colors::Dim << "  μ=" << std::fixed << std::setprecision(3) << r.mean
+                      << " ms  σ=" << r.stdDev << " ms" << Colors::Reset << "\n"
+                      << std::flush;
+        }
+        results[index] = std::move(r);
+    }};
+
+    std::vector<size_t> parallel{};
+    std::vector<size_t> serial{};
+    for (size_t i{0}; i < entries.size(); ++i) {
+        (entries[i].parallel ? parallel : serial).push_back(i);
+    }
+
+    if (!parallel.empty()) {
+        std::vector<int> cores{physicalCores()};
+        size_t workers{std::min(cores.size(), parallel.size())};
+        if (maxJobs > 0) {
+            workers = std::min(workers, static_cast<size_t>(maxJobs));
+        }
+
+        if (!quiet) {
+            std::cout << Colors::BrightMagenta << "Running " << parallel.size()
+                      << " core-placed benchmark(s) on " << workers << " physical core(s)..."
+                      << Colors::Reset << "\n";
+        }
+
+        std::atomic<size_t> next{0};
+        std::vector<std::thread> threads{};
+        for (size_t w{0}; w < workers; ++w) {
+            threads.emplace_back([&, w]() {
+                for (size_t i{next++}; i < parallel.size(); i = next++) {
+                    BenchmarkConfig config{entries[parallel[i]].config};
+                    config.cpu = cores[w];
+                    finish(parallel[i], runBenchmark(config));
+                }
+            });
+        }
+        for (auto& t : threads) {
+            t.join();
+        }
+    }
+
+    if (!serial.empty() && !quiet) {
+        std::cout << Colors::BrightMagenta << "Running " << serial.size()
+                  << " serial benchmark(s)..." << Colors::Reset << "\n";
+    }
+    for (size_t index : serial) {
+        finish(index, runBenchmark(entries[index].config));
+    }
+
+    return results;
+}
+
+inline void displayReport(const std::string& path, const std::vector<BenchmarkResults>& results) {
+    size_t nameWidth{4};
+    for (const auto& r : results) {
+        nameWidth = std::max(nameWidth, r.name.size());
+    }
+    const bool anyRate{std::any_of(results.begin(), results.end(), [](const BenchmarkResults& r) {
+        return r.bytesPerRun > 0 || r.itemsPerRun > 0;
+    })};
+
+    std::cout << "\n"
+              << Colors::Bold << Colors::BrightWhite << "Suite: " << Colors::Reset << path << "  "
+              << Colors::Dim << "(" << results.size() << " benchmarks)" << Colors::Reset << "\n";
+    std::cout << Colors::Bold << "  " << std::left << std::setw(static_cast<int>(nameWidth))
+              << "name" << std::right << std::setw(12) << "μ (ms)" << std::setw(12) << "σ (ms)"
+              << std::setw(12) << "min (ms)" << std::setw(12) << "max (ms)";
+    if (anyRate) {
+        std::cout << std::setw(16) << "throughput";
+    }
+    std::cout << "  tags" << Colors::Reset << "\n";
+
+    for (const auto& r : results) {
+        std::string tags{};
+        for (const auto& tag : r.tags) {
+            tags += (tags.empty() ? "" : ",") + tag;
+        }
+
+        std::cout << "  " << std::left << std::setw(static_cast<int>(nameWidth)) << r.name
+                  << std::right << std::fixed << std::setprecision(3) << Colors::BrightGreen
+                  << std::setw(11) << r.mean << Colors::Reset << Colors::BrightMagenta
+                  << std::setw(12) << r.stdDev << Colors::Reset << Colors::BrightBlue
+                  << std::setw(12) << r.min << Colors::Reset << Colors::BrightRed << std::setw(12)
+                  << r.max << Colors::Reset;
+        if (anyRate) {
+            double value{}, low{}, high{};
+            std::string rate{"-"};
+            if (r.bytesPerRun > 0) {
+                r.rate(r.bytesPerRun, value, low, high);
+                rate = BenchmarkResults::formatBytes(value) + "/s";
+            } else if (r.itemsPerRun > 0) {
+                r.rate(r.itemsPerRun, value, low, high);
+                rate = BenchmarkResults::formatCount(value) + " items/s";
+            }
+            std::cout << Colors::BrightYellow << std::setw(16) << rate << Colors::Reset;
+        }
+        std::cout << "  " << Colors::Dim << tags << Colors::Reset << "\n";
+    }
+    std::cout << "\n";
+
+    Pareto::display(results);
+}
+
+inline std::string toJson(const std::string& path, const std::vector<BenchmarkResults>& results) {
+    std::ostringstream json{};
+    json << "{\n"
+         << "  \"suite\": \"" << path << "\",\n"
+         << "  \"benchmarks\": [\n";
+
+    for (size_t i{0}; i < results.size(); ++i) {
+        std::string item{results[i].toJson()};
+        item.pop_back();
+        json << item << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+
+    json << "  ],\n" << Pareto::toJson(results) << "\n"
+         << "}\n";
+    return json.str();
+}
+
+} // namespace Suite
+
+#endif
@@ -0,0 +1,375 @@
+#ifndef TOURNAMENT_H
+#define TOURNAMENT_H
+
+#include "argparser.h"
+#include "journal.h"
+#include "runner.h"
+#include "suite.h"
+#include "vajra.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <iomanip>
+#include <iostream>
+#include <span>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace Tournament {
+
+/**
+ * @brief Family-wise significance level of the whole tournament: Bonferroni-split over every
+ * round the budget allows and over the candidates tested against the leader in each, so a
+ * decisive winner really beat all the others at this level.
+ */
+constexpr double Alpha{0.05};
+/**
+ * @brief Samples per candidate after the first round; the target doubles every round after that.
+ */
+constexpr int FirstRound{5};
+
+struct Candidate {
+    std::string name{};
+    std::vector<uint64_t> wallNs{}; // every sample so far
+    int eliminatedIn{0};            // round number, 0 while still racing
+    double pValue{1.0};             // one-sided, against the leader when eliminated or at the end
+    bool failed{false};             // a run exited non-zero or was killed; out at once
+
+    double meanMs() const {
+        return Statistics::mean(wallNs) / 1e6;
+    }
+    double ci95Ms() const {
+        return Statistics::confidenceHalfWidth(wallNs) / 1e6;
+    }
+};
+
+struct Outcome {
+    std::vector<Candidate> candidates{};
+    size_t winner{0};
+    int rounds{0};
+    long long runs{0};
+    long long fullBudget{0};
+    bool interrupted{false};
+    bool failed{false};
+    int maxRounds{1};      // rounds the largest budget allows, for the alpha split
+    double testAlpha{0.0}; // level of the first round's tests (later rounds' are no looser)
+
+    /**
+     * @brief True if every other candidate was shown to be slower than the winner.
+     */
+    bool decisive() const {
+        return std::none_of(candidates.begin(), candidates.end(), [this](const Candidate& c) {
+            return &c != &candidates[winner] && c.eliminatedIn == 0;
+        });
+    }
+
+    /**
+     * @brief The closest rival: a surviving one if any, else the last to be eliminated; the
+     * winner itself if every other candidate failed.
+     */
+    size_t runnerUp() const {
+        auto closer{[this](const Candidate& a, const Candidate& b) {
+            const int ra{a.eliminatedIn == 0 ? rounds + 1 : a.eliminatedIn};
+            const int rb{b.eliminatedIn == 0 ? rounds + 1 : b.eliminatedIn};
+            return ra != rb ? ra > rb : a.pValue > b.pValue;
+        }};
+        size_t best{winner};
+        for (size_t i{0}; i < candidates.size(); ++i) {
+            if (i != winner && !candidates[i].failed &&
+                (best == winner || closer(candidates[i], candidates[best]))) {
+                best = i;
+            }
+        }
+        return best;
+    }
+};
+
+/**
+ * @brief One-sided p-value that 'slower' really has a larger mean than 'faster'.
+ */
+inline double slowerPValue(std::span<const uint64_t> slower, std::span<const uint64_t> faster) {
+    const Statistics::WelchResult test{Statistics::welchTest(slower, faster)};
+    return test.t > 0 ? test.pValue / 2.0 : 1.0 - test.pValue / 2.0;
+}
+
+inline size_t leader(const std::vector<Candidate>& candidates, const std::vector<size_t>& alive) {
+    return *std::min_element(alive.begin(), alive.end(), [&](size_t a, size_t b) {
+        return Statistics::mean(candidates[a].wallNs) < Statistics::mean(candidates[b].wallNs);
+    });
+}
+
+/**
+ * @brief Race the entries against each other. Every round tops each surviving candidate up to the
+ * round's sample target (FirstRound, then doubling, capped at the entry's own iterations) and
+ * drops the ones that are significantly slower than the current leader, so the budget goes to the
+ * candidates that are still in contention. Warmup runs at the start of every round because the
+ * other candidates ran in between.
+ */
+inline Outcome run(const std::vector<Suite::Entry>& entries, int maxJobs, bool quiet) {
+    Outcome outcome{};
+    for (const auto& entry : entries) {
+        outcome.candidates.push_back({entry.name, {}, 0, 1.0});
+        outcome.fullBudget += entry.config.iterations;
+    }
+
+    std::vector<size_t> alive(entries.size());
+    for (size_t i{0}; i < alive.size(); ++i) {
+        alive[i] = i;
+    }
+
+    int largest{0};
+    for (const auto& entry : entries) {
+        largest = std::max(largest, entry.config.iterations);
+    }
+    for (long long target{FirstRound}; target < largest; target *= 2) {
+        ++outcome.maxRounds;
+    }
+
+    for (int target{FirstRound}; alive.size() > 1 && !interruptRequested; target *= 2) {
+        std::vector<Suite::Entry> round{};
+        std::vector<size_t> index{};
+        for (size_t i : alive) {
+            const int have{static_cast<int>(outcome.candidates[i].wallNs.size())};
+            const int need{std::min(target, entries[i].config.iterations) - have};
+            if (need <= 0) {
+                continue;
+            }
+            Suite::Entry entry{entries[i]};
+            entry.config.iterations = need;
+            // Rounds must measure; a cached summary has no samples to race with
+            entry.config.cache = nullptr;
+            round.push_back(std::move(entry));
+            index.push_back(i);
+        }
+        if (round.empty()) {
+            break; // every survivor has used its full budget
+        }
+
+        ++outcome.rounds;
+        const std::vector<BenchmarkResults> results{Suite::run(round, maxJobs, true)};
+        for (size_t k{0}; k < results.size(); ++k) {
+            if (results[k].reservationFailed) {
+                outcome.failed = true;
+                return outcome;
+            }
+            Candidate& c{outcome.candidates[index[k]]};
+            const auto measured{results[k].wallNs()};
+            c.wallNs.insert(c.wallNs.end(), measured.begin(), measured.end());
+            outcome.runs += static_cast<long long>(measured.size());
+            if (results[k].failed()) {
+                c.failed = true;
+                c.eliminatedIn = outcome.rounds;
+            }
+        }
+        std::erase_if(alive, [&](size_t i) { return outcome.candidates[i].failed; });
+        if (alive.empty()) {
+            Suite::printError("Every candidate failed (a run exited non-zero or was killed)");
+            outcome.failed = true;
+            return outcome;
+        }
+        if (interruptRequested || alive.size() == 1) {
+            break;
+        }
+
+        const size_t best{leader(outcome.candidates, alive)};
+        const double threshold{Alpha / (static_cast<double>(outcome.maxRounds) *
+                                        static_cast<double>(alive.size() - 1))};
+        if (outcome.rounds == 1) {
+            outcome.testAlpha = threshold;
+        }
+        std::vector<size_t> survivors{};
+        for (size_t i : alive) {
+            Candidate& c{outcome.candidates[i]};
+            if (i != best) {
+                c.pValue = slowerPValue(c.wallNs, outcome.candidates[best].wallNs);
+                if (c.wallNs.size() >= 2 && c.pValue < threshold) {
+                    c.eliminatedIn = outcome.rounds;
+                    continue;
+                }
+            }
+            survivors.push_back(i);
+        }
+
+        if (!quiet) {
+            std::cout << "  " << Colors::BrightMagenta << "Round " << outcome.rounds
+                      << Colors::Reset << "  " << target << " samples each, "
+                      << alive.size() - survivors.size() << " eliminated, " << survivors.size()
+                      << " left" << Colors::Dim << "  (leading: "
+                      << outcome.candidates[best].name << ")" << Colors::Reset << "\n"
+                      << std::flush;
+        }
+        alive = std::move(survivors);
+    }
+
+    outcome.interrupted = interruptRequested != 0;
+    outcome.winner = leader(outcome.candidates, alive);
+    for (size_t i : alive) {
+        if (i != outcome.winner) {
+            outcome.candidates[i].pValue = slowerPValue(
+                outcome.candidates[i].wallNs, outcome.candidates[outcome.winner].wallNs);
+        }
+    }
+    return outcome;
+}
+
+/**
+ * @brief Per-candidate results over every sample it was given, for JSON and OpenMetrics.
+ */
+inline std::vector<BenchmarkResults> results(const Outcome& outcome,
+                                             const std::vector<Suite::Entry>& entries) {
+    std::vector<BenchmarkResults> all{};
+    for (size_t i{0}; i < outcome.candidates.size(); ++i) {
+        std::vector<Journal::Sample> samples{};
+        for (uint64_t ns : outcome.candidates[i].wallNs) {
+            samples.push_back({ns, {}, {}, {}});
+        }
+
+        BenchmarkResults r{};
+        r.command = entries[i].config.command;
+        summarize(samples, r);
+        r.name = entries[i].name;
+        r.tags = entries[i].tags;
+        r.plannedIterations = entries[i].config.iterations;
+        r.bytesPerRun = entries[i].config.workBytes;
+        r.itemsPerRun = entries[i].config.workItems;
+        all.push_back(std::move(r));
+    }
+    return all;
+}
+
+inline std::string fate(const Outcome& outcome, size_t i) {
+    std::ostringstream text{};
+    const Candidate& c{outcome.candidates[i]};
+    if (i == outcome.winner) {
+        text << "winner";
+    } else if (c.failed) {
+        text << "failed in round " << c.eliminatedIn;
+    } else if (c.eliminatedIn > 0) {
+        text << "out in round " << c.eliminatedIn << " (p=" << std::setprecision(2)
+             << std::scientific << c.pValue << ")";
+    } else {
+        text << "not separable (p=" << std::fixed << std::setprecision(3) << c.pValue << ")";
+    }
+    return text.str();
+}
+
+inline void display(const std::string& path, const Outcome& outcome) {
+    const Candidate& winner{outcome.candidates[outcome.winner]};
+    const double saved{outcome.fullBudget > 0
+                           ? 100.0 * (1.0 - static_cast<double>(outcome.runs) /
+                                                static_cast<double>(outcome.fullBudget))
+                           : 0.0};
+
+    std::cout << "\n"
+              << Colors::Bold << Colors::BrightWhite << "Tournament: " << Colors::Reset << path
+              << "  " << Colors::Dim << "(" << outcome.candidates.size() << " candidates, "
+              << outcome.rounds << " rounds, " << outcome.runs << " of " << outcome.fullBudget
+              << " runs, " << std::fixed << std::setprecision(0) << saved << "% saved)"
+              << Colors::Reset << "\n";
+
+    std::cout << "  " << Colors::BrightGreen << "★ " << Colors::Bold << winner.name
+              << Colors::Reset << Colors::BrightGreen << "  μ=" << std::setprecision(3)
+              << winner.meanMs() << " ± " << winner.ci95Ms() << " ms" << Colors::Reset
+              << Colors::Dim << " (95% CI, " << winner.wallNs.size() << " samples)"
+              << Colors::Reset << "\n";
+
+    if (outcome.candidates.size() > 1) {
+        const size_t rival{outcome.runnerUp()};
+        const Candidate& second{outcome.candidates[rival]};
+        if (outcome.decisive()) {
+            std::cout << "  " << Colors::BrightGreen << "✓ " << Colors::Reset
+                      << "faster than every other candidate at the " << std::setprecision(0)
+                      << (1.0 - Alpha) * 100.0 << "% level" << Colors::Dim
+                      << " (family-wise over " << outcome.maxRounds
+                      << " round(s); last to fall: " << second.name << ")" << Colors::Reset
+                      << "\n";
+        } else {
+            std::cout << "  " << Colors::BrightYellow << "≈ " << Colors::Reset
+                      << "not separable from " << second.name << " within the budget"
+                      << Colors::Dim << " (p=" << std::setprecision(3) << second.pValue
+                      << "; raise iterations to decide)" << Colors::Reset << "\n";
+        }
+    }
+    if (outcome.interrupted) {
+        std::cout << "  " << Colors::BrightYellow << "⚠ " << Colors::Reset
+                  << "interrupted after round " << outcome.rounds << Colors::Dim
+                  << " (the winner is the leader so far)" << Colors::Reset << "\n";
+    }
+
+    // Leader first, then by mean
+    std::vector<size_t> order(outcome.candidates.size());
+    for (size_t i{0}; i < order.size(); ++i) {
+        order[i] = i;
+    }
+    std::stable_sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+        return Statistics::mean(outcome.candidates[a].wallNs) <
+               Statistics::mean(outcome.candidates[b].wallNs);
+    });
+
+    size_t nameWidth{4};
+    for (const auto& c : outcome.candidates) {
+        nameWidth = std::max(nameWidth, c.name.size());
+    }
+    std::cout << "\n"
+              << Colors::Bold << "  " << std::left << std::setw(static_cast<int>(nameWidth))
+              << "name" << std::right << std::setw(12) << "μ (ms)" << std::setw(10) << "samples"
+              << "  result" << Colors::Reset << "\n";
+    for (size_t i : order) {
+        const Candidate& c{outcome.candidates[i]};
+        std::cout << "  " << std::left << std::setw(static_cast<int>(nameWidth)) << c.name
+                  << std::right << (i == outcome.winner ? Colors::BrightGreen : Colors::White)
+                  << std::fixed << std::setprecision(3) << std::setw(11)
+                  << c.meanMs() << Colors::Reset << std::setw(10)
+                  << c.wallNs.size() << "  " << Colors::Dim << fate(outcome, i) << Colors::Reset
+                  << "\n";
+    }
+    std::cout << "\n";
+}
+
+inline std::string toJson(const std::string& path, const Outcome& outcome,
+                          const std::vector<BenchmarkResults>& results) {
+    const Candidate& winner{outcome.candidates[outcome.winner]};
+    const Candidate& second{outcome.candidates[outcome.runnerUp()]};
+
+    std::ostringstream json{};
+    json << "{\n"
+         << "  \"suite\": \"" << BenchmarkResults::escapeJson(path) << "\",\n"
+         << "  \"tournament\": {\n"
+         << "    \"winner\": \"" << BenchmarkResults::escapeJson(winner.name) << "\",\n"
+         << "    \"decisive\": " << (outcome.decisive() ? "true" : "false") << ",\n"
+         << "    \"runner_up\": \"" << BenchmarkResults::escapeJson(second.name) << "\",\n"
+         << "    \"runner_up_p_value\": " << std::defaultfloat << std::setprecision(6)
+         << second.pValue << ",\n"
+         << "    \"alpha\": " << Alpha << ",\n"
+         << "    \"alpha_per_test\": " << outcome.testAlpha << ",\n"
+         << "    \"rounds\": " << outcome.rounds << ",\n"
+         << "    \"runs\": " << outcome.runs << ",\n"
+         << "    \"full_budget\": " << outcome.fullBudget << ",\n"
+         << "    \"interrupted\": " << (outcome.interrupted ? "true" : "false") << "\n"
+         << "  },\n"
+         << "  \"benchmarks\": [\n";
+
+    for (size_t i{0}; i < results.size(); ++i) {
+        const Candidate& c{outcome.candidates[i]};
+        std::string item{results[i].toJson()};
+        // Splice the candidate's fate into its result object
+        item.erase(item.size() - 3);
+        item += ",\n  \"eliminated_round\": " + std::to_string(c.eliminatedIn);
+        if (c.failed) {
+            item += ",\n  \"failed\": true";
+        }
+        std::ostringstream p{};
+        p << std::defaultfloat << std::setprecision(6) << (i == outcome.winner ? 1.0 : c.pValue);
+        item += ",\n  \"p_value_vs_winner\": " + p.str() + "\n}";
+        json << item << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+
+    json << "  ]\n"
+         << "}\n";
+    return json.str();
+}
+
+} // namespace Tournament
+
+#endif
@@ -0,0 +1,433 @@
+#ifndef TUNE_H
+#define TUNE_H
+
+#include "argparser.h"
+#include "exec.h"
+#include "runner.h"
+#include "suite.h"
+#include "tournament.h"
+#include "vajra.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace Tune {
+
+/**
+ * @brief Significance a move must reach before the search leaves its current best point.
+ */
+constexpr double Alpha{0.05};
+/**
+ * @brief A faster-looking neighbour whose p-value is below this gets more samples before being
+ * rejected, so a real improvement isn't lost to a noisy first look.
+ */
+constexpr double Promising{0.3};
+/**
+ * @brief How many times a point's sample count may be doubled while deciding a move.
+ */
+constexpr int MaxRefinements{2};
+
+/**
+ * @brief One tunable parameter: a name used as {name} in the command and its ordered values.
+ */
+struct Dimension {
+    std::string name{};
+    std::vector<std::string> values{};
+};
+
+/**
+ * @brief Parse 'name=lo..hi' (integers) or 'name=a|b|c', comma-separated for several dimensions.
+ */
+inline bool parseSpace(const std::string& spec, std::vector<Dimension>& space) {
+    std::istringstream list{spec};
+    for (std::string item{}; std::getline(list, item, ',');) {
+        const size_t eq{item.find('=')};
+        if (eq == std::string::npos || eq == 0 || eq + 1 == item.size()) {
+            Suite::printError("--space expects name=lo..hi or name=a|b|c (got '" + item + "')");
+            return false;
+        }
+
+        Dimension dim{item.substr(0, eq), {}};
+        const std::string range{item.substr(eq + 1)};
+        const size_t dots{range.find("..")};
+        if (dots != std::string::npos) {
+            char* end{nullptr};
+            const long lo{std::strtol(range.c_str(), &end, 10)};
+            const bool loOk{end == range.c_str() + dots};
+            const long hi{std::strtol(range.c_str() + dots + 2, &end, 10)};
+            if (!loOk || *end != '\0' || hi < lo || hi - lo > 100000) {
+                Suite::printError("Invalid range for '" + dim.name + "': '" + range + "'");
+                return false;
+            }
+            for (long v{lo}; v <= hi; ++v) {
+                dim.values.push_back(std::to_string(v));
+            }
+        } else {
+            std::istringstream values{range};
+            for (std::string value{}; std::getline(values, value, '|');) {
+                dim.values.push_back(value);
+            }
+        }
+
+        for (const auto& other : space) {
+            if (other.name == dim.name) {
+                Suite::printError("Parameter '" + dim.name + "' is given twice in --space");
+                return false;
+            }
+        }
+        space.push_back(std::move(dim));
+    }
+    return !space.empty();
+}
+
+using Point = std::vector<size_t>;
+
+struct Evaluation {
+    Point point{};
+    std::string command{};
+    std::vector<uint64_t> wallNs{};
+    bool failed{false};
+
+    double meanMs() const {
+        return Statistics::mean(wallNs) / 1e6;
+    }
+    double ci95Ms() const {
+        return Statistics::confidenceHalfWidth(wallNs) / 1e6;
+    }
+};
+
+struct Outcome {
+    std::vector<Evaluation> evaluated{};
+    size_t best{0};
+    int moves{0};
+    bool exhausted{false}; // stopped by the evaluation budget rather than convergence
+    bool interrupted{false};
+};
+
+/**
+ * @brief Noise-aware coordinate descent over a discrete space. From the centre, it tries the
+ * current best point moved by ±step along each dimension and moves only when a one-sided Welch
+ * test says the neighbour is faster. Promising-but-unproven neighbours get more samples first.
+ * When a full sweep finds no move, the steps halve; it stops at step 1 everywhere, or when
+ * maxEvals distinct points have been measured.
+ */
+class Search {
+  private:
+    const std::string templ;
+    const std::vector<Dimension>& space;
+    const BenchmarkConfig& base;
+    const Exec::Mode mode;
+    const int perPoint;
+    const int maxEvals;
+    Outcome outcome{};
+    std::map<Point, size_t> index{};
+
+    std::string commandFor(const Point& point) const {
+        std::string command{templ};
+        for (size_t d{0}; d < space.size(); ++d) {
+            command = Suite::replaceAll(command, "{" + space[d].name + "}",
+                                        space[d].values[point[d]]);
+        }
+        return command;
+    }
+
+    /**
+     * @brief Take n more samples of an evaluated point.
+     */
+    void sample(size_t i, int n) {
+        Evaluation& e{outcome.evaluated[i]};
+        BenchmarkConfig config{base};
+        config.quiet = true;
+        config.command = e.command;
+        config.iterations = n;
+        config.cache = nullptr;
+        config.journal = nullptr;
+        config.live = nullptr;
+        config.resumed.clear();
+
+        if (!config.useShell) {
+            config.cmdArgs = parseCommand(e.command);
+            if (config.cmdArgs.empty()) {
+                e.failed = true;
+                return;
+            }
+#ifdef __linux__
+            auto image{std::make_shared<Exec::Image>()};
+            if (!Exec::prepare(*image, config.cmdArgs, mode)) {
+                e.failed = true;
+                return;
+            }
+            config.image = image;
+#endif
+        }
+
+        const BenchmarkResults r{runBenchmark(config)};
+        if (r.reservationFailed || r.failed()) {
+            e.failed = true;
+            return;
+        }
+        const auto measured{r.wallNs()};
+        e.wallNs.insert(e.wallNs.end(), measured.begin(), measured.end());
+    }
+
+    /**
+     * @return The point's evaluation index, measuring it first if it is new; npos when the
+     * budget is spent.
+     */
+    size_t evaluate(const Point& point) {
+        auto it{index.find(point)};
+        if (it != index.end()) {
+            return it->second;
+        }
+        if (static_cast<int>(outcome.evaluated.size()) >= maxEvals) {
+            outcome.exhausted = true;
+            return std::string::npos;
+        }
+
+        const size_t i{outcome.evaluated.size()};
+        outcome.evaluated.push_back({point, commandFor(point), {}, false});
+        index[point] = i;
+        sample(i, perPoint);
+
+        if (!base.quiet) {
+            const Evaluation& e{outcome.evaluated[i]};
+            std::cout << "  " << Colors::Dim << "[" << std::setw(3) << i + 1 << "] "
+                      << Colors::Reset << e.command << Colors::Dim;
+            if (e.failed || e.wallNs.empty()) {
+                std::cout << "  failed";
+            } else {
+                std::cout << "  μ=" << std::fixed << std::setprecision(3)
+                          << e.meanMs() << " ms";
+            }
+            std::cout << Colors::Reset << "\n" << std::flush;
+        }
+        return i;
+    }
+
+    /**
+     * @brief Whether candidate is significantly faster than the incumbent, refining both when the
+     * first look is promising but inconclusive.
+     */
+    bool faster(size_t candidate, size_t incumbent) {
+        for (int round{0};; ++round) {
+            const auto& c{outcome.evaluated[candidate].wallNs};
+            const auto& b{outcome.evaluated[incumbent].wallNs};
+            if (c.size() < 2 || Statistics::mean(c) >= Statistics::mean(b)) {
+                return false;
+            }
+            const double p{Tournament::slowerPValue(b, c)};
+            if (p < Alpha) {
+                return true;
+            }
+            if (p >= Promising || round >= MaxRefinements || interruptRequested) {
+                return false;
+            }
+            const size_t target{c.size() * 2};
+            sample(candidate, static_cast<int>(c.size()));
+            if (b.size() < target) {
+                sample(incumbent, static_cast<int>(target - b.size()));
+            }
+        }
+    }
+
+  public:
+    Search(std::string commandTemplate, const std::vector<Dimension>& dimensions,
+           const BenchmarkConfig& config, Exec::Mode execMode, int samplesPerPoint,
+           int evaluationBudget)
+        : templ{std::move(commandTemplate)}, space{dimensions}, base{config}, mode{execMode},
+          perPoint{samplesPerPoint}, maxEvals{evaluationBudget} {}
+
+    Outcome run() {
+        Point current(space.size());
+        std::vector<size_t> step(space.size());
+        for (size_t d{0}; d < space.size(); ++d) {
+            current[d] = (space[d].values.size() - 1) / 2;
+            step[d] = std::max<size_t>(1, space[d].values.size() / 4);
+        }
+
+        size_t best{evaluate(current)};
+        if (best == std::string::npos || outcome.evaluated[best].failed) {
+            outcome.best = 0;
+            return outcome;
+        }
+
+        while (!interruptRequested && !outcome.exhausted) {
+            bool moved{false};
+            for (size_t d{0}; d < space.size() && !interruptRequested; ++d) {
+                for (int direction : {-1, 1}) {
+                    Point next{current};
+                    if (direction < 0 && next[d] < step[d]) {
+                        continue;
+                    }
+                    next[d] = direction < 0 ? next[d] - step[d] : next[d] + step[d];
+                    if (next[d] >= space[d].values.size()) {
+                        continue;
+                    }
+
+                    const size_t i{evaluate(next)};
+                    if (i == std::string::npos) {
+                        break;
+                    }
+                    if (!outcome.evaluated[i].failed && faster(i, best)) {
+                        best = i;
+                        current = next;
+                        moved = true;
+                        ++outcome.moves;
+                        break; // keep going along the improved point's other dimensions
+                    }
+                }
+            }
+
+            if (moved) {
+                continue;
+            }
+            bool refined{false};
+            for (auto& s : step) {
+                if (s > 1) {
+                    s /= 2;
+                    refined = true;
+                }
+            }
+            if (!refined) {
+                break; // converged: no single step improves on the best point
+            }
+        }
+
+        outcome.best = best;
+        outcome.interrupted = interruptRequested != 0;
+        return outcome;
+    }
+};
+
+inline std::string describe(const std::vector<Dimension>& space, const Point& point) {
+    std::string text{};
+    for (size_t d{0}; d < space.size(); ++d) {
+        text += (d > 0 ? " " : "") + space[d].name + "=" + space[d].values[point[d]];
+    }
+    return text;
+}
+
+/**
+ * @brief Evaluated points ordered by mean, failures last.
+ */
+inline std::vector<size_t> ranking(const Outcome& outcome) {
+    std::vector<size_t> order{};
+    for (size_t i{0}; i < outcome.evaluated.size(); ++i) {
+        order.push_back(i);
+    }
+    auto key{[&](size_t i) {
+        const Evaluation& e{outcome.evaluated[i]};
+        return e.failed || e.wallNs.empty() ? 1e300 : Statistics::mean(e.wallNs);
+    }};
+    std::stable_sort(order.begin(), order.end(),
+                     [&](size_t a, size_t b) { return key(a) < key(b); });
+    return order;
+}
+
+inline size_t spaceSize(const std::vector<Dimension>& space) {
+    size_t total{1};
+    for (const auto& d : space) {
+        total *= d.values.size();
+    }
+    return total;
+}
+
+inline void display(const std::vector<Dimension>& space, const Outcome& outcome) {
+    const Evaluation& best{outcome.evaluated[outcome.best]};
+    std::cout << "\n"
+              << Colors::Bold << Colors::BrightWhite << "Tuning result: " << Colors::Reset
+              << Colors::Dim << outcome.evaluated.size() << " of " << spaceSize(space)
+              << " configurations measured, " << outcome.moves << " moves"
+              << (outcome.exhausted ? ", evaluation budget reached" : ", converged")
+              << Colors::Reset << "\n";
+    std::cout << "  " << Colors::BrightGreen << "★ " << Colors::Bold << describe(space, best.point)
+              << Colors::Reset << Colors::BrightGreen << "  μ=" << std::fixed
+              << std::setprecision(3) << best.meanMs() << " ± " << best.ci95Ms() << " ms"
+              << Colors::Reset << Colors::Dim << " (95% CI, " << best.wallNs.size() << " samples)"
+              << Colors::Reset << "\n";
+    std::cout << "  " << Colors::Dim << best.command << Colors::Reset << "\n";
+    if (outcome.interrupted) {
+        std::cout << "  " << Colors::BrightYellow << "⚠ " << Colors::Reset
+                  << "interrupted; this is the best point so far\n";
+    }
+
+    std::cout << "\n"
+              << Colors::Bold << "  Explored (fastest first):" << Colors::Reset << "\n";
+    for (size_t i : ranking(outcome)) {
+        const Evaluation& e{outcome.evaluated[i]};
+        std::cout << "  " << (i == outcome.best ? Colors::BrightGreen : Colors::White)
+                  << std::left << std::setw(32) << describe(space, e.point) << std::right
+                  << Colors::Reset;
+        if (e.failed || e.wallNs.empty()) {
+            std::cout << Colors::BrightRed << "  failed" << Colors::Reset << "\n";
+            continue;
+        }
+        std::cout << std::fixed << std::setprecision(3) << std::setw(10)
+                  << e.meanMs() << " ± " << std::setw(7) << e.ci95Ms() << " ms" << Colors::Dim
+                  << std::setw(6) << e.wallNs.size() << " samples";
+        if (i != outcome.best) {
+            const double p{Tournament::slowerPValue(e.wallNs, best.wallNs)};
+            std::cout << (p < Alpha ? "  slower" : "  not separable") << " (p="
+                      << std::setprecision(3) << p << ")";
+        }
+        std::cout << Colors::Reset << "\n";
+    }
+    std::cout << "\n";
+}
+
+inline std::string toJson(const std::string& templ, const std::vector<Dimension>& space,
+                          const Outcome& outcome) {
+    auto params{[&](const Point& point) {
+        std::string text{"{"};
+        for (size_t d{0}; d < space.size(); ++d) {
+            text += (d > 0 ? ", \"" : "\"") + BenchmarkResults::escapeJson(space[d].name) +
+                    "\": \"" + BenchmarkResults::escapeJson(space[d].values[point[d]]) + "\"";
+        }
+        return text + "}";
+    }};
+
+    const Evaluation& best{outcome.evaluated[outcome.best]};
+    std::ostringstream json{};
+    json << std::fixed << std::setprecision(3) << "{\n"
+         << "  \"template\": \"" << BenchmarkResults::escapeJson(templ) << "\",\n"
+         << "  \"space_size\": " << spaceSize(space) << ",\n"
+         << "  \"evaluations\": " << outcome.evaluated.size() << ",\n"
+         << "  \"converged\": " << (outcome.exhausted || outcome.interrupted ? "false" : "true")
+         << ",\n"
+         << "  \"best\": {\"params\": " << params(best.point) << ", \"command\": \""
+         << BenchmarkResults::escapeJson(best.command)
+         << "\", \"mean_ms\": " << best.meanMs() << ", \"ci95_ms\": " << best.ci95Ms()
+         << ", \"samples\": " << best.wallNs.size() << "},\n"
+         << "  \"explored\": [";
+
+    bool first{true};
+    for (size_t i : ranking(outcome)) {
+        const Evaluation& e{outcome.evaluated[i]};
+        json << (first ? "\n" : ",\n") << "    {\"params\": " << params(e.point);
+        first = false;
+        if (e.failed || e.wallNs.empty()) {
+            json << ", \"failed\": true}";
+            continue;
+        }
+        json << ", \"mean_ms\": " << e.meanMs() << ", \"ci95_ms\": " << e.ci95Ms()
+             << ", \"samples\": " << e.wallNs.size() << ", \"p_value_vs_best\": "
+             << std::defaultfloat << std::setprecision(6)
+             << (i == outcome.best ? 1.0 : Tournament::slowerPValue(e.wallNs, best.wallNs))
+             << std::fixed << std::setprecision(3) << "}";
+    }
+    json << "\n  ]\n"
+         << "}\n";
+    return json.str();
+}
+
+} // namespace Tune
+
+#endif
@@ -2,20 +2,36 @@
 #define VAJRA_HPP
 
 #include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
 #include <chrono>
 #include <cmath>
+#include <concepts>
+#include <cstdint>
+#include <cstdio>
+#include <deque>
 #include <functional>
 #include <iomanip>
 #include <iostream>
+#include <iterator>
+#include <limits>
 #include <map>
+#include <memory>
+#include <mutex>
+#include <new>
 #include <numeric>
+#include <ranges>
+#include <span>
+#include <sstream>
 #include <string>
+#include <thread>
 #include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 #ifdef __linux__
 #include <fstream>
-#include <sstream>
 #include <sys/resource.h>
 #endif
 
@@ -40,127 +56,125 @@ template <typename T>
 concept Numeric = std::is_arithmetic_v<T>;
 
 /**
- * @brief Calculate the mean (average) of a vector of numeric values.
- * @tparam T The numeric type of the values.
- * @param values The vector of numeric values.
+ * @brief Concept for contiguous ranges of numeric values. Vectors, arrays, spans and SampleSet
+ * columns are all accepted as they are, without copying.
+ * @tparam R The range type to be checked.
+ */
+template <typename R>
+concept NumericRange = std::ranges::contiguous_range<R> && std::ranges::sized_range<R> &&
+                       Numeric<std::ranges::range_value_t<R>>;
+
+/**
+ * @brief Calculate the mean (average) of a range of numeric values.
+ * @tparam R The range type (vector, span, column...).
+ * @param values The numeric values.
  * @return The mean of the values as a double.
  */
-template <Numeric T>
-inline double mean(const std::vector<T>& values)
-    requires(std::is_integral_v<T> || std::is_floating_point_v<T>)
-{
-    if (values.empty())
+template <NumericRange R> inline double mean(const R& values) {
+    if (std::ranges::empty(values))
         return 0.0;
 
-    const double sum{std::accumulate(values.begin(), values.end(), 0.0,
-                                     [](double acc, T v) { return acc + static_cast<double>(v); })};
+    const double total{std::accumulate(
+        std::ranges::begin(values), std::ranges::end(values), 0.0,
+        [](double acc, std::ranges::range_value_t<R> v) { return acc + static_cast<double>(v); })};
 
-    return sum / static_cast<double>(values.size());
+    return total / static_cast<double>(std::ranges::size(values));
 }
 
 /**
- * @brief Calculate the median of a vector of numeric values.
- * @tparam T The numeric type of the values.
- * @param values The vector of numeric values.
+ * @brief Calculate the median of a range of numeric values.
+ * @tparam R The range type (vector, span, column...).
+ * @param values The numeric values.
  * @return The median of the values as a double.
  */
-template <Numeric T>
-inline double median(std::vector<T> values)
-    requires(std::is_integral_v<T> || std::is_floating_point_v<T>)
-{
-    if (values.empty())
+template <NumericRange R> inline double median(const R& values) {
+    if (std::ranges::empty(values))
         return 0.0;
 
-    std::sort(values.begin(), values.end());
+    // Sorting needs a copy; the caller's data is left untouched
+    std::vector<std::ranges::range_value_t<R>> sorted(std::ranges::begin(values),
+                                                      std::ranges::end(values));
+    std::sort(sorted.begin(), sorted.end());
 
-    const std::size_t count{values.size()};
+    const std::size_t count{sorted.size()};
     const std::size_t mid{count / 2};
 
     if ((count & 1) == 0) {
-        return (static_cast<double>(values[mid - 1]) + static_cast<double>(values[mid])) * 0.5;
+        return (static_cast<double>(sorted[mid - 1]) + static_cast<double>(sorted[mid])) * 0.5;
     }
 
-    return static_cast<double>(values[mid]);
+    return static_cast<double>(sorted[mid]);
 }
 
 /**
- * @brief Calculate the variance of a vector of numeric values.
- * @tparam T The numeric type of the values.
- * @param values The vector of numeric values.
+ * @brief Calculate the variance of a range of numeric values.
+ * @tparam R The range type (vector, span, column...).
+ * @param values The numeric values.
  * @return The variance of the values as a double.
  */
-template <Numeric T>
-inline double variance(const std::vector<T>& values)
-    requires(std::is_integral_v<T> || std::is_floating_point_v<T>)
-{
-    if (values.size() < 2)
+template <NumericRange R> inline double variance(const R& values) {
+    if (std::ranges::size(values) < 2)
         return 0.0;
 
     const double avg{mean(values)};
     double var{0.0};
 
-    for (const T v : values) {
+    for (const auto v : values) {
         const double diff{static_cast<double>(v) - avg};
         var += diff * diff;
     }
 
-    return var / static_cast<double>(values.size());
+    return var / static_cast<double>(std::ranges::size(values));
 }
 
 /**
- * @brief Calculate the standard deviation of a vector of numeric values.
- * @tparam T The numeric type of the values.
- * @param values The vector of numeric values.
+ * @brief Calculate the standard deviation of a range of numeric values.
+ * @tparam R The range type (vector, span, column...).
+ * @param values The numeric values.
  * @return The standard deviation of the values as a double.
  */
-template <Numeric T>
-inline double stddev(const std::vector<T>& values)
-    requires(std::is_integral_v<T> || std::is_floating_point_v<T>)
-{
-    if (values.size() < 2)
+template <NumericRange R> inline double stddev(const R& values) {
+    if (std::ranges::size(values) < 2)
         return 0.0;
 
     return std::sqrt(variance(values));
 }
 
 /**
- * @brief Find the minimum value in a vector of numeric values.
- * @tparam T The numeric type of the values.
- * @param values The vector of numeric values.
- * @return The minimum value in the vector.
+ * @brief Find the minimum value in a range of numeric values.
+ * @tparam R The range type (vector, span, column...).
+ * @param values The numeric values.
+ * @return The minimum value in the range.
  */
-template <Numeric T> inline T min(const std::vector<T>& values) {
-    if (values.empty())
-        return T{};
+template <NumericRange R> inline std::ranges::range_value_t<R> min(const R& values) {
+    if (std::ranges::empty(values))
+        return {};
 
-    return *std::min_element(values.begin(), values.end());
+    return *std::ranges::min_element(values);
 }
 
 /**
- * @brief Find the maximum value in a vector of numeric values.
- * @tparam T The numeric type of the values.
- * @param values The vector of numeric values.
- * @return The maximum value in the vector.
+ * @brief Find the maximum value in a range of numeric values.
+ * @tparam R The range type (vector, span, column...).
+ * @param values The numeric values.
+ * @return The maximum value in the range.
  */
-template <Numeric T> inline T max(const std::vector<T>& values) {
-    if (values.empty())
-        return T{};
+template <NumericRange R> inline std::ranges::range_value_t<R> max(const R& values) {
+    if (std::ranges::empty(values))
+        return {};
 
-    return *std::max_element(values.begin(), values.end());
+    return *std::ranges::max_element(values);
 }
 
 /**
- * @brief Calculate the percentile of a vector of numeric values.
- * @tparam T The numeric type of the values.
- * @param values The vector of numeric values.
+ * @brief Calculate the percentile of a range of numeric values.
+ * @tparam R The range type (vector, span, column...).
+ * @param values The numeric values.
  * @param p The percentile (0-100).
  * @return The percentile value as a double.
  */
-template <Numeric T>
-inline double percentile(std::vector<T> values, double p)
-    requires(std::is_integral_v<T> || std::is_floating_point_v<T>)
-{
-    if (values.empty())
+template <NumericRange R> inline double percentile(const R& values, double p) {
+    if (std::ranges::empty(values))
         return 0.0;
 
     if (p < 0.0)
@@ -168,58 +182,653 @@ inline double percentile(std::vector<T> values, double p)
     if (p > 100.0)
         p = 100.0;
 
-    std::sort(values.begin(), values.end());
+    std::vector<std::ranges::range_value_t<R>> sorted(std::ranges::begin(values),
+                                                      std::ranges::end(values));
+    std::sort(sorted.begin(), sorted.end());
 
-    const double index{(p / 100.0) * (values.size() - 1)};
+    const double index{(p / 100.0) * (sorted.size() - 1)};
     const size_t lower{static_cast<size_t>(std::floor(index))};
     const size_t upper{static_cast<size_t>(std::ceil(index))};
 
     if (lower == upper) {
-        return static_cast<double>(values[lower]);
+        return static_cast<double>(sorted[lower]);
     }
 
     const double weight{index - lower};
-    return static_cast<double>(values[lower]) * (1.0 - weight) +
-           static_cast<double>(values[upper]) * weight;
+    return static_cast<double>(sorted[lower]) * (1.0 - weight) +
+           static_cast<double>(sorted[upper]) * weight;
 }
 
 /**
- * @brief Calculate the range of a vector of numeric values.
- * @tparam T The numeric type of the values.
- * @param values The vector of numeric values.
+ * @brief Calculate the spread (max - min) of a range of numeric values.
+ * @tparam R The range type (vector, span, column...).
+ * @param values The numeric values.
  * @return The range (max - min) of the values.
  */
-template <Numeric T> inline T range(const std::vector<T>& values) {
-    if (values.empty())
-        return T{};
+template <NumericRange R> inline std::ranges::range_value_t<R> range(const R& values) {
+    if (std::ranges::empty(values))
+        return {};
 
     return max(values) - min(values);
 }
 
 /**
- * @brief Calculate the sum of a vector of numeric values.
- * @tparam T The numeric type of the values.
- * @param values The vector of numeric values.
+ * @brief Calculate the sum of a range of numeric values.
+ * @tparam R The range type (vector, span, column...).
+ * @param values The numeric values.
  * @return The sum of the values as a double.
  */
-template <Numeric T>
-inline double sum(const std::vector<T>& values)
-    requires(std::is_integral_v<T> || std::is_floating_point_v<T>)
-{
-    return std::accumulate(values.begin(), values.end(), 0.0,
-                           [](double acc, T v) { return acc + static_cast<double>(v); });
+template <NumericRange R> inline double sum(const R& values) {
+    return std::accumulate(
+        std::ranges::begin(values), std::ranges::end(values), 0.0,
+        [](double acc, std::ranges::range_value_t<R> v) { return acc + static_cast<double>(v); });
+}
+
+/**
+ * @brief Regularized incomplete beta function I_x(a, b), by Lentz's continued fraction.
+ * @param a First shape parameter (> 0).
+ * @param b Second shape parameter (> 0).
+ * @param x Upper limit of integration, in [0, 1].
+ * @return I_x(a, b).
+ */
+inline double incompleteBeta(double a, double b, double x) {
+    if (x <= 0.0)
+        return 0.0;
+    if (x >= 1.0)
+        return 1.0;
+
+    // The continued fraction converges quickly only below the mean; use symmetry above it
+    if (x > (a + 1.0) / (a + b + 2.0)) {
+        return 1.0 - incompleteBeta(b, a, 1.0 - x);
+    }
+
+    const double front{std::exp(std::lgamma(a + b) - std::lgamma(a) - std::lgamma(b) +
+                                a * std::log(x) + b * std::log(1.0 - x)) /
+                       a};
+    constexpr double tiny{1e-30};
+    double f{1.0};
+    double c{1.0};
+    double d{0.0};
+
+    for (int i{0}; i <= 200; ++i) {
+        const int m{i / 2};
+        double numerator{1.0};
+        if (i > 0 && (i & 1) == 0) {
+            numerator = (m * (b - m) * x) / ((a + 2.0 * m - 1.0) * (a + 2.0 * m));
+        } else if (i > 0) {
+            numerator = -((a + m) * (a + b + m) * x) / ((a + 2.0 * m) * (a + 2.0 * m + 1.0));
+        }
+
+        d = 1.0 + numerator * d;
+        d = 1.0 / (std::fabs(d) < tiny ? tiny : d);
+        c = 1.0 + numerator / c;
+        c = std::fabs(c) < tiny ? tiny : c;
+        const double delta{c * d};
+        f *= delta;
+        if (std::fabs(1.0 - delta) < 1e-10) {
+            break;
+        }
+    }
+
+    return front * (f - 1.0);
+}
+
+/**
+ * @brief Two-sided p-value of Student's t distribution.
+ * @param t The t statistic.
+ * @param df Degrees of freedom.
+ * @return P(|T| >= |t|).
+ */
+inline double studentTPValue(double t, double df) {
+    if (df <= 0.0)
+        return 1.0;
+
+    return incompleteBeta(df / 2.0, 0.5, df / (df + t * t));
+}
+
+/**
+ * @brief Outcome of Welch's unequal-variance t-test.
+ */
+struct WelchResult {
+    double t{0.0};
+    double df{0.0};
+    double pValue{1.0};
+};
+
+/**
+ * @brief Welch's t-test for a difference in means between two independent samples.
+ * @tparam A, B The range types (vector, span, column...).
+ * @param a The first sample.
+ * @param b The second sample.
+ * @return The t statistic (positive when a's mean is larger), degrees of freedom and p-value.
+ */
+template <NumericRange A, NumericRange B>
+inline WelchResult welchTest(const A& a, const B& b) {
+    WelchResult result{};
+    if (std::ranges::size(a) < 2 || std::ranges::size(b) < 2)
+        return result;
+
+    const double na{static_cast<double>(std::ranges::size(a))};
+    const double nb{static_cast<double>(std::ranges::size(b))};
+    // Squared standard errors; variance() divides by n, so s^2/n is variance()/(n-1)
+    const double va{variance(a) / (na - 1.0)};
+    const double vb{variance(b) / (nb - 1.0)};
+    const double se{std::sqrt(va + vb)};
+
+    if (se == 0.0) {
+        result.pValue = mean(a) == mean(b) ? 1.0 : 0.0;
+        return result;
+    }
+
+    result.t = (mean(a) - mean(b)) / se;
+    result.df = (va + vb) * (va + vb) / (va * va / (na - 1.0) + vb * vb / (nb - 1.0));
+    result.pValue = studentTPValue(result.t, result.df);
+    return result;
+}
+
+/**
+ * @brief Half-width of the confidence interval of the mean, using the normal approximation.
+ * @tparam R The range type (vector, span, column...).
+ * @param values The numeric values.
+ * @param z Critical value (1.96 for 95%).
+ * @return z times the standard error of the mean.
+ */
+template <NumericRange R> inline double confidenceHalfWidth(const R& values, double z = 1.96) {
+    if (std::ranges::size(values) < 2)
+        return 0.0;
+
+    const double n{static_cast<double>(std::ranges::size(values))};
+    return z * std::sqrt(variance(values) / (n - 1.0));
+}
+
+/**
+ * @brief Distribution-free confidence interval of a percentile, from order statistics. The ranks
+ * bracketing the percentile are chosen with the normal approximation to the binomial, so no
+ * assumption is made about the shape of the data.
+ * @tparam R The range type (vector, span, column...).
+ * @param values The numeric values.
+ * @param p The percentile (0-100).
+ * @param low Set to the lower bound, or -infinity if the sample is too small to give one.
+ * @param high Set to the upper bound, or +infinity if the sample is too small to give one.
+ * @param z Critical value (1.96 for 95%).
+ */
+template <NumericRange R>
+inline void percentileBounds(const R& values, double p, double& low, double& high,
+                             double z = 1.96) {
+    low = -std::numeric_limits<double>::infinity();
+    high = std::numeric_limits<double>::infinity();
+    if (std::ranges::empty(values))
+        return;
+
+    std::vector<std::ranges::range_value_t<R>> sorted(std::ranges::begin(values),
+                                                      std::ranges::end(values));
+    std::sort(sorted.begin(), sorted.end());
+
+    const double n{static_cast<double>(sorted.size())};
+    const double q{std::clamp(p / 100.0, 0.0, 1.0)};
+    const double spread{z * std::sqrt(n * q * (1.0 - q))};
+    // 1-based ranks of the order statistics that bracket the percentile
+    const double lowRank{std::floor(n * q - spread)};
+    const double highRank{std::max(1.0, std::ceil(n * q + spread))};
+
+    if (lowRank >= 1.0) {
+        low = static_cast<double>(sorted[static_cast<size_t>(lowRank) - 1]);
+    }
+    if (highRank <= n) {
+        high = static_cast<double>(sorted[static_cast<size_t>(highRank) - 1]);
+    }
 }
 
 } // namespace Statistics
 
+namespace Samples {
+
+/**
+ * @brief Allocator that aligns storage to a cache line, so columns can be scanned with aligned
+ * vector loads and two columns never share a line.
+ * @tparam T The element type.
+ * @tparam Alignment Byte alignment (a power of two).
+ */
+template <typename T, std::size_t Alignment = 64> struct AlignedAllocator {
+    using value_type = T;
+
+    template <typename U> struct rebind {
+        using other = AlignedAllocator<U, Alignment>;
+    };
+
+    AlignedAllocator() noexcept = default;
+    template <typename U> AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+    T* allocate(std::size_t n) {
+        return static_cast<T*>(::operator new(n * sizeof(T), std::align_val_t{Alignment}));
+    }
+
+    void deallocate(T* p, std::size_t) noexcept {
+        ::operator delete(p, std::align_val_t{Alignment});
+    }
+
+    template <typename U> bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept {
+        return true;
+    }
+};
+
+/**
+ * @brief One cache-line aligned column of a SampleSet.
+ */
+template <typename T> using Column = std::vector<T, AlignedAllocator<T>>;
+
+/**
+ * @brief Well-known column names. Units are part of the name; any other name is allowed too.
+ */
+inline constexpr const char* WallNs{"wall_ns"};
+inline constexpr const char* CpuNs{"cpu_ns"};
+inline constexpr const char* MaxRssBytes{"max_rss_bytes"};
+inline constexpr const char* TimestampNs{"timestamp_ns"};
+
+/**
+ * @brief Marks a value a row lacks in an integer column; real columns use NaN.
+ */
+inline constexpr uint64_t Missing{std::numeric_limits<uint64_t>::max()};
+
+/**
+ * @brief The element types a column can have: exact integers (nanoseconds, bytes, counts) or
+ * doubles (anything fractional).
+ */
+template <typename T>
+concept ColumnType = std::same_as<T, uint64_t> || std::same_as<T, double>;
+
+/**
+ * @brief Per-iteration records stored column by column (structure of arrays). Every column has
+ * one value per row; a row that lacks a column holds Missing (integer columns) or NaN (real
+ * columns). Times are kept as integer nanoseconds and only converted for display, so sums are
+ * exact and sets from separate runs can be merged without rounding.
+ */
+class SampleSet {
+  private:
+    std::vector<std::string> names{};
+    std::vector<bool> integral{};     // per column: stored in integers (true) or reals (false)
+    std::vector<std::size_t> slots{}; // per column: index into integers or reals
+    std::vector<Column<uint64_t>> integers{};
+    std::vector<Column<double>> reals{};
+    std::size_t rowCount{0};
+
+    static constexpr char Magic[4]{'V', 'J', 'S', 'S'};
+    static constexpr uint32_t Version{2};
+
+    template <typename T> static void writeValue(std::ostream& out, T value) {
+        out.write(reinterpret_cast<const char*>(&value), sizeof(value));
+    }
+
+    template <typename T> static bool readValue(std::istream& in, T& value) {
+        return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(value)));
+    }
+
+    static void writeString(std::ostream& out, const std::string& text) {
+        writeValue(out, static_cast<uint32_t>(text.size()));
+        out.write(text.data(), static_cast<std::streamsize>(text.size()));
+    }
+
+    static bool readString(std::istream& in, std::string& text) {
+        uint32_t size{0};
+        if (!readValue(in, size) || size > (1u << 20)) {
+            return false;
+        }
+        text.resize(size);
+        return static_cast<bool>(in.read(text.data(), static_cast<std::streamsize>(size)));
+    }
+
+    /**
+     * @brief Bytes left in the stream, or the largest value if it can't seek to find out.
+     */
+    static uint64_t remainingBytes(std::istream& in) {
+        const std::istream::pos_type here{in.tellg()};
+        if (here == std::istream::pos_type(-1) || !in.seekg(0, std::ios::end)) {
+            in.clear();
+            return std::numeric_limits<uint64_t>::max();
+        }
+        const std::istream::pos_type end{in.tellg()};
+        in.seekg(here);
+        return end >= here ? static_cast<uint64_t>(end - here) : 0;
+    }
+
+    /**
+     * @brief Read 'rows' values, growing the column a chunk at a time so a corrupt row count on
+     * an unseekable stream fails at end of input instead of allocating it all up front.
+     */
+    template <typename T>
+    static bool readColumn(std::istream& in, Column<T>& column, std::size_t rows) {
+        constexpr std::size_t Chunk{1 << 16};
+        column.clear();
+        while (column.size() < rows) {
+            const std::size_t have{column.size()};
+            const std::size_t take{std::min(Chunk, rows - have)};
+            column.resize(have + take);
+            if (!in.read(reinterpret_cast<char*>(column.data() + have),
+                         static_cast<std::streamsize>(take * sizeof(T)))) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    static std::string escape(const std::string& text) {
+        std::string out{};
+        for (char c : text) {
+            if (c == '"' || c == '\\') {
+                out += '\\';
+                out += c;
+            } else if (static_cast<unsigned char>(c) < 0x20) {
+                char buffer[8];
+                std::snprintf(buffer, sizeof(buffer), "\\u%04x", c);
+                out += buffer;
+            } else {
+                out += c;
+            }
+        }
+        return out;
+    }
+
+  public:
+    /**
+     * @brief Free-form description of how the samples were taken (command, host, units...).
+     */
+    std::map<std::string, std::string> metadata{};
+
+    /**
+     * @brief Sentinel returned by find() for a column that does not exist.
+     */
+    static constexpr std::size_t npos{static_cast<std::size_t>(-1)};
+
+    /**
+     * @brief Add a column, or find it if it already exists (keeping its original type). Rows
+     * recorded before the column was added are missing.
+     * @tparam T uint64_t for an integer column, double for a real one.
+     * @param name The column name, e.g. WallNs.
+     * @return The column index, for set() and values().
+     */
+    template <ColumnType T = double> std::size_t define(const std::string& name) {
+        const std::size_t existing{find(name)};
+        if (existing != npos) {
+            return existing;
+        }
+        names.push_back(name);
+        integral.push_back(std::same_as<T, uint64_t>);
+        if constexpr (std::same_as<T, uint64_t>) {
+            slots.push_back(integers.size());
+            integers.emplace_back(rowCount, Missing);
+        } else {
+            slots.push_back(reals.size());
+            reals.emplace_back(rowCount, std::numeric_limits<double>::quiet_NaN());
+        }
+        return names.size() - 1;
+    }
+
+    /**
+     * @brief Index of a column, or npos.
+     */
+    std::size_t find(const std::string& name) const {
+        const auto it{std::find(names.begin(), names.end(), name)};
+        return it == names.end() ? npos : static_cast<std::size_t>(it - names.begin());
+    }
+
+    bool has(const std::string& name) const {
+        return find(name) != npos;
+    }
+
+    /**
+     * @brief True if the column stores integers.
+     */
+    bool isIntegral(std::size_t column) const {
+        return integral[column];
+    }
+
+    /**
+     * @brief Start a new row with every column missing until set.
+     */
+    void addRow() {
+        for (auto& column : integers) {
+            column.push_back(Missing);
+        }
+        for (auto& column : reals) {
+            column.push_back(std::numeric_limits<double>::quiet_NaN());
+        }
+        ++rowCount;
+    }
+
+    /**
+     * @brief Set an integer column of the most recent row.
+     */
+    void set(std::size_t column, uint64_t value) {
+        if (integral[column]) {
+            integers[slots[column]].back() = value;
+        } else {
+            reals[slots[column]].back() = static_cast<double>(value);
+        }
+    }
+
+    /**
+     * @brief Set a real column of the most recent row.
+     */
+    void set(std::size_t column, double value) {
+        if (integral[column]) {
+            integers[slots[column]].back() =
+                std::isnan(value) ? Missing : static_cast<uint64_t>(std::llround(value));
+        } else {
+            reals[slots[column]].back() = value;
+        }
+    }
+
+    void reserve(std::size_t rows) {
+        for (auto& column : integers) {
+            column.reserve(rows);
+        }
+        for (auto& column : reals) {
+            column.reserve(rows);
+        }
+    }
+
+    /**
+     * @brief Zero-copy view of a column, usable with every Statistics function.
+     * @tparam T The column's element type; a view of the other type is empty.
+     */
+    template <ColumnType T = double> std::span<const T> values(std::size_t column) const {
+        if (integral[column] != std::same_as<T, uint64_t>) {
+            return {};
+        }
+        if constexpr (std::same_as<T, uint64_t>) {
+            return {integers[slots[column]].data(), rowCount};
+        } else {
+            return {reals[slots[column]].data(), rowCount};
+        }
+    }
+
+    /**
+     * @brief Zero-copy view of a column by name; empty if there is no such column of type T.
+     */
+    template <ColumnType T = double> std::span<const T> column(const std::string& name) const {
+        const std::size_t index{find(name)};
+        return index == npos ? std::span<const T>{} : values<T>(index);
+    }
+
+    std::size_t rows() const {
+        return rowCount;
+    }
+
+    const std::vector<std::string>& columnNames() const {
+        return names;
+    }
+
+    bool empty() const {
+        return rowCount == 0;
+    }
+
+    /**
+     * @brief The set as one JSON object: metadata, then each column as an array (missing values
+     * as null).
+     */
+    std::string toJson() const {
+        std::ostringstream json{};
+        json.precision(17);
+        json << "{\"metadata\": {";
+        bool first{true};
+        for (const auto& [key, value] : metadata) {
+            json << (first ? "" : ", ") << "\"" << escape(key) << "\": \"" << escape(value)
+                 << "\"";
+            first = false;
+        }
+        json << "}, \"rows\": " << rowCount << ", \"columns\": {";
+        for (std::size_t c{0}; c < names.size(); ++c) {
+            json << (c > 0 ? ", " : "") << "\"" << escape(names[c]) << "\": [";
+            for (std::size_t row{0}; row < rowCount; ++row) {
+                json << (row > 0 ? ", " : "");
+                if (integral[c]) {
+                    const uint64_t value{integers[slots[c]][row]};
+                    if (value == Missing) {
+                        json << "null";
+                    } else {
+                        json << value;
+                    }
+                } else {
+                    const double value{reals[slots[c]][row]};
+                    if (std::isnan(value)) {
+                        json << "null";
+                    } else {
+                        json << value;
+                    }
+                }
+            }
+            json << "]";
+        }
+        json << "}}\n";
+        return json.str();
+    }
+
+    /**
+     * @brief Write the set in vajra's binary sample format: "VJSS", version, row and column
+     * counts, metadata as length-prefixed strings, then each column's name, a type byte ('u' for
+     * uint64_t, 'd' for double) and its raw values. Everything is in host byte order.
+     * @return False if the stream failed.
+     */
+    bool writeBinary(std::ostream& out) const {
+        out.write(Magic, sizeof(Magic));
+        writeValue(out, Version);
+        writeValue(out, static_cast<uint64_t>(rowCount));
+        writeValue(out, static_cast<uint32_t>(names.size()));
+        writeValue(out, static_cast<uint32_t>(metadata.size()));
+        for (const auto& [key, value] : metadata) {
+            writeString(out, key);
+            writeString(out, value);
+        }
+        for (std::size_t c{0}; c < names.size(); ++c) {
+            writeString(out, names[c]);
+            out.put(integral[c] ? 'u' : 'd');
+            if (integral[c]) {
+                out.write(reinterpret_cast<const char*>(integers[slots[c]].data()),
+                          static_cast<std::streamsize>(rowCount * sizeof(uint64_t)));
+            } else {
+                out.write(reinterpret_cast<const char*>(reals[slots[c]].data()),
+                          static_cast<std::streamsize>(rowCount * sizeof(double)));
+            }
+        }
+        return static_cast<bool>(out);
+    }
+
+    /**
+     * @brief Read a set written by writeBinary().
+     * @return False (leaving set empty) if the stream is not a sample set or is truncated.
+     */
+    static bool readBinary(std::istream& in, SampleSet& set) {
+        set = SampleSet{};
+        char magic[sizeof(Magic)]{};
+        uint32_t version{0};
+        uint64_t rows{0};
+        uint32_t columnCount{0};
+        uint32_t metadataCount{0};
+
+        in.read(magic, sizeof(magic));
+        if (!in || !std::equal(magic, magic + sizeof(magic), Magic) ||
+            !readValue(in, version) || version != Version || !readValue(in, rows) ||
+            !readValue(in, columnCount) || !readValue(in, metadataCount)) {
+            return false;
+        }
+
+        for (uint32_t i{0}; i < metadataCount; ++i) {
+            std::string key{}, value{};
+            if (!readString(in, key) || !readString(in, value)) {
+                set = SampleSet{};
+                return false;
+            }
+            set.metadata[key] = value;
+        }
+
+        // Every column holds rows 8-byte values, so a row count the rest of the input can't hold
+        // is corrupt; reject it before allocating anything
+        const uint64_t remaining{remainingBytes(in)};
+        if (rows > std::numeric_limits<std::size_t>::max() ||
+            (columnCount > 0 && rows > remaining / sizeof(uint64_t) / columnCount)) {
+            set = SampleSet{};
+            return false;
+        }
+
+        set.rowCount = static_cast<std::size_t>(rows);
+        for (uint32_t c{0}; c < columnCount; ++c) {
+            std::string name{};
+            char type{};
+            bool ok{readString(in, name) && in.get(type)};
+            if (ok && type == 'u') {
+                set.slots.push_back(set.integers.size());
+                set.integers.emplace_back();
+                ok = readColumn(in, set.integers.back(), set.rowCount);
+            } else if (ok && type == 'd') {
+                set.slots.push_back(set.reals.size());
+                set.reals.emplace_back();
+                ok = readColumn(in, set.reals.back(), set.rowCount);
+            } else {
+                ok = false;
+            }
+            if (!ok) {
+                set = SampleSet{};
+                return false;
+            }
+            set.names.push_back(std::move(name));
+            set.integral.push_back(type == 'u');
+        }
+        return true;
+    }
+};
+
+/**
+ * @brief The values of a column that are present. When none are missing this is the column
+ * itself, with no copy; otherwise the present values are gathered into scratch.
+ */
+template <ColumnType T>
+inline std::span<const T> present(std::span<const T> column, std::vector<T>& scratch) {
+    auto isPresent{[](T v) {
+        if constexpr (std::same_as<T, uint64_t>) {
+            return v != Missing;
+        } else {
+            return !std::isnan(v);
+        }
+    }};
+    if (std::all_of(column.begin(), column.end(), isPresent)) {
+        return column;
+    }
+    scratch.clear();
+    std::copy_if(column.begin(), column.end(), std::back_inserter(scratch), isPresent);
+    return scratch;
+}
+
+} // namespace Samples
+
 namespace Timer {
 
 /**
- * @brief Type alias for high-resolution clock
+ * @brief The clock every timing uses. Monotonic: high_resolution_clock may be system_clock (it is
+ * in libstdc++), which steps backwards when the wall clock is adjusted.
  */
-using Clock = std::chrono::high_resolution_clock;
+using Clock = std::chrono::steady_clock;
 /**
- * @brief Type alias for time points based on the high-resolution clock
+ * @brief Type alias for time points based on Clock
  */
 using TimePoint = std::chrono::time_point<Clock>;
 
@@ -263,12 +872,7 @@ class Timer {
      * @return Elapsed time in seconds.
      */
     double elapsedSeconds() const {
-        if (!started)
-            return 0.0;
-
-        TimePoint end{running ? Clock::now() : endTime};
-        auto duration{std::chrono::duration_cast<std::chrono::nanoseconds>(end - startTime)};
-        return static_cast<double>(duration.count()) / 1e9;
+        return static_cast<double>(elapsedNanoseconds()) / 1e9;
     }
 
     /**
@@ -276,7 +880,7 @@ class Timer {
      * @return Elapsed time in milliseconds.
      */
     double elapsedMilliseconds() const {
-        return elapsedSeconds() * 1000.0;
+        return static_cast<double>(elapsedNanoseconds()) / 1e6;
     }
 
     /**
@@ -284,20 +888,21 @@ class Timer {
      * @return Elapsed time in microseconds.
      */
     double elapsedMicroseconds() const {
-        return elapsedSeconds() * 1e6;
+        return static_cast<double>(elapsedNanoseconds()) / 1e3;
     }
 
     /**
-     * @brief Get the elapsed time in nanoseconds.
-     * @return Elapsed time in nanoseconds.
+     * @brief Get the elapsed time in nanoseconds, exactly as the clock counted it. The other
+     * units are derived from this for display.
+     * @return Elapsed time in integer nanoseconds.
      */
-    double elapsedNanoseconds() const {
+    uint64_t elapsedNanoseconds() const {
         if (!started)
-            return 0.0;
+            return 0;
 
         TimePoint end{running ? Clock::now() : endTime};
         auto duration{std::chrono::duration_cast<std::chrono::nanoseconds>(end - startTime)};
-        return static_cast<double>(duration.count());
+        return static_cast<uint64_t>(duration.count());
     }
 
     /**
@@ -366,6 +971,450 @@ class ScopedTimer {
 
 } // namespace Timer
 
+namespace Latency {
+
+/**
+ * @brief Sub-buckets per power of two: 2^5 = 32, so any recorded value is reported within about
+ * 3% of its true value, from 1 ns up to 2^64 ns.
+ */
+constexpr unsigned SubBucketBits{5};
+constexpr std::size_t SubBuckets{std::size_t{1} << SubBucketBits};
+constexpr std::size_t BucketCount{(64 - SubBucketBits + 1) * SubBuckets};
+
+/**
+ * @brief Log-linear bucket of a value: values below SubBuckets get a bucket each, above that the
+ * exponent picks a power of two and the next SubBucketBits bits pick the sub-bucket. Integer bit
+ * operations only, no logarithms.
+ */
+inline std::size_t bucketOf(uint64_t ns) {
+    if (ns < SubBuckets) {
+        return static_cast<std::size_t>(ns);
+    }
+    const unsigned shift{static_cast<unsigned>(std::bit_width(ns)) - 1 - SubBucketBits};
+    return (shift + 1) * SubBuckets + static_cast<std::size_t>((ns >> shift) & (SubBuckets - 1));
+}
+
+/**
+ * @brief Smallest value that falls in a bucket.
+ */
+inline uint64_t lowestOf(std::size_t bucket) {
+    if (bucket < SubBuckets) {
+        return bucket;
+    }
+    const unsigned shift{static_cast<unsigned>(bucket / SubBuckets) - 1};
+    return (static_cast<uint64_t>(SubBuckets | (bucket % SubBuckets))) << shift;
+}
+
+/**
+ * @brief Number of values a bucket covers.
+ */
+inline uint64_t widthOf(std::size_t bucket) {
+    return bucket < 2 * SubBuckets ? 1 : uint64_t{1} << (bucket / SubBuckets - 1);
+}
+
+/**
+ * @brief Mergeable latency histogram over integer nanoseconds. Counts and the sum are exact, so
+ * histograms from different threads or intervals add up to the same result in any order.
+ */
+class Histogram {
+  private:
+    std::vector<uint64_t> counts = std::vector<uint64_t>(BucketCount);
+    uint64_t total{0};
+    uint64_t sumNs{0};
+    uint64_t minNs{std::numeric_limits<uint64_t>::max()};
+    uint64_t maxNs{0};
+
+  public:
+    /**
+     * @brief Record a value, count times.
+     */
+    void record(uint64_t ns, uint64_t count = 1) {
+        if (count == 0)
+            return;
+
+        counts[bucketOf(ns)] += count;
+        total += count;
+        sumNs += ns * count;
+        minNs = std::min(minNs, ns);
+        maxNs = std::max(maxNs, ns);
+    }
+
+    /**
+     * @brief Add every value recorded in other.
+     */
+    void merge(const Histogram& other) {
+        for (std::size_t i{0}; i < BucketCount; ++i) {
+            counts[i] += other.counts[i];
+        }
+        total += other.total;
+        sumNs += other.sumNs;
+        minNs = std::min(minNs, other.minNs);
+        maxNs = std::max(maxNs, other.maxNs);
+    }
+
+    /**
+     * @brief Add a bucket's count directly; used to drain per-thread buffers.
+     */
+    void addBucket(std::size_t bucket, uint64_t count) {
+        counts[bucket] += count;
+        total += count;
+    }
+
+    /**
+     * @brief Fold in the exact sum and extremes of values added with addBucket().
+     */
+    void addSummary(uint64_t sum, uint64_t min, uint64_t max) {
+        sumNs += sum;
+        minNs = std::min(minNs, min);
+        maxNs = std::max(maxNs, max);
+    }
+
+    uint64_t count() const {
+        return total;
+    }
+
+    uint64_t sum() const {
+        return sumNs;
+    }
+
+    uint64_t min() const {
+        return total == 0 ? 0 : minNs;
+    }
+
+    uint64_t max() const {
+        return maxNs;
+    }
+
+    double mean() const {
+        return total == 0 ? 0.0 : static_cast<double>(sumNs) / static_cast<double>(total);
+    }
+
+    /**
+     * @brief Value at a percentile: the middle of the bucket holding that rank, clamped to the
+     * recorded extremes.
+     * @param p The percentile (0-100).
+     */
+    uint64_t percentile(double p) const {
+        if (total == 0)
+            return 0;
+
+        const double q{std::clamp(p, 0.0, 100.0) / 100.0};
+        const uint64_t rank{std::max<uint64_t>(
+            1, static_cast<uint64_t>(std::ceil(q * static_cast<double>(total))))};
+        uint64_t seen{0};
+        for (std::size_t i{0}; i < BucketCount; ++i) {
+            seen += counts[i];
+            if (seen >= rank) {
+                const uint64_t middle{lowestOf(i) + (widthOf(i) - 1) / 2};
+                return std::clamp(middle, min(), maxNs);
+            }
+        }
+        return maxNs;
+    }
+
+    void reset() {
+        std::fill(counts.begin(), counts.end(), 0);
+        total = 0;
+        sumNs = 0;
+        minNs = std::numeric_limits<uint64_t>::max();
+        maxNs = 0;
+    }
+};
+
+/**
+ * @brief Writer-reader phaser (as in HdrHistogram): writers enter and leave a critical section
+ * with one atomic increment each and never wait; a reader flips the phase and waits only for
+ * writers still inside the old one. Afterwards nothing writes to the old phase's data.
+ */
+class Phaser {
+  private:
+    std::atomic<int64_t> startEpoch{0};
+    std::atomic<int64_t> evenEndEpoch{0};
+    std::atomic<int64_t> oddEndEpoch{std::numeric_limits<int64_t>::min()};
+
+  public:
+    /**
+     * @return A ticket for leave(); negative while the phase is odd.
+     */
+    int64_t enter() {
+        return startEpoch.fetch_add(1);
+    }
+
+    void leave(int64_t ticket) {
+        (ticket < 0 ? oddEndEpoch : evenEndEpoch).fetch_add(1);
+    }
+
+    /**
+     * @brief Start the other phase and wait for writers in the current one to leave. Flips must
+     * not run concurrently with each other.
+     * @return The retired phase: 0 (even) or 1 (odd).
+     */
+    int flip() {
+        const bool nextIsEven{startEpoch.load() < 0};
+        const int64_t initial{nextIsEven ? 0 : std::numeric_limits<int64_t>::min()};
+        (nextIsEven ? evenEndEpoch : oddEndEpoch).store(initial);
+        const int64_t startAtFlip{startEpoch.exchange(initial)};
+
+        const std::atomic<int64_t>& retiring{nextIsEven ? oddEndEpoch : evenEndEpoch};
+        while (retiring.load() != startAtFlip) {
+            std::this_thread::yield();
+        }
+        return nextIsEven ? 1 : 0;
+    }
+};
+
+/**
+ * @brief Windowed latency summary.
+ */
+struct WindowStats {
+    uint64_t count{0};
+    double meanNs{0.0};
+    uint64_t p50Ns{0};
+    uint64_t p99Ns{0};
+    uint64_t p999Ns{0};
+    uint64_t maxNs{0};
+    double seconds{0.0}; // span of time the intervals actually cover
+};
+
+/**
+ * @brief Always-on latency recorder for production code. Any thread calls record(); each thread
+ * writes its own pair of histograms with relaxed atomics under its own phaser, so recording is
+ * wait-free and threads never share a cache line. A reader calls rotate() periodically (once per
+ * interval, e.g. from a metrics thread) to swap every thread's buffers and keep the drained
+ * interval; stats() merges the intervals inside a window.
+ *
+ * Each recording thread costs about 30 KB, freed by the first rotate() after the thread exits;
+ * each retained interval costs about 15 KB.
+ */
+class Recorder {
+  private:
+    struct Buffer {
+        std::array<std::atomic<uint64_t>, BucketCount> counts{};
+        std::atomic<uint64_t> sum{0};
+        std::atomic<uint64_t> min{std::numeric_limits<uint64_t>::max()};
+        std::atomic<uint64_t> max{0};
+    };
+
+    struct alignas(64) Slot {
+        Phaser phaser{};
+        Buffer buffers[2]{};
+        std::atomic<bool> retired{false}; // its thread has exited and will record no more
+    };
+
+    /**
+     * @brief A thread's slots in every recorder it has used. Shared with the recorders, so either
+     * side may go first; the thread's exit retires them.
+     */
+    struct ThreadSlots {
+        std::unordered_map<uint64_t, std::shared_ptr<Slot>> owned{};
+
+        ~ThreadSlots() {
+            for (auto& entry : owned) {
+                entry.second->retired.store(true, std::memory_order_release);
+            }
+        }
+    };
+
+    struct Interval {
+        std::chrono::steady_clock::time_point start{};
+        std::chrono::steady_clock::time_point end{};
+        Histogram histogram{};
+    };
+
+    const uint64_t id{nextId()};
+    const std::chrono::nanoseconds retention;
+
+    std::mutex slotsMutex{};
+    std::vector<std::shared_ptr<Slot>> slots{};
+
+    mutable std::mutex readerMutex{};
+    std::deque<Interval> intervals{};
+    std::chrono::steady_clock::time_point lastRotation{std::chrono::steady_clock::now()};
+
+    static uint64_t nextId() {
+        static std::atomic<uint64_t> counter{0};
+        return ++counter;
+    }
+
+    /**
+     * @brief This thread's slot, registered on its first record(); later calls take no lock.
+     * Recorder ids are never reused, so a cached slot cannot outlive its recorder unnoticed.
+     */
+    Slot& threadSlot() {
+        thread_local uint64_t cachedId{0};
+        thread_local Slot* cachedSlot{nullptr};
+        if (cachedId == id) {
+            return *cachedSlot;
+        }
+
+        thread_local ThreadSlots registry{};
+        auto it{registry.owned.find(id)};
+        if (it == registry.owned.end()) {
+            // Let go of slots whose recorder has been destroyed in the meantime
+            std::erase_if(registry.owned,
+                          [](const auto& entry) { return entry.second.use_count() == 1; });
+            auto slot{std::make_shared<Slot>()};
+            {
+                std::lock_guard<std::mutex> lock{slotsMutex};
+                slots.push_back(slot);
+            }
+            it = registry.owned.emplace(id, std::move(slot)).first;
+        }
+        cachedId = id;
+        cachedSlot = it->second.get();
+        return *cachedSlot;
+    }
+
+    static void drain(Buffer& buffer, Histogram& into) {
+        uint64_t seen{0};
+        for (std::size_t i{0}; i < BucketCount; ++i) {
+            const uint64_t count{buffer.counts[i].load(std::memory_order_relaxed)};
+            if (count > 0) {
+                into.addBucket(i, count);
+                buffer.counts[i].store(0, std::memory_order_relaxed);
+                seen += count;
+            }
+        }
+        if (seen > 0) {
+            into.addSummary(buffer.sum.load(std::memory_order_relaxed),
+                            buffer.min.load(std::memory_order_relaxed),
+                            buffer.max.load(std::memory_order_relaxed));
+        }
+        buffer.sum.store(0, std::memory_order_relaxed);
+        buffer.min.store(std::numeric_limits<uint64_t>::max(), std::memory_order_relaxed);
+        buffer.max.store(0, std::memory_order_relaxed);
+    }
+
+  public:
+    /**
+     * @brief Construct a recorder.
+     * @param keep How much history rotate() retains; the longest window stats() can cover.
+     */
+    explicit Recorder(std::chrono::nanoseconds keep = std::chrono::seconds{60})
+        : retention{keep} {}
+
+    Recorder(const Recorder&) = delete;
+    Recorder& operator=(const Recorder&) = delete;
+
+    /**
+     * @brief Record one latency from the calling thread. Wait-free after the thread's first call.
+     */
+    void record(uint64_t ns) {
+        Slot& slot{threadSlot()};
+        const int64_t ticket{slot.phaser.enter()};
+        Buffer& buffer{slot.buffers[ticket < 0 ? 1 : 0]};
+
+        // Only this thread writes the buffer, so load-then-store needs no read-modify-write
+        auto& bucket{buffer.counts[bucketOf(ns)]};
+        bucket.store(bucket.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+        buffer.sum.store(buffer.sum.load(std::memory_order_relaxed) + ns,
+                         std::memory_order_relaxed);
+        if (ns < buffer.min.load(std::memory_order_relaxed)) {
+            buffer.min.store(ns, std::memory_order_relaxed);
+        }
+        if (ns > buffer.max.load(std::memory_order_relaxed)) {
+            buffer.max.store(ns, std::memory_order_relaxed);
+        }
+
+        slot.phaser.leave(ticket);
+    }
+
+    void record(std::chrono::nanoseconds duration) {
+        record(static_cast<uint64_t>(std::max<int64_t>(duration.count(), 0)));
+    }
+
+    /**
+     * @brief Close the current interval: swap every thread's buffers, merge what they recorded
+     * since the last rotation, free the slots of threads that have exited, and drop intervals
+     * older than the retention.
+     * @return The interval just closed.
+     */
+    Histogram rotate() {
+        std::lock_guard<std::mutex> reader{readerMutex};
+        Interval interval{};
+        interval.start = lastRotation;
+        {
+            std::lock_guard<std::mutex> lock{slotsMutex};
+            std::erase_if(slots, [&interval](const std::shared_ptr<Slot>& slot) {
+                // Read before the flip, so a retired thread's last records are all drained below
+                const bool retired{slot->retired.load(std::memory_order_acquire)};
+                const int phase{slot->phaser.flip()};
+                drain(slot->buffers[phase], interval.histogram);
+                if (retired) {
+                    drain(slot->buffers[1 - phase], interval.histogram);
+                }
+                return retired;
+            });
+        }
+        interval.end = std::chrono::steady_clock::now();
+        lastRotation = interval.end;
+
+        while (!intervals.empty() && interval.end - intervals.front().end >= retention) {
+            intervals.pop_front();
+        }
+        intervals.push_back(interval);
+        return interval.histogram;
+    }
+
+    /**
+     * @brief Everything recorded in intervals that ended within the last span, merged.
+     * @param covered Set to the time those intervals actually cover, in seconds.
+     */
+    Histogram window(std::chrono::nanoseconds span, double* covered = nullptr) const {
+        std::lock_guard<std::mutex> reader{readerMutex};
+        Histogram merged{};
+        const auto now{std::chrono::steady_clock::now()};
+        auto earliest{now};
+        for (const auto& interval : intervals) {
+            if (now - interval.end < span) {
+                merged.merge(interval.histogram);
+                earliest = std::min(earliest, interval.start);
+            }
+        }
+        if (covered) {
+            *covered = std::chrono::duration<double>(now - earliest).count();
+        }
+        return merged;
+    }
+
+    /**
+     * @brief Rotate, then summarize the last span (at most the retention).
+     */
+    WindowStats stats(std::chrono::nanoseconds span) {
+        rotate();
+        WindowStats result{};
+        const Histogram merged{window(span, &result.seconds)};
+        result.count = merged.count();
+        result.meanNs = merged.mean();
+        result.p50Ns = merged.percentile(50.0);
+        result.p99Ns = merged.percentile(99.0);
+        result.p999Ns = merged.percentile(99.9);
+        result.maxNs = merged.max();
+        return result;
+    }
+};
+
+/**
+ * @brief Records the lifetime of a scope into a Recorder.
+ */
+class Scope {
+  private:
+    Recorder& recorder;
+    Timer::TimePoint start{Timer::Clock::now()};
+
+  public:
+    explicit Scope(Recorder& target) : recorder{target} {}
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+    ~Scope() {
+        recorder.record(std::chrono::duration_cast<std::chrono::nanoseconds>(Timer::Clock::now() -
+                                                                             start));
+    }
+};
+
+} // namespace Latency
+
 namespace Memory {
 
 /**
@@ -579,6 +1628,31 @@ class Benchmark {
     Benchmark(const std::string& benchName, size_t numIterations = 100, size_t warmup = 10)
         : name(benchName), iterations(numIterations), warmupIterations(warmup) {}
 
+    /**
+     * @brief Run the benchmark with the provided function, keeping exact integer times.
+     * @tparam Func The type of the function to benchmark.
+     * @param func The function to benchmark.
+     * @return Vector of elapsed times in nanoseconds for each iteration.
+     */
+    template <typename Func> std::vector<uint64_t> runNs(Func func) {
+        for (size_t i{0}; i < warmupIterations; ++i) {
+            func();
+        }
+
+        std::vector<uint64_t> times;
+        times.reserve(iterations);
+
+        for (size_t i{0}; i < iterations; ++i) {
+            Timer::Timer timer;
+            timer.start();
+            func();
+            timer.stop();
+            times.push_back(timer.elapsedNanoseconds());
+        }
+
+        return times;
+    }
+
     /**
      * @brief Run the benchmark with the provided function.
      * @tparam Func The type of the function to benchmark.
@@ -586,19 +1660,102 @@ class Benchmark {
      * @return Vector of elapsed times in seconds for each iteration.
      */
     template <typename Func> std::vector<double> run(Func func) {
+        const std::vector<uint64_t> ns{runNs(func)};
+        std::vector<double> times;
+        times.reserve(ns.size());
+        for (uint64_t t : ns) {
+            times.push_back(static_cast<double>(t) / 1e9);
+        }
+
+        return times;
+    }
+
+    /**
+     * @brief Run the benchmark and keep every iteration as a row of a SampleSet.
+     * @tparam Func The type of the function to benchmark.
+     * @param func The function to benchmark.
+     * @return Samples with wall_ns and timestamp_ns (start of the iteration, relative to the
+     * first) columns, and the benchmark name as metadata.
+     */
+    template <typename Func> Samples::SampleSet record(Func func) {
         for (size_t i{0}; i < warmupIterations; ++i) {
             func();
         }
 
-        std::vector<double> times;
-        times.reserve(iterations);
+        Samples::SampleSet samples{};
+        samples.metadata["name"] = name;
+        const std::size_t wall{samples.define<uint64_t>(Samples::WallNs)};
+        const std::size_t timestamp{samples.define<uint64_t>(Samples::TimestampNs)};
+        samples.reserve(iterations);
 
+        Timer::Timer sinceStart{};
+        sinceStart.start();
         for (size_t i{0}; i < iterations; ++i) {
+            const uint64_t offset{sinceStart.elapsedNanoseconds()};
             Timer::Timer timer;
             timer.start();
             func();
             timer.stop();
-            times.push_back(timer.elapsedSeconds());
+            samples.addRow();
+            samples.set(wall, timer.elapsedNanoseconds());
+            samples.set(timestamp, offset);
+        }
+
+        return samples;
+    }
+
+    /**
+     * @brief Find how many calls a timed batch needs to last at least minBatchSeconds.
+     * @tparam Func The type of the function to benchmark.
+     * @param func The function to benchmark.
+     * @param minBatchSeconds Shortest acceptable batch, well above the timer's resolution.
+     * @return Calls per batch (a power of two).
+     */
+    template <typename Func>
+    static size_t calibrateBatch(Func func, double minBatchSeconds = 1e-4) {
+        size_t batch{1};
+
+        while (batch < (size_t{1} << 30)) {
+            Timer::Timer timer;
+            timer.start();
+            for (size_t i{0}; i < batch; ++i) {
+                func();
+            }
+            timer.stop();
+
+            if (static_cast<double>(timer.elapsedNanoseconds()) >= minBatchSeconds * 1e9) {
+                break;
+            }
+            batch *= 2;
+        }
+
+        return batch;
+    }
+
+    /**
+     * @brief Run the benchmark timing batches of calls instead of single calls, for functions
+     * too fast to time individually.
+     * @tparam Func The type of the function to benchmark.
+     * @param func The function to benchmark.
+     * @param batch Calls per timed batch (see calibrateBatch()).
+     * @return Vector of mean per-call times in seconds, one per batch.
+     */
+    template <typename Func> std::vector<double> runBatched(Func func, size_t batch) {
+        if (batch <= 1) {
+            return run(func);
+        }
+
+        auto many{[&func, batch]() {
+            for (size_t i{0}; i < batch; ++i) {
+                func();
+            }
+        }};
+
+        const std::vector<uint64_t> ns{runNs(many)};
+        std::vector<double> times;
+        times.reserve(ns.size());
+        for (uint64_t t : ns) {
+            times.push_back(static_cast<double>(t) / 1e9 / static_cast<double>(batch));
         }
 
         return times;
@@ -0,0 +1,50 @@
+#ifndef VAJRA_COLLECTOR_H
+#define VAJRA_COLLECTOR_H
+
+/*
+ * Plugin ABI for vajra metric collectors. A collector is a shared object exporting
+ *
+ *     const struct vajra_collector* vajra_collector_entry(void);
+ *
+ * and loaded with --collector path/to/libfoo.so[:args]. This header is plain C so plugins can be
+ * written in C or C++ without linking against anything from vajra.
+ */
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#define VAJRA_COLLECTOR_ABI 1
+
+/* Report one value for the run that just finished. Metric names should carry their unit, e.g.
+ * "dma_bytes" or "temp_celsius"; vajra prefixes them with the collector's name. */
+typedef void (*vajra_emit_fn)(void* ctx, const char* metric, double value);
+
+struct vajra_collector {
+    uint32_t abi; /* VAJRA_COLLECTOR_ABI */
+    const char* name;
+    uint32_t period_ms; /* interval for periodic(); 0 disables it */
+
+    /* All hooks are optional (NULL). 'state' is whatever create() returned. */
+    void* (*create)(const char* args);
+    void (*destroy)(void* state);
+
+    /* In vajra, just before fork(). */
+    void (*before_spawn)(void* state);
+    /* In the child between fork() and exec(): async-signal-safe calls only. */
+    void (*in_child)(void* state);
+    /* In vajra while the child runs, every period_ms. */
+    void (*periodic)(void* state, int pid);
+    /* In vajra after the child exited but before it is reaped, so /proc/<pid> is still readable. */
+    void (*after_exit)(void* state, int pid, vajra_emit_fn emit, void* ctx);
+};
+
+typedef const struct vajra_collector* (*vajra_collector_entry_fn)(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
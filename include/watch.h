@@ -0,0 +1,335 @@
+#ifndef WATCH_H
+#define WATCH_H
+
+#include "argparser.h"
+#include "exec.h"
+#include "runner.h"
+#include "vajra.hpp"
+
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <ctime>
+#include <filesystem>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+#ifdef __linux__
+#include <poll.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace Watch {
+
+/**
+ * @brief Stop an adaptive measurement once the 95% CI of the mean is this tight (relative)...
+ */
+constexpr double TargetPrecision{0.01};
+/**
+ * @brief ...or once it has used this much wall time.
+ */
+constexpr std::chrono::seconds TimeBudget{5};
+constexpr int MinSamples{10};
+
+/**
+ * @brief Measure until the mean is known to TargetPrecision, the time budget is spent or
+ * config.iterations samples have been taken, whichever comes first.
+ */
+inline std::vector<uint64_t> measure(const BenchmarkConfig& config) {
+    for (int i{0}; i < config.warmup && !interruptRequested; ++i) {
+        runPrepare(config);
+        runOnce(config);
+    }
+
+    std::vector<uint64_t> timings{};
+    const auto deadline{std::chrono::steady_clock::now() + TimeBudget};
+
+    while (static_cast<int>(timings.size()) < config.iterations && !interruptRequested) {
+        runPrepare(config);
+        timings.push_back(runOnce(config).wallNs);
+
+        if (static_cast<int>(timings.size()) < MinSamples) {
+            continue;
+        }
+        const double m{Statistics::mean(timings)};
+        if (m > 0 && Statistics::confidenceHalfWidth(timings) / m < TargetPrecision) {
+            break;
+        }
+        if (std::chrono::steady_clock::now() >= deadline) {
+            break;
+        }
+    }
+    return timings;
+}
+
+inline void printDelta(const char* label, const std::vector<uint64_t>& current,
+                       const std::vector<uint64_t>& reference) {
+    const double before{Statistics::mean(reference)};
+    const double change{before > 0 ? (Statistics::mean(current) / before - 1.0) * 100.0 : 0.0};
+    const Statistics::WelchResult test{Statistics::welchTest(current, reference)};
+    const bool significant{test.pValue < 0.05};
+
+    const std::string& color{!significant ? Colors::White
+                             : change < 0 ? Colors::BrightGreen
+                                          : Colors::BrightRed};
+    std::cout << "  " << Colors::Dim << label << Colors::Reset << color << std::showpos
+              << std::fixed << std::setprecision(1) << change << "%" << std::noshowpos
+              << Colors::Reset << Colors::Dim << "  (p=" << std::setprecision(3) << test.pValue
+              << (significant ? ", significant" : ", noise") << ")" << Colors::Reset << "\n";
+}
+
+inline std::string timestamp() {
+    std::time_t now{std::time(nullptr)};
+    char buffer[16]{};
+    std::strftime(buffer, sizeof(buffer), "%H:%M:%S", std::localtime(&now));
+    return buffer;
+}
+
+#ifdef __linux__
+
+/**
+ * @brief Recursive inotify watch over a set of directories (and single files).
+ */
+class Watcher {
+  private:
+    int fd{-1};
+    std::map<int, std::string> dirs{};
+
+    static constexpr uint32_t Events{IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_CREATE |
+                                     IN_DELETE};
+
+    void addTree(const std::string& root) {
+        add(root);
+        std::error_code ec{};
+        if (!std::filesystem::is_directory(root, ec)) {
+            return;
+        }
+        for (auto it{std::filesystem::recursive_directory_iterator(
+                 root, std::filesystem::directory_options::skip_permission_denied, ec)};
+             it != std::filesystem::recursive_directory_iterator{}; it.increment(ec)) {
+            if (it->is_directory(ec)) {
+                const std::string name{it->path().filename().string()};
+                if (!name.empty() && name[0] == '.') {
+                    it.disable_recursion_pending();
+                    continue;
+                }
+                add(it->path().string());
+            }
+        }
+    }
+
+    void add(const std::string& path) {
+        int wd{inotify_add_watch(fd, path.c_str(), Events)};
+        if (wd >= 0) {
+            dirs[wd] = path;
+        }
+    }
+
+  public:
+    Watcher() = default;
+    Watcher(const Watcher&) = delete;
+    Watcher& operator=(const Watcher&) = delete;
+
+    ~Watcher() {
+        if (fd != -1) {
+            close(fd);
+        }
+    }
+
+    bool open(const std::vector<std::string>& paths) {
+        fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+        if (fd == -1) {
+            return false;
+        }
+        for (const auto& path : paths) {
+            addTree(path);
+        }
+        return !dirs.empty();
+    }
+
+    /**
+     * @brief Read pending events, watching any new subdirectories.
+     * @return Path of the first changed file, or empty if nothing relevant happened.
+     */
+    std::string drain() {
+        std::string changed{};
+        alignas(inotify_event) char buffer[8192];
+
+        ssize_t length{};
+        while ((length = read(fd, buffer, sizeof(buffer))) > 0) {
+            for (char* p{buffer}; p < buffer + length;) {
+                const auto* event{reinterpret_cast<const inotify_event*>(p)};
+                p += sizeof(inotify_event) + event->len;
+
+                std::string name{event->len > 0 ? event->name : ""};
+                if (!name.empty() && (name[0] == '.' || name.back() == '~')) {
+                    continue; // editor swap and backup files
+                }
+
+                std::string path{dirs[event->wd]};
+                if (!name.empty()) {
+                    path += "/" + name;
+                }
+                if ((event->mask & IN_ISDIR) && (event->mask & (IN_CREATE | IN_MOVED_TO))) {
+                    addTree(path);
+                }
+                if (changed.empty()) {
+                    changed = path;
+                }
+            }
+        }
+        return changed;
+    }
+
+    /**
+     * @brief Block until a change settles (no further events for the debounce period), or until
+     * the user types a line on stdin.
+     * @return 1 for a file change, 2 for a stdin line, 0 on interrupt or error.
+     */
+    int wait(std::string& changed, std::string& line) {
+        pollfd fds[2]{{fd, POLLIN, 0}, {STDIN_FILENO, POLLIN, 0}};
+
+        while (!interruptRequested) {
+            if (poll(fds, 2, -1) < 0) {
+                return 0;
+            }
+            if (fds[1].revents & (POLLIN | POLLHUP)) {
+                if (!std::getline(std::cin, line)) {
+                    fds[1].fd = -1; // stdin closed, keep watching files
+                    continue;
+                }
+                return 2;
+            }
+            if (fds[0].revents & POLLIN) {
+                changed = drain();
+                // Editors and builds touch several files at once; let the burst settle
+                while (poll(fds, 1, 200) > 0) {
+                    std::string more{drain()};
+                    if (changed.empty()) {
+                        changed = more;
+                    }
+                }
+                if (!changed.empty()) {
+                    return 1;
+                }
+            }
+        }
+        return 0;
+    }
+};
+
+/**
+ * @brief Edit-compile-measure loop: rebuild on every change under the watched paths, re-measure,
+ * and compare against the previous and the pinned baseline measurement.
+ */
+inline int run(const std::vector<std::string>& paths, const std::string& build,
+               const std::vector<std::string>& cmdArgs, const BenchmarkConfig& base,
+               Exec::Mode execMode) {
+    Watcher watcher{};
+    if (!watcher.open(paths)) {
+        std::cerr << Colors::BrightRed << "Error: " << Colors::Reset << "Cannot watch '"
+                  << paths.front() << "'\n";
+        return 1;
+    }
+
+    std::vector<uint64_t> baseline{};
+    std::vector<uint64_t> previous{};
+    std::string reason{"initial run"};
+
+    std::cout << Colors::BrightCyan << "Watching " << Colors::BrightYellow;
+    for (size_t i{0}; i < paths.size(); ++i) {
+        std::cout << (i > 0 ? ", " : "") << paths[i];
+    }
+    std::cout << Colors::Reset << Colors::Dim << "  (Enter re-runs, 'p' + Enter pins the last "
+              << "result as baseline, Ctrl-C quits)" << Colors::Reset << "\n";
+
+    while (!interruptRequested) {
+        std::cout << "\n"
+                  << Colors::Dim << "[" << timestamp() << "] " << Colors::Reset << reason << "\n"
+                  << std::flush;
+
+        bool built{true};
+        if (!build.empty()) {
+            Timer::Timer timer{};
+            timer.start();
+            int status{std::system(build.c_str())};
+            timer.stop();
+            built = status == 0;
+            std::cout << "  " << (built ? Colors::BrightGreen : Colors::BrightRed)
+                      << (built ? "✓ " : "✗ ") << Colors::Reset << "build" << Colors::Dim << " ("
+                      << std::fixed << std::setprecision(2) << timer.elapsedSeconds() << " s)"
+                      << Colors::Reset << "\n";
+        }
+
+        if (built && !interruptRequested) {
+            // The binary may have just been rebuilt, so resolve (or reload) it every time
+            BenchmarkConfig config{base};
+            if (!config.useShell) {
+                auto image{std::make_shared<Exec::Image>()};
+                if (Exec::prepare(*image, cmdArgs, execMode)) {
+                    config.image = image;
+                } else {
+                    built = false;
+                }
+            }
+
+            if (built) {
+                std::vector<uint64_t> timings{measure(config)};
+                if (!interruptRequested && !timings.empty()) {
+                    const double m{Statistics::mean(timings)};
+                    std::cout << "  " << Colors::BrightGreen << "μ=" << std::fixed
+                              << std::setprecision(3) << m / 1e6 << " ms" << Colors::Reset
+                              << Colors::Dim << " ± " << std::setprecision(1)
+                              << (m > 0 ? Statistics::confidenceHalfWidth(timings) / m * 100.0
+                                        : 0.0)
+                              << "% (" << timings.size() << " iters)" << Colors::Reset << "\n";
+
+                    if (!previous.empty()) {
+                        printDelta("vs previous  ", timings, previous);
+                    }
+                    if (!baseline.empty() && baseline != previous) {
+                        printDelta("vs baseline  ", timings, baseline);
+                    }
+                    if (baseline.empty()) {
+                        baseline = timings;
+                        std::cout << "  " << Colors::Dim << "pinned as baseline" << Colors::Reset
+                                  << "\n";
+                    }
+                    previous = std::move(timings);
+                }
+            }
+        }
+
+        // Whatever the build itself wrote must not trigger another round
+        watcher.drain();
+
+        std::string changed{};
+        std::string line{};
+        int woke{0};
+        while ((woke = watcher.wait(changed, line)) == 2 && line == "p") {
+            if (!previous.empty()) {
+                baseline = previous;
+                std::cout << Colors::Dim << "  pinned last result as baseline" << Colors::Reset
+                          << "\n";
+            }
+        }
+        if (woke == 0) {
+            break;
+        }
+        reason = woke == 1 ? "changed: " + changed : "manual re-run";
+    }
+
+    std::cout << "\n";
+    return 0;
+}
+
+#endif
+
+} // namespace Watch
+
+#endif
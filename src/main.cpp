@@ -1,132 +1,572 @@
 #include "argparser.h"
+#include "cache.h"
+#include "collector.h"
+#include "corpus.h"
+#include "daemon.h"
+#include "exec.h"
+#include "inprocess.h"
+#include "journal.h"
+#include "livestats.h"
+#include "numa.h"
+#include "openmetrics.h"
+#include "perffuzz.h"
+#include "priority.h"
+#include "runner.h"
+#include "slo.h"
+#include "suite.h"
+#include "tournament.h"
+#include "tune.h"
 #include "vajra.hpp"
+#include "watch.h"
 
+#include <csignal>
 #include <cstdlib>
 #include <cstring>
+#include <filesystem>
+#include <fstream>
 #include <iostream>
+#include <memory>
+#include <random>
 #include <string>
-#include <thread>
 #include <vector>
 
-#ifdef _WIN32
-#ifndef NOMINMAX
-#define NOMINMAX
-#endif
+void displayNodeComparison(const std::vector<BenchmarkResults>& perNode) {
+    if (perNode.empty()) {
+        return;
+    }
 
-#include <io.h>
-#include <windows.h>
-#endif
+    double fastest{perNode[0].mean};
+    for (const auto& r : perNode) {
+        fastest = std::min(fastest, r.mean);
+    }
 
-#ifdef __linux__
-#include <fcntl.h>
-#include <sys/wait.h>
-#include <unistd.h>
-#endif
+    std::cout << Colors::Bold << Colors::BrightWhite << "NUMA comparison:" << Colors::Reset << "\n";
+    for (const auto& r : perNode) {
+        double slower{fastest > 0 ? (r.mean / fastest - 1.0) * 100.0 : 0.0};
+        std::cout << "  node " << r.numaNode << "  " << std::fixed << std::setprecision(3)
+                  << r.mean << " ms";
+        if (r.mean == fastest) {
+            std::cout << "  " << Colors::BrightGreen << "fastest" << Colors::Reset << "\n";
+        } else {
+            std::cout << "  " << Colors::BrightRed << "+" << std::setprecision(1) << slower << "%"
+                      << Colors::Reset << "\n";
+        }
+    }
 
-int executeCommand(const std::vector<std::string>& args) {
-#ifdef _WIN32
-    std::string cmdLine;
-    for (size_t i{0}; i < args.size(); ++i) {
-        if (i > 0)
-            cmdLine += " ";
-        if (args[i].find(' ') != std::string::npos) {
-            cmdLine += "\"" + args[i] + "\"";
+    // Collector metrics are compared the same way, by name, against the first node
+    for (const auto& metric : perNode[0].metrics) {
+        std::cout << "  " << Colors::Dim << metric.name << Colors::Reset << "\n";
+        for (const auto& r : perNode) {
+            auto it{std::find_if(
+                r.metrics.begin(), r.metrics.end(),
+                [&metric](const MetricSummary& m) { return m.name == metric.name; })};
+            if (it == r.metrics.end()) {
+                continue;
+            }
+            std::cout << "    node " << r.numaNode << "  " << std::defaultfloat
+                      << std::setprecision(6) << it->mean;
+            if (metric.mean != 0 && &r != &perNode[0]) {
+                std::cout << Colors::Dim << "  " << std::showpos << std::fixed
+                          << std::setprecision(1) << (it->mean / metric.mean - 1.0) * 100.0 << "%"
+                          << std::noshowpos << Colors::Reset;
+            }
+            std::cout << "\n";
+        }
+    }
+    std::cout << "\n";
+}
+
+/**
+ * @brief First Ctrl-C stops after the current sample and reports what was collected; a second one
+ * falls through to the default action.
+ */
+void onInterrupt(int) {
+    interruptRequested = 1;
+    std::signal(SIGINT, SIG_DFL);
+}
+
+int runSuite(const ArgParser& parser, const std::string& path, const BenchmarkConfig& base,
+             Exec::Mode execMode) {
+    std::vector<Suite::Entry> entries{};
+    if (!Suite::load(path, base, execMode, entries)) {
+        return 1;
+    }
+
+    if (parser.has("tag")) {
+        const std::string tag{parser.get("tag")};
+        std::erase_if(entries, [&tag](const Suite::Entry& e) {
+            return std::find(e.tags.begin(), e.tags.end(), tag) == e.tags.end();
+        });
+        if (entries.empty()) {
+            std::cerr << Colors::BrightRed << "Error: " << Colors::Reset
+                      << "No benchmarks in '" << path << "' are tagged '" << tag << "'\n";
+            return 1;
+        }
+    }
+
+    int jobs{0};
+    if (!parser.getIntSafe("jobs", jobs, 0)) {
+        return 1;
+    }
+
+    if (!base.quiet) {
+        std::cout << Colors::BrightCyan << "Running suite: " << Colors::BrightYellow << path
+                  << Colors::Reset << Colors::White << " (" << entries.size() << " benchmarks)"
+                  << Colors::Reset << "\n";
+    }
+
+    if (parser.has("tournament")) {
+        if (entries.size() < 2) {
+            std::cerr << Colors::BrightRed << "Error: " << Colors::Reset
+                      << "--tournament needs at least two benchmarks\n";
+            return 1;
+        }
+
+        std::signal(SIGINT, onInterrupt);
+        const Tournament::Outcome outcome{Tournament::run(entries, jobs, base.quiet)};
+        if (outcome.failed) {
+            return 1;
+        }
+
+        const std::vector<BenchmarkResults> results{Tournament::results(outcome, entries)};
+        if (parser.has("export-openmetrics") &&
+            !OpenMetrics::write(parser.get("export-openmetrics"), results)) {
+            return 1;
+        }
+        if (base.quiet) {
+            std::cout << Tournament::toJson(path, outcome, results);
         } else {
-            cmdLine += args[i];
+            Tournament::display(path, outcome);
         }
+        return outcome.interrupted ? 130 : 0;
     }
 
-    STARTUPINFOA si{};
-    PROCESS_INFORMATION pi{};
-    si.cb = sizeof(si);
-    si.dwFlags = STARTF_USESTDHANDLES;
+    std::vector<BenchmarkResults> results{Suite::run(entries, jobs, base.quiet)};
+    if (parser.has("export-openmetrics") &&
+        !OpenMetrics::write(parser.get("export-openmetrics"), results)) {
+        return 1;
+    }
 
-    HANDLE hNul{
-        CreateFileA("NUL", GENERIC_WRITE, FILE_SHARE_WRITE, nullptr, OPEN_EXISTING, 0, nullptr)};
-    if (hNul != INVALID_HANDLE_VALUE) {
-        si.hStdOutput = hNul;
-        si.hStdError = hNul;
+    if (base.quiet) {
+        std::cout << Suite::toJson(path, results);
+    } else {
+        Suite::displayReport(path, results);
     }
 
-    BOOL success{CreateProcessA(nullptr, const_cast<char*>(cmdLine.c_str()), nullptr, nullptr, TRUE,
-                                CREATE_NO_WINDOW, nullptr, nullptr, &si, &pi)};
+    return 0;
+}
+
+int runCorpus(const ArgParser& parser, const std::string& templ, const BenchmarkConfig& base,
+              Exec::Mode execMode) {
+    const std::string dir{parser.get("corpus")};
 
-    if (hNul != INVALID_HANDLE_VALUE) {
-        CloseHandle(hNul);
+    // A corpus can hold hundreds of files, so a smaller per-file default than a single benchmark's
+    BenchmarkConfig config{base};
+    int jobs{0};
+    int worst{0};
+    if (!parser.getIntSafe("iterations", config.iterations, 10) ||
+        !parser.getIntSafe("jobs", jobs, 0) || !parser.getIntSafe("worst", worst, 5)) {
+        return 1;
+    }
+    if (worst < 0) {
+        std::cerr << Colors::BrightRed << "Error: " << Colors::Reset
+                  << "--worst must be non-negative (got " << worst << ")\n";
+        return 1;
+    }
+    if (parser.has("bytes") || parser.has("bytes-from")) {
+        std::cerr << Colors::BrightYellow << "Note: " << Colors::Reset
+                  << "--corpus uses each file's size as bytes per run; --bytes is ignored\n";
     }
 
-    if (!success) {
-        return -1;
+    std::vector<Suite::Entry> entries{};
+    if (!Corpus::load(dir, templ, config, execMode, parser.has("parallel"), entries)) {
+        return 1;
     }
 
-    WaitForSingleObject(pi.hProcess, INFINITE);
+    if (!base.quiet) {
+        std::cout << Colors::BrightCyan << "Running corpus: " << Colors::BrightYellow << dir
+                  << Colors::Reset << Colors::White << " (" << entries.size() << " files, "
+                  << config.iterations << " iterations each)" << Colors::Reset << "\n";
+    }
 
-    DWORD exitCode{0};
-    GetExitCodeProcess(pi.hProcess, &exitCode);
+    std::vector<BenchmarkResults> results{Suite::run(entries, jobs, base.quiet)};
+    if (parser.has("export-openmetrics") &&
+        !OpenMetrics::write(parser.get("export-openmetrics"), results)) {
+        return 1;
+    }
 
-    CloseHandle(pi.hProcess);
-    CloseHandle(pi.hThread);
+    const Corpus::Summary summary{Corpus::summarize(results, static_cast<size_t>(worst))};
+    if (base.quiet) {
+        std::cout << Corpus::toJson(dir, results, summary);
+    } else {
+        Corpus::display(dir, results, summary);
+    }
+    return 0;
+}
 
-    return static_cast<int>(exitCode);
-#else
-    pid_t pid{fork()};
+int runPerfFuzz(const ArgParser& parser, const std::string& templ, const BenchmarkConfig& base,
+                Exec::Mode execMode) {
+    PerfFuzz::Options options{};
+    options.templ = templ;
+    options.seedDir = parser.get("seed-dir");
+    options.outDir = parser.get("out-dir", options.outDir);
+    if (options.seedDir.empty()) {
+        std::cerr << Colors::BrightRed << "Error: " << Colors::Reset
+                  << "vajra perf-fuzz needs --seed-dir with example inputs\n";
+        return 1;
+    }
+    if (templ.find("{file}") == std::string::npos) {
+        std::cerr << Colors::BrightRed << "Error: " << Colors::Reset
+                  << "The command has no {file} placeholder, e.g. \"./parser {file}\"\n";
+        return 1;
+    }
 
-    if (pid == -1) {
-        return -1;
-    } else if (pid == 0) {
-        int devNull{open("/dev/null", O_WRONLY)};
-        if (devNull != -1) {
-            dup2(devNull, STDOUT_FILENO);
-            dup2(devNull, STDERR_FILENO);
-            close(devNull);
+    int keep{0};
+    int maxLen{0};
+    int rngSeed{0};
+    if (!parser.getIntSafe("iterations", options.runs, options.runs) ||
+        !parser.getIntSafe("cpu-limit", options.cpuLimitSeconds, 0) ||
+        !parser.getIntSafe("max-evals", options.maxEvals, options.maxEvals) ||
+        !parser.getIntSafe("keep", keep, static_cast<int>(options.keep)) ||
+        !parser.getIntSafe("max-len", maxLen, 0) ||
+        !parser.getIntSafe("rng-seed", rngSeed, static_cast<int>(std::random_device{}()))) {
+        return 1;
+    }
+    if (options.runs < 1 || options.maxEvals < 1 || keep < 1 || maxLen < 0 ||
+        options.cpuLimitSeconds < 0) {
+        std::cerr << Colors::BrightRed << "Error: " << Colors::Reset
+                  << "vajra perf-fuzz needs --iterations, --max-evals and --keep >= 1\n";
+        return 1;
+    }
+    options.keep = static_cast<size_t>(keep);
+    options.maxLen = static_cast<size_t>(maxLen);
+    options.rngSeed = static_cast<uint64_t>(static_cast<unsigned>(rngSeed));
+
+    if (parser.has("min-slowdown")) {
+        char* end{nullptr};
+        const std::string text{parser.get("min-slowdown")};
+        options.minSlowdown = std::strtod(text.c_str(), &end);
+        if (end == text.c_str() || *end != '\0' || !(options.minSlowdown >= 1.0)) {
+            std::cerr << Colors::BrightRed << "Error: " << Colors::Reset
+                      << "--min-slowdown must be a factor of at least 1 (got '" << text << "')\n";
+            return 1;
         }
+    }
+
+    if (!base.quiet) {
+        std::cout << Colors::BrightCyan << "Perf-fuzzing: " << Colors::BrightYellow << templ
+                  << Colors::Reset << Colors::White << " (seeds from " << options.seedDir
+                  << ", at most " << options.maxEvals << " inputs, rng seed "
+                  << options.rngSeed << ")" << Colors::Reset << "\n";
+    }
 
-        std::vector<char*> argv;
-        argv.reserve(args.size() + 1);
+    std::signal(SIGINT, onInterrupt);
+    PerfFuzz::Fuzzer fuzzer{options, base, execMode};
+    const PerfFuzz::Outcome outcome{fuzzer.run()};
+    if (outcome.failed) {
+        return 1;
+    }
+
+    if (base.quiet) {
+        std::cout << PerfFuzz::toJson(options, outcome);
+    } else {
+        PerfFuzz::display(options, outcome);
+    }
+    return outcome.interrupted ? 130 : 0;
+}
 
-        for (const auto& arg : args) {
-            argv.push_back(const_cast<char*>(arg.c_str()));
+int runDaemon(const ArgParser& parser, const BenchmarkConfig& base, Exec::Mode execMode) {
+#ifdef __linux__
+    std::vector<int> cpus{};
+    if (parser.has("cpus")) {
+        cpus = Numa::parseList(parser.get("cpus"));
+        if (cpus.empty()) {
+            std::cerr << Colors::BrightRed << "Error: " << Colors::Reset
+                      << "Invalid CPU list for --cpus: '" << parser.get("cpus") << "'\n";
+            return 1;
         }
+    }
 
-        argv.push_back(nullptr);
+    // Only the mode matters here; each job resolves its own binary
+    BenchmarkConfig config{base};
+    auto image{std::make_shared<Exec::Image>()};
+    image->mode = execMode;
+    config.image = image;
 
-        execvp(argv[0], argv.data());
-        _exit(127);
-    } else {
-        int status;
+    return Daemon::run(parser.get("socket", Daemon::defaultSocketPath()), config, cpus);
+#else
+    (void)parser;
+    (void)base;
+    (void)execMode;
+    std::cerr << Colors::BrightRed << "Error: " << Colors::Reset
+              << "vajra daemon is only supported on Linux\n";
+    return 1;
+#endif
+}
 
-        waitpid(pid, &status, 0);
+int submitJob(const ArgParser& parser, const std::string& command, const BenchmarkConfig& base) {
+#ifdef __linux__
+    std::ostringstream request{};
+    request << "{\"command\": \"" << BenchmarkResults::escapeJson(command) << "\""
+            << ", \"warmup\": " << base.warmup << ", \"iterations\": " << base.iterations
+            << ", \"shell\": " << (base.useShell ? "true" : "false");
+
+    // The daemon runs the command in this directory and environment, not its own
+    const std::filesystem::path cwd{std::filesystem::current_path()};
+    request << ", \"cwd\": \"" << BenchmarkResults::escapeJson(cwd.string()) << "\", \"env\": [";
+    for (char** e{environ}; e && *e; ++e) {
+        request << (e == environ ? "" : ", ") << "\"" << BenchmarkResults::escapeJson(*e) << "\"";
+    }
+    request << "]";
+    if (!base.prepare.empty()) {
+        request << ", \"prepare\": \"" << BenchmarkResults::escapeJson(base.prepare) << "\"";
+    }
+    if (parser.has("exec-mode")) {
+        request << ", \"exec_mode\": \"" << BenchmarkResults::escapeJson(parser.get("exec-mode"))
+                << "\"";
+    }
+    request << "}";
+
+    int exitCode{1};
+    bool sent{Daemon::submit(
+        parser.get("socket", Daemon::defaultSocketPath()), request.str(),
+        [&](const Json::Value& event) {
+            const std::string name{event.getString("event")};
+
+            if (name == "error") {
+                std::cerr << Colors::BrightRed << "Error: " << Colors::Reset << "daemon: "
+                          << event.getString("message") << "\n";
+                return false;
+            }
+
+            if (name == "queued" && !base.quiet) {
+                std::cout << Colors::BrightMagenta << "Queued as job "
+                          << static_cast<uint64_t>(event.getNumber("job")) << Colors::Reset
+                          << Colors::Dim << " (" << event.getNumber("ahead") << " ahead)"
+                          << Colors::Reset << "\n"
+                          << std::flush;
+            } else if (name == "result") {
+                const Json::Value* results{event.find("results")};
+                if (!results) {
+                    return false;
+                }
+                if (base.quiet) {
+                    std::cout << BenchmarkResults{Json::toResults(*results)}.toJson();
+                } else {
+                    Json::toResults(*results).display();
+                    if (const Json::Value* cal{event.find("calibration")}) {
+                        std::cout << Colors::Dim << "  daemon spawn overhead " << std::fixed
+                                  << std::setprecision(3) << cal->getNumber("spawn_overhead_ms")
+                                  << " ms" << Colors::Reset << "\n\n";
+                    }
+                }
+                exitCode = 0;
+                return false;
+            }
+            return true;
+        })};
 
-        return WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+    return sent ? exitCode : 1;
+#else
+    (void)parser;
+    (void)command;
+    (void)base;
+    std::cerr << Colors::BrightRed << "Error: " << Colors::Reset
+              << "vajra submit is only supported on Linux\n";
+    return 1;
+#endif
+}
+
+int runWatch(const ArgParser& parser, const std::string& command, const BenchmarkConfig& base,
+             Exec::Mode execMode) {
+#ifdef __linux__
+    std::vector<std::string> paths{};
+    std::istringstream list{parser.get("path", ".")};
+    for (std::string path{}; std::getline(list, path, ',');) {
+        if (!path.empty()) {
+            paths.push_back(path);
+        }
+    }
+    if (paths.empty()) {
+        paths.push_back(".");
     }
+
+    BenchmarkConfig config{base};
+    config.command = command;
+    std::vector<std::string> cmdArgs{};
+    if (!config.useShell) {
+        cmdArgs = parseCommand(command);
+        config.cmdArgs = cmdArgs;
+    }
+
+    return Watch::run(paths, parser.get("build"), cmdArgs, config, execMode);
+#else
+    (void)parser;
+    (void)command;
+    (void)base;
+    (void)execMode;
+    std::cerr << Colors::BrightRed << "Error: " << Colors::Reset
+              << "vajra watch needs inotify and is only supported on Linux\n";
+    return 1;
 #endif
 }
 
-std::vector<std::string> parseCommand(const std::string& command) {
-    std::vector<std::string> args;
-    std::string current;
-    bool inQuote{false};
+int runTune(const ArgParser& parser, const std::string& templ, const BenchmarkConfig& base,
+            Exec::Mode execMode) {
+    std::vector<Tune::Dimension> space{};
+    if (!parser.has("space")) {
+        std::cerr << Colors::BrightRed << "Error: " << Colors::Reset
+                  << "vajra tune needs --space, e.g. --space 'level=1..19,threads=1|2|4|8'\n";
+        return 1;
+    }
+    for (const auto& spec : parser.getAll("space")) {
+        if (!Tune::parseSpace(spec, space)) {
+            return 1;
+        }
+    }
+    for (const auto& dim : space) {
+        if (templ.find("{" + dim.name + "}") == std::string::npos) {
+            std::cerr << Colors::BrightRed << "Error: " << Colors::Reset << "The command has no {"
+                      << dim.name << "} placeholder\n";
+            return 1;
+        }
+    }
 
-    for (size_t i{0}; i < command.size(); ++i) {
-        char c{command[i]};
+    // Tuning measures many points, so a smaller per-point default than a single benchmark's
+    int perPoint{20};
+    int maxEvals{0};
+    if (!parser.getIntSafe("iterations", perPoint, 20) ||
+        !parser.getIntSafe("max-evals", maxEvals, 60)) {
+        return 1;
+    }
+    if (perPoint < 2 || maxEvals < 1) {
+        std::cerr << Colors::BrightRed << "Error: " << Colors::Reset
+                  << "vajra tune needs --iterations >= 2 and --max-evals >= 1\n";
+        return 1;
+    }
 
-        if (c == '"' || c == '\'') {
-            inQuote = !inQuote;
-        } else if (c == ' ' && !inQuote) {
-            if (!current.empty()) {
-                args.push_back(current);
-                current.clear();
-            }
+    if (!base.quiet) {
+        std::cout << Colors::BrightCyan << "Tuning: " << Colors::BrightYellow << templ
+                  << Colors::Reset << Colors::White << " (" << Tune::spaceSize(space)
+                  << " configurations, at most " << maxEvals << " measured, " << perPoint
+                  << " samples each)" << Colors::Reset << "\n";
+    }
+
+    std::signal(SIGINT, onInterrupt);
+    Tune::Search search{templ, space, base, execMode, perPoint, maxEvals};
+    const Tune::Outcome outcome{search.run()};
+    if (outcome.evaluated.empty() || outcome.evaluated[outcome.best].failed ||
+        outcome.evaluated[outcome.best].wallNs.empty()) {
+        std::cerr << Colors::BrightRed << "Error: " << Colors::Reset
+                  << "The starting configuration could not be measured\n";
+        return 1;
+    }
+
+    if (base.quiet) {
+        std::cout << Tune::toJson(templ, space, outcome);
+    } else {
+        Tune::display(space, outcome);
+    }
+    return outcome.interrupted ? 130 : 0;
+}
+
+/**
+ * @brief Write every run of a benchmark for --export-samples: vajra's binary sample format for a
+ * .bin file, JSON otherwise.
+ */
+bool exportSamples(const std::string& path, const BenchmarkResults& results) {
+    if (results.samples.empty()) {
+        std::cerr << Colors::BrightYellow << "Note: " << Colors::Reset
+                  << "No per-run samples to export (cached result); '" << path
+                  << "' not written\n";
+        return true;
+    }
+
+    Samples::SampleSet samples{results.samples};
+    samples.metadata["command"] = results.command;
+    samples.metadata["exec_mode"] = results.execMode;
+    if (results.callsPerIteration > 0) {
+        samples.metadata["calls_per_iteration"] = std::to_string(results.callsPerIteration);
+    }
+
+    const bool binary{path.size() > 4 && path.compare(path.size() - 4, 4, ".bin") == 0};
+    std::ofstream file{path, binary ? std::ios::binary : std::ios::out};
+    if (file) {
+        if (binary) {
+            samples.writeBinary(file);
         } else {
-            current += c;
+            file << samples.toJson();
+        }
+    }
+    if (!file) {
+        std::cerr << Colors::BrightRed << "Error: " << Colors::Reset << "Cannot write '" << path
+                  << "'\n";
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Print or serialize a single benchmark's result, with its --assert verdict if any.
+ * @return The exit code: 130 if interrupted, else the verdict's.
+ */
+int report(const BenchmarkResults& results, const std::vector<Slo::Assertion>& assertions,
+           bool json) {
+    std::vector<Slo::Check> checks{};
+    for (const auto& assertion : assertions) {
+        checks.push_back(Slo::evaluate(assertion, results));
+    }
+
+    if (json) {
+        std::cout << (checks.empty() ? results.toJson()
+                                     : Slo::withAssertions(results.toJson(), checks));
+    } else {
+        results.display();
+        if (!checks.empty()) {
+            Slo::display(checks);
         }
     }
 
-    if (!current.empty()) {
-        args.push_back(current);
+    if (results.interrupted) {
+        return 130;
+    }
+    return checks.empty() ? 0 : Slo::exitCode(Slo::overall(checks));
+}
+
+int runInProcess(const ArgParser& parser, const BenchmarkConfig& config,
+                 const std::vector<Slo::Assertion>& assertions) {
+    if (!parser.getPositional().empty()) {
+        std::cerr << Colors::BrightRed << "Error: " << Colors::Reset
+                  << "--dlopen benchmarks a library function; drop the command\n";
+        return 1;
+    }
+
+    int batch{0};
+    if (!parser.getIntSafe("batch", batch, 0)) {
+        return 1;
+    }
+    if (batch < 0) {
+        std::cerr << Colors::BrightRed << "Error: " << Colors::Reset
+                  << "--batch must be positive (got " << batch << ")\n";
+        return 1;
     }
 
-    return args;
+    InProcess::Target target{};
+    if (!target.load(parser.get("dlopen"), parser.get("arg-file"))) {
+        return 1;
+    }
+
+    BenchmarkResults results{InProcess::run(target, config, static_cast<size_t>(batch))};
+
+    if (parser.has("export-openmetrics") &&
+        !OpenMetrics::write(parser.get("export-openmetrics"), {results})) {
+        return 1;
+    }
+    if (parser.has("export-samples") && !exportSamples(parser.get("export-samples"), results)) {
+        return 1;
+    }
+
+    return report(results, assertions, config.quiet);
 }
 
 int main(int argc, char** argv) {
@@ -147,13 +587,21 @@ int main(int argc, char** argv) {
         return 1;
     }
 
+    const bool resuming{parser.has("resume")};
+    const std::string journalPath{resuming ? parser.get("resume") : parser.get("journal")};
+    Journal::Header journalHeader{"", false, 5, 100};
+    std::vector<Journal::Sample> resumedSamples{};
+    if (resuming && !Journal::load(journalPath, journalHeader, resumedSamples)) {
+        return 1;
+    }
+
     int warmup, iterations;
-    if (!parser.getIntSafe("warmup", warmup, 5) ||
-        !parser.getIntSafe("iterations", iterations, 100)) {
+    if (!parser.getIntSafe("warmup", warmup, journalHeader.warmup) ||
+        !parser.getIntSafe("iterations", iterations, journalHeader.iterations)) {
         return 1;
     }
     std::string outputFormat{parser.get("output", "text")};
-    bool useShell{parser.has("shell")};
+    bool useShell{parser.has("shell") || journalHeader.useShell};
     bool isJsonOutput{outputFormat == "json"};
 
     const auto& positionalArgs{parser.getPositional()};
@@ -164,6 +612,187 @@ int main(int argc, char** argv) {
         command += positionalArgs[i];
     }
 
+    if (resuming) {
+        if (command.empty()) {
+            command = journalHeader.command;
+        } else if (command != journalHeader.command) {
+            std::cerr << Colors::BrightRed << "Error: " << Colors::Reset << "Journal '"
+                      << journalPath << "' was recorded for '" << journalHeader.command << "'\n";
+            return 1;
+        }
+    }
+
+    Priority::Settings priority{};
+    if (!Priority::parseSettings(parser, priority)) {
+        return 1;
+    }
+
+    if (priority.any()) {
+        int err{Priority::probe(priority)};
+        if (err != 0) {
+            std::cerr << Colors::BrightRed << "Error: " << Colors::Reset
+                      << "Cannot apply priority settings: " << std::strerror(err) << "\n";
+            std::cerr << Colors::Dim
+                      << "Real-time classes and negative nice values need root or CAP_SYS_NICE."
+                      << Colors::Reset << "\n";
+            return 1;
+        }
+
+        if (useShell && !priority.applyToSelf) {
+            std::cerr << Colors::BrightYellow << "Note: " << Colors::Reset
+                      << "--shell runs through std::system; add --sched-self so the shell "
+                         "inherits the priority settings\n";
+        }
+    }
+
+    if (priority.applyToSelf && priority.any()) {
+        Priority::apply(priority);
+    }
+
+    if (priority.lockMemory) {
+        int err{Priority::lockMemory()};
+        if (err != 0) {
+            std::cerr << Colors::BrightYellow << "Warning: " << Colors::Reset
+                      << "mlockall failed: " << std::strerror(err) << "\n";
+        }
+    }
+
+    Numa::Placement placement{};
+    bool perNode{false};
+    if (!Numa::parsePlacement(parser, placement, perNode)) {
+        return 1;
+    }
+
+    Exec::Mode execMode{Exec::Mode::Resolved};
+    if (parser.has("exec-mode") && !Exec::parseMode(parser.get("exec-mode"), execMode)) {
+        std::cerr << Colors::BrightRed << "Error: " << Colors::Reset
+                  << "--exec-mode must be 'path', 'resolved' or 'memfd' (got '"
+                  << parser.get("exec-mode") << "')\n";
+        return 1;
+    }
+
+    BenchmarkConfig config{};
+    config.useShell = useShell;
+    config.quiet = isJsonOutput;
+    config.warmup = warmup;
+    config.iterations = iterations;
+    config.prepare = parser.get("prepare");
+    config.outputSize = parser.get("output-size");
+    if (useShell && config.outputSize == "-") {
+        std::cerr << Colors::BrightYellow << "Note: " << Colors::Reset
+                  << "--shell runs through std::system; stdout cannot be measured, name the "
+                     "output file instead\n";
+        config.outputSize.clear();
+    }
+    if (parser.has("bytes") && parser.has("bytes-from")) {
+        std::cerr << Colors::BrightRed << "Error: " << Colors::Reset
+                  << "--bytes and --bytes-from are mutually exclusive\n";
+        return 1;
+    }
+    if (parser.has("bytes") && !parseAmount(parser.get("bytes"), true, config.workBytes)) {
+        std::cerr << Colors::BrightRed << "Error: " << Colors::Reset
+                  << "--bytes must be a positive size like 4096, 64K or 1.5G (got '"
+                  << parser.get("bytes") << "')\n";
+        return 1;
+    }
+    if (parser.has("bytes-from") && !fileBytes(parser.get("bytes-from"), config.workBytes)) {
+        std::cerr << Colors::BrightRed << "Error: " << Colors::Reset << "Cannot read the size of '"
+                  << parser.get("bytes-from") << "'\n";
+        return 1;
+    }
+    if (parser.has("items") && !parseAmount(parser.get("items"), false, config.workItems)) {
+        std::cerr << Colors::BrightRed << "Error: " << Colors::Reset
+                  << "--items must be a positive count like 1000 or 2.5M (got '"
+                  << parser.get("items") << "')\n";
+        return 1;
+    }
+    config.priority = priority;
+    config.placement = placement;
+
+    if (parser.has("reserve") && !Reserve::parsePolicy(parser.get("reserve"), config.reserve)) {
+        std::cerr << Colors::BrightRed << "Error: " << Colors::Reset
+                  << "--reserve must be 'share', 'wait', 'fail' or 'none' (got '"
+                  << parser.get("reserve") << "')\n";
+        return 1;
+    }
+
+    if (parser.has("cache")) {
+        auto cache{std::make_shared<Cache::Policy>()};
+        cache->force = parser.has("force");
+        if (parser.has("cache-max-age") &&
+            !Cache::parseAge(parser.get("cache-max-age"), cache->maxAgeSeconds)) {
+            std::cerr << Colors::BrightRed << "Error: " << Colors::Reset
+                      << "--cache-max-age must look like 90m, 12h or 7d (got '"
+                      << parser.get("cache-max-age") << "')\n";
+            return 1;
+        }
+        cache->inputs = parser.getAll("cache-input");
+        cache->env = parser.getAll("cache-env");
+        config.cache = cache;
+    }
+
+    std::vector<Slo::Assertion> assertions{};
+    for (const auto& text : parser.getAll("assert")) {
+        Slo::Assertion assertion{};
+        if (!Slo::parse(text, assertion)) {
+            return 1;
+        }
+        assertions.push_back(assertion);
+    }
+    const bool subcommand{!positionalArgs.empty() &&
+                          (positionalArgs[0] == "run" || positionalArgs[0] == "tune" ||
+                           positionalArgs[0] == "perf-fuzz" || positionalArgs[0] == "watch" ||
+                           positionalArgs[0] == "submit" || positionalArgs[0] == "daemon")};
+    if (!assertions.empty() && (subcommand || perNode || parser.has("corpus"))) {
+        std::cerr << Colors::BrightYellow << "Note: " << Colors::Reset
+                  << "--assert checks a single benchmark; it is ignored here\n";
+    }
+
+    if (parser.has("dlopen")) {
+        return runInProcess(parser, config, assertions);
+    }
+
+    if (parser.has("corpus")) {
+        return runCorpus(parser, command, config, execMode);
+    }
+
+    if (positionalArgs.size() == 2 && positionalArgs[0] == "run") {
+        return runSuite(parser, positionalArgs[1], config, execMode);
+    }
+
+    if (positionalArgs.size() == 1 && positionalArgs[0] == "daemon") {
+        return runDaemon(parser, config, execMode);
+    }
+
+    if (positionalArgs.size() == 1 && positionalArgs[0] == "top") {
+#ifdef __linux__
+        std::signal(SIGINT, onInterrupt);
+        return LiveStats::top(interruptRequested);
+#else
+        std::cerr << Colors::BrightRed << "Error: " << Colors::Reset
+                  << "vajra top is only supported on Linux\n";
+        return 1;
+#endif
+    }
+
+    if (positionalArgs.size() >= 2 && positionalArgs[0] == "submit") {
+        return submitJob(parser, command.substr(std::string{"submit "}.size()), config);
+    }
+
+    if (positionalArgs.size() >= 2 && positionalArgs[0] == "perf-fuzz") {
+        return runPerfFuzz(parser, command.substr(std::string{"perf-fuzz "}.size()), config,
+                           execMode);
+    }
+
+    if (positionalArgs.size() >= 2 && positionalArgs[0] == "tune") {
+        return runTune(parser, command.substr(std::string{"tune "}.size()), config, execMode);
+    }
+
+    if (positionalArgs.size() >= 2 && positionalArgs[0] == "watch") {
+        std::signal(SIGINT, onInterrupt);
+        return runWatch(parser, command.substr(std::string{"watch "}.size()), config, execMode);
+    }
+
     std::vector<std::string> cmdArgs;
     if (!useShell) {
         cmdArgs = parseCommand(command);
@@ -174,80 +803,123 @@ int main(int argc, char** argv) {
         }
     }
 
-    if (!isJsonOutput) {
-        std::cout << Colors::BrightCyan << "Running benchmark: " << Colors::BrightYellow << command
-                  << Colors::Reset << "\n";
-        std::cout << Colors::White << "Warmup: " << warmup << " | Iterations: " << iterations
-                  << Colors::Reset << "\n\n";
+#ifdef __linux__
+    if (!useShell) {
+        auto image{std::make_shared<Exec::Image>()};
+        if (!Exec::prepare(*image, cmdArgs, execMode)) {
+            return 1;
+        }
+        config.image = image;
     }
+#endif
 
-    int totalRuns{warmup + iterations};
-    ProgressBar progressBar(totalRuns);
-    int currentRun{0};
+    config.command = command;
+    config.cmdArgs = cmdArgs;
 
-    if (warmup > 0) {
-        if (!isJsonOutput) {
-            std::cout << Colors::BrightMagenta << "Warming up..." << Colors::Reset << "\n";
+    if (!journalPath.empty()) {
+        if (perNode) {
+            std::cerr << Colors::BrightRed << "Error: " << Colors::Reset
+                      << "--journal records a single benchmark; it cannot be combined with "
+                         "--numa-node all\n";
+            return 1;
         }
-        for (int i{0}; i < warmup; ++i) {
-            if (useShell) {
-                std::system(command.c_str());
-            } else {
-                executeCommand(cmdArgs);
-            }
-            if (!isJsonOutput) {
-                progressBar.update(++currentRun);
+
+        auto journal{std::make_shared<Journal::Writer>()};
+        if (!journal->open(journalPath, {command, useShell, warmup, iterations}, resuming)) {
+            return 1;
+        }
+        config.journal = journal;
+        config.resumed = std::move(resumedSamples);
+    }
+
+    if (parser.has("collector")) {
+        auto collectors{std::make_shared<Collector::Set>()};
+        for (const auto& spec : parser.getAll("collector")) {
+            auto collector{Collector::load(spec)};
+            if (!collector) {
+                return 1;
             }
+            collectors->add(std::move(collector));
         }
-        if (!isJsonOutput) {
-            std::cout << "\n";
+        if (useShell) {
+            std::cerr << Colors::BrightYellow << "Note: " << Colors::Reset
+                      << "--shell runs through std::system; collectors are not called\n";
         }
+        config.collectors = collectors;
     }
 
-    if (!isJsonOutput) {
-        std::cout << Colors::BrightGreen << "Benchmarking..." << Colors::Reset << "\n";
+    if (parser.has("live")) {
+        auto live{std::make_shared<LiveStats::Publisher>()};
+        if (live->open(command)) {
+            config.live = live;
+        } else {
+            std::cerr << Colors::BrightYellow << "Warning: " << Colors::Reset
+                      << "Cannot create the live statistics segment; --live is ignored\n";
+        }
     }
 
-    std::vector<double> timings{};
-    timings.reserve(iterations);
+    std::signal(SIGINT, onInterrupt);
 
-    for (int i{0}; i < iterations; ++i) {
-        Timer::Timer timer{};
-        timer.start();
+    if (perNode) {
         if (useShell) {
-            std::system(command.c_str());
-        } else {
-            executeCommand(cmdArgs);
+            std::cerr << Colors::BrightYellow << "Note: " << Colors::Reset
+                      << "--shell runs through std::system; NUMA placement is not applied\n";
+        }
+
+        std::vector<BenchmarkResults> perNodeResults{};
+        for (int node : Numa::onlineNodes()) {
+            if (!Numa::forNode(placement, node, config.placement)) {
+                return 1;
+            }
+            perNodeResults.push_back(runBenchmark(config));
+            if (perNodeResults.back().reservationFailed) {
+                return 1;
+            }
+            if (!isJsonOutput) {
+                perNodeResults.back().display();
+            }
+            if (interruptRequested) {
+                break;
+            }
         }
-        timer.stop();
-        timings.push_back(timer.elapsedMilliseconds());
-        if (!isJsonOutput) {
-            progressBar.update(++currentRun);
+
+        if (parser.has("export-openmetrics") &&
+            !OpenMetrics::write(parser.get("export-openmetrics"), perNodeResults)) {
+            return 1;
         }
-    }
-    if (!isJsonOutput) {
-        progressBar.finish();
-        progressBar.clear();
 
-        int linesToClear{warmup > 0 ? 8 : 6};
-        for (int i{0}; i < linesToClear; ++i) {
-            std::cout << "\033[F\033[K";
+        if (isJsonOutput) {
+            std::cout << "[\n";
+            for (size_t i{0}; i < perNodeResults.size(); ++i) {
+                std::string json{perNodeResults[i].toJson()};
+                json.pop_back();
+                std::cout << json << (i + 1 < perNodeResults.size() ? ",\n" : "\n");
+            }
+            std::cout << "]\n";
+        } else {
+            displayNodeComparison(perNodeResults);
         }
+
+        return interruptRequested ? 130 : 0;
     }
 
-    BenchmarkResults results{};
-    results.command = command;
-    results.mean = Statistics::mean(timings);
-    results.stdDev = Statistics::stddev(timings);
-    results.min = Statistics::min(timings);
-    results.max = Statistics::max(timings);
-    results.iterations = iterations;
+    if (useShell && placement.any()) {
+        std::cerr << Colors::BrightYellow << "Note: " << Colors::Reset
+                  << "--shell runs through std::system; NUMA placement is not applied\n";
+    }
 
-    if (outputFormat == "json") {
-        std::cout << results.toJson();
-    } else {
-        results.display();
+    BenchmarkResults results{runBenchmark(config)};
+    if (results.reservationFailed) {
+        return 1;
     }
 
-    return 0;
+    if (parser.has("export-openmetrics") &&
+        !OpenMetrics::write(parser.get("export-openmetrics"), {results})) {
+        return 1;
+    }
+    if (parser.has("export-samples") && !exportSamples(parser.get("export-samples"), results)) {
+        return 1;
+    }
+
+    return report(results, assertions, outputFormat == "json");
 }